@@ -0,0 +1,88 @@
+/**
+ * @file CanRxQueue.h
+ * @brief Receive ring behind the bxCAN FIFO. The RX interrupt empties the
+ * three deep hardware FIFO into the ring and signals ready(), so commands
+ * are picked up within the wake-up latency of the thread instead of at the
+ * next poll, and a burst of them is not lost to a FIFO overrun.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note The interrupt only writes the head and the thread only writes the
+ * tail, so neither side masks interrupts. A full ring drops the new frame and
+ * counts it.
+ *
+ * @note Frames are read in interrupt context, so the controller must be an
+ * IsrCAN, see CanTxQueue.h. Set the acceptance filters on the controller so
+ * that only frames for this board raise the interrupt at all.
+ */
+#pragma once
+#include "mbed.h"
+#include "CanTxQueue.h"
+#include <atomic>
+
+#define CAN_RX_DEPTH        (16)    /* Frames, a power of 2 */
+
+class CanRxQueue
+{
+    public:
+        /**
+         * @brief Counters since construction or the last reset_stats().
+         */
+        struct stats {
+            uint32_t    received;   /* Frames taken from the controller */
+            uint32_t    dropped;    /* Frames lost because the ring was full */
+            uint8_t     high_water; /* Most frames waiting at once */
+        };
+
+        /**
+         * @brief Construct a new queue and take over the RX interrupt of can.
+         */
+        CanRxQueue(IsrCAN* can);
+
+        /**
+         * @brief Take the oldest frame. Thread context, one reader only.
+         *
+         * @param stamp If given, the clock set with set_clock() when the
+         * frame was taken from the controller.
+         * @return true If a frame was waiting.
+         */
+        bool read(CANMessage& msg, uint64_t* stamp = nullptr);
+
+        /**
+         * @brief Stamp incoming frames with clock, read in the RX interrupt,
+         * e.g. TimeSync::local_us.
+         */
+        void set_clock(Callback<uint64_t()> clock) { _clock = clock; }
+
+        /**
+         * @brief Released by the RX interrupt whenever it queued frames.
+         * Acquiring it does not take a frame; drain with read() after.
+         */
+        Semaphore* ready(void) { return &_ready; }
+
+        const stats& statistics(void) const { return _stats; }
+
+        void reset_stats(void);
+
+    private:
+        /**
+         * @brief RX interrupt: move every frame in the hardware FIFO to the
+         * ring.
+         */
+        void _on_rx(void);
+
+        IsrCAN*         _can;
+        Callback<uint64_t()> _clock;
+
+        /**
+         * @brief Indices run free and wrap modulo CAN_RX_DEPTH when used.
+         * The interrupt owns _head, the reader owns _tail.
+         */
+        CANMessage      _ring[CAN_RX_DEPTH];
+        uint64_t        _stamp[CAN_RX_DEPTH];
+        std::atomic<uint8_t> _head;
+        std::atomic<uint8_t> _tail;
+
+        Semaphore       _ready;
+        stats           _stats;
+};
@@ -0,0 +1,71 @@
+/**
+ * @file CanTxQueue.cpp
+ * @brief Software transmit queue in front of the bxCAN mailboxes.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#include "CanTxQueue.h"
+#include <cstring>
+
+CanTxQueue::CanTxQueue(IsrCAN* can)
+    : _can(can)
+{
+    memset(_head, 0, sizeof(_head));
+    memset(_tail, 0, sizeof(_tail));
+    reset_stats();
+    _can->attach(callback(this, &CanTxQueue::_on_tx), CAN::TxIrq);
+}
+
+bool CanTxQueue::write(const CANMessage& msg, priority prio)
+{
+    CriticalSectionLock lock;
+    uint8_t waiting = (uint8_t)(_head[prio] - _tail[prio]);
+    if (waiting >= CAN_TX_DEPTH) {
+        _stats[prio].dropped++;
+        return false;
+    }
+    _ring[prio][_head[prio] % CAN_TX_DEPTH] = msg;
+    _head[prio]++;
+    if (waiting + 1 > _stats[prio].high_water) {
+        _stats[prio].high_water = waiting + 1;
+    }
+    _drain();
+    return true;
+}
+
+uint8_t CanTxQueue::pending(priority prio) const
+{
+    CriticalSectionLock lock;
+    return (uint8_t)(_head[prio] - _tail[prio]);
+}
+
+void CanTxQueue::reset_stats(void)
+{
+    CriticalSectionLock lock;
+    memset(_stats, 0, sizeof(_stats));
+}
+
+void CanTxQueue::_drain(void)
+{
+    // Called with interrupts masked or from the TX interrupt
+    for (uint8_t prio = 0; prio < PRIORITY_COUNT; ++prio) {
+        while (_head[prio] != _tail[prio]) {
+            if (!_can->write(_ring[prio][_tail[prio] % CAN_TX_DEPTH])) {
+                // Mailboxes full; the next TX complete picks up from here
+                return;
+            }
+            _tail[prio]++;
+            _stats[prio].sent++;
+        }
+    }
+}
+
+void CanTxQueue::_on_tx(void)
+{
+    if (_tx_complete) {
+        _tx_complete();
+    }
+    // Another interrupt may queue a frame meanwhile
+    CriticalSectionLock lock;
+    _drain();
+}
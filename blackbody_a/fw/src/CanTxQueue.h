@@ -0,0 +1,110 @@
+/**
+ * @file CanTxQueue.h
+ * @brief Software transmit queue in front of the three bxCAN mailboxes.
+ * Frames wait in a ring per priority and move to the controller as mailboxes
+ * free up, from the TX complete interrupt, so a burst of measurements is
+ * queued instead of dropped and nobody polls for a mailbox.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note The highest priority ring always drains first, so a heartbeat or a
+ * fault waits for at most the frames already in the mailboxes. A full ring
+ * drops the new frame and counts it.
+ *
+ * @note Frames are handed to the controller from interrupt context. mbed's
+ * CAN guards write() with a mutex, which an ISR cannot take; give the queue
+ * an IsrCAN, whose writes the queue serializes itself.
+ */
+#pragma once
+#include "mbed.h"
+
+#define CAN_TX_DEPTH        (16)    /* Frames per priority, a power of 2 */
+
+/**
+ * @brief CAN that may be written from interrupt context. See the note above.
+ */
+class IsrCAN : public CAN
+{
+    public:
+        IsrCAN(PinName rd, PinName td) : CAN(rd, td) {}
+        IsrCAN(PinName rd, PinName td, int hz) : CAN(rd, td, hz) {}
+
+    protected:
+        void lock(void) override {}
+        void unlock(void) override {}
+};
+
+class CanTxQueue
+{
+    public:
+        enum priority {
+            PRIORITY_URGENT = 0,    /* Heartbeat and faults */
+            PRIORITY_NORMAL,        /* Measurements and replies */
+            PRIORITY_BULK,          /* Diagnostics, anything that can wait */
+            PRIORITY_COUNT,
+        };
+
+        /**
+         * @brief Counters since construction or the last reset_stats().
+         */
+        struct stats {
+            uint32_t    sent;       /* Frames handed to the controller */
+            uint32_t    dropped;    /* Frames refused because the ring was full */
+            uint8_t     high_water; /* Most frames waiting at once */
+        };
+
+        /**
+         * @brief Construct a new queue and take over the TX complete
+         * interrupt of can.
+         */
+        CanTxQueue(IsrCAN* can);
+
+        /**
+         * @brief Queue a frame, and start it at once if a mailbox is free.
+         * Callable from thread or interrupt context.
+         *
+         * @return true If queued, false if the ring was full and the frame
+         * was dropped.
+         */
+        bool write(const CANMessage& msg, priority prio = PRIORITY_NORMAL);
+
+        /**
+         * @brief Frames waiting at a priority.
+         */
+        uint8_t pending(priority prio) const;
+
+        const stats& statistics(priority prio) const { return _stats[prio]; }
+
+        void reset_stats(void);
+
+        /**
+         * @brief Call func from every TX complete interrupt, before the
+         * queue refills the mailboxes, e.g. to stamp a frame that just went
+         * out.
+         */
+        void attach_tx_complete(Callback<void()> func) { _tx_complete = func; }
+
+    private:
+        /**
+         * @brief Fill free mailboxes from the rings, highest priority first.
+         */
+        void _drain(void);
+
+        /**
+         * @brief TX complete interrupt.
+         */
+        void _on_tx(void);
+
+        IsrCAN*         _can;
+        Callback<void()> _tx_complete;
+
+        /**
+         * @brief One ring per priority. Indices run free and wrap modulo
+         * CAN_TX_DEPTH when used.
+         */
+        CANMessage      _ring[PRIORITY_COUNT][CAN_TX_DEPTH];
+        uint8_t         _head[PRIORITY_COUNT];
+        uint8_t         _tail[PRIORITY_COUNT];
+
+        stats           _stats[PRIORITY_COUNT];
+};
@@ -0,0 +1,46 @@
+/**
+ * @file ChangeReporter.cpp
+ * @brief Deadband and keep-alive per channel.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#include "ChangeReporter.h"
+
+ChangeReporter::ChangeReporter(void)
+    : _seen(0), _suppressed(0)
+{
+    _config.deadband = 0;
+    _config.max_silence_s = REPORT_SILENCE_DEFAULT;
+}
+
+void ChangeReporter::configure(const config& conf)
+{
+    _config = conf;
+    if (_config.max_silence_s == 0) {
+        _config.max_silence_s = REPORT_SILENCE_DEFAULT;
+    }
+    _seen = 0;
+}
+
+bool ChangeReporter::due(uint8_t channel, int32_t value, uint64_t local_us)
+{
+    if (_config.deadband == 0 || !(_seen >> channel & 0x1)) {
+        return true;
+    }
+    int64_t change = (int64_t)value - _value[channel];
+    if (change >= _config.deadband || -change >= _config.deadband) {
+        return true;
+    }
+    if (local_us - _time_us[channel] >= _config.max_silence_s * 1000000ULL) {
+        return true;
+    }
+    ++_suppressed;
+    return false;
+}
+
+void ChangeReporter::reported(uint8_t channel, int32_t value, uint64_t local_us)
+{
+    _value[channel] = value;
+    _time_us[channel] = local_us;
+    _seen |= 1 << channel;
+}
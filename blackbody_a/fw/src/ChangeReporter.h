@@ -0,0 +1,74 @@
+/**
+ * @file ChangeReporter.h
+ * @brief Report-on-change for a set of sensor channels: a sample is only
+ * worth a frame once it has moved a deadband away from the value last
+ * reported for its channel, or once the channel has been silent for the
+ * longest time allowed, so a steady signal costs a keep-alive instead of a
+ * frame per sample.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note A deadband of 0 reports every sample. The first sample of a channel,
+ * and the first after configure(), is always reported. Comparing against the
+ * last reported value, not the last sample, lets a slow drift through once it
+ * adds up to the deadband.
+ *
+ * Values are in the unit of the caller, e.g. centi-degrees C.
+ */
+#pragma once
+#include "mbed.h"
+
+#define REPORT_CHANNELS         (8)
+#define REPORT_SILENCE_DEFAULT  (10)    /* Keep-alive, s */
+
+class ChangeReporter
+{
+    public:
+        struct config {
+            uint16_t    deadband;       /* 0: report every sample */
+            uint8_t     max_silence_s;  /* Keep-alive, 1 to 255 s */
+        };
+
+        /**
+         * @brief Construct a new reporter that reports every sample.
+         */
+        ChangeReporter(void);
+
+        /**
+         * @brief Use conf from now on; every channel reports its next sample.
+         * A max_silence_s of 0 is taken as REPORT_SILENCE_DEFAULT.
+         */
+        void configure(const config& conf);
+
+        const config& configuration(void) const { return _config; }
+
+        /**
+         * @brief Whether a sample of channel needs reporting.
+         *
+         * @param local_us Local time the sample was taken, see
+         * TimeSync::local_us().
+         */
+        bool due(uint8_t channel, int32_t value, uint64_t local_us);
+
+        /**
+         * @brief Note that a sample of channel went out.
+         */
+        void reported(uint8_t channel, int32_t value, uint64_t local_us);
+
+        /**
+         * @brief Report the next sample of channel, whatever its value.
+         */
+        void reset(uint8_t channel) { _seen &= ~(1 << channel); }
+
+        /**
+         * @brief Samples that due() held back, since construction.
+         */
+        uint32_t suppressed(void) const { return _suppressed; }
+
+    private:
+        config          _config;
+        int32_t         _value[REPORT_CHANNELS];    /* Last reported */
+        uint64_t        _time_us[REPORT_CHANNELS];  /* When it was taken */
+        uint8_t         _seen;      /* Bit per channel: _value holds one */
+        uint32_t        _suppressed;
+};
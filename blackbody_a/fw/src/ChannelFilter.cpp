@@ -0,0 +1,153 @@
+/**
+ * @file ChannelFilter.cpp
+ * @brief Integer median, EMA and boxcar filter chain per channel.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#include "ChannelFilter.h"
+
+/**
+ * @brief a / b rounded to nearest, half away from zero. b > 0.
+ */
+static int32_t divide_rounded(int32_t a, int32_t b)
+{
+    return a >= 0 ? (a + b / 2) / b : -((-a + b / 2) / b);
+}
+
+ChannelFilter::ChannelFilter(void)
+{
+    _config.median = 1;
+    _config.mode = MODE_NONE;
+    _config.ema_shift = 1;
+    _config.decimation = 1;
+    reset();
+}
+
+bool ChannelFilter::valid(const config& conf)
+{
+    if (conf.median < 1 || conf.median > FILTER_MEDIAN_MAX || conf.median % 2 == 0) {
+        return false;
+    }
+    if (conf.mode > MODE_BOXCAR) {
+        return false;
+    }
+    if (conf.mode == MODE_EMA && (conf.ema_shift < 1 || conf.ema_shift > FILTER_EMA_SHIFT_MAX)) {
+        return false;
+    }
+    return conf.decimation >= 1 && conf.decimation <= FILTER_DECIMATE_MAX;
+}
+
+bool ChannelFilter::configure(const config& conf)
+{
+    if (!valid(conf)) {
+        return false;
+    }
+    _config = conf;
+    reset();
+    return true;
+}
+
+void ChannelFilter::reset(void)
+{
+    memset(_window, 0, sizeof(_window));
+    memset(_pos, 0, sizeof(_pos));
+    memset(_filled, 0, sizeof(_filled));
+    memset(_acc, 0, sizeof(_acc));
+    memset(_count, 0, sizeof(_count));
+    _primed = 0;
+}
+
+void ChannelFilter::reset(uint8_t channel)
+{
+    _pos[channel] = 0;
+    _filled[channel] = 0;
+    _acc[channel] = 0;
+    _count[channel] = 0;
+    _primed &= ~(1 << channel);
+}
+
+bool ChannelFilter::add(uint8_t channel, int32_t value, int32_t* out)
+{
+    int32_t values[FILTER_CHANNELS];
+    int32_t outs[FILTER_CHANNELS];
+    values[channel] = value;
+    if (!(add_round(values, 1 << channel, outs) >> channel & 0x1)) {
+        return false;
+    }
+    *out = outs[channel];
+    return true;
+}
+
+uint8_t ChannelFilter::add_round(const int32_t values[FILTER_CHANNELS], uint8_t mask, int32_t out[FILTER_CHANNELS])
+{
+    uint8_t ready = 0;
+    for (uint8_t ch = 0; ch < FILTER_CHANNELS; ++ch) {
+        if (!(mask >> ch & 0x1)) {
+            continue;
+        }
+        // Spike rejection
+        int32_t x = values[ch];
+        if (_config.median > 1) {
+            _window[_pos[ch]][ch] = x;
+            _pos[ch] = (_pos[ch] + 1) % _config.median;
+            if (_filled[ch] < _config.median) {
+                ++_filled[ch];
+            }
+            x = _median(ch);
+        }
+
+        // Smoothing
+        switch (_config.mode) {
+            case MODE_EMA:
+                if (!(_primed >> ch & 0x1)) {
+                    _acc[ch] = x * (1 << FILTER_EMA_FRAC);
+                    _primed |= 1 << ch;
+                } else {
+                    // Arithmetic shift, as GCC does for signed values
+                    _acc[ch] += (x * (1 << FILTER_EMA_FRAC) - _acc[ch]) >> _config.ema_shift;
+                }
+                break;
+            case MODE_BOXCAR:
+                _acc[ch] += x;
+                break;
+            default:
+                break;
+        }
+
+        // Decimation
+        if (++_count[ch] < _config.decimation) {
+            continue;
+        }
+        _count[ch] = 0;
+        switch (_config.mode) {
+            case MODE_EMA:
+                out[ch] = divide_rounded(_acc[ch], 1 << FILTER_EMA_FRAC);
+                break;
+            case MODE_BOXCAR:
+                out[ch] = divide_rounded(_acc[ch], _config.decimation);
+                _acc[ch] = 0;
+                break;
+            default:
+                out[ch] = x;
+                break;
+        }
+        ready |= 1 << ch;
+    }
+    return ready;
+}
+
+int32_t ChannelFilter::_median(uint8_t channel) const
+{
+    // Insertion sort of at most FILTER_MEDIAN_MAX values
+    int32_t sorted[FILTER_MEDIAN_MAX];
+    uint8_t n = _filled[channel];
+    for (uint8_t i = 0; i < n; ++i) {
+        int32_t v = _window[i][channel];
+        uint8_t j = i;
+        for (; j > 0 && sorted[j - 1] > v; --j) {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = v;
+    }
+    return sorted[(n - 1) / 2];
+}
@@ -0,0 +1,117 @@
+/**
+ * @file ChannelFilter.h
+ * @brief Integer filter chain for a set of sensor channels: a median of the
+ * last N samples against spikes, then an exponential moving average or a
+ * boxcar, decimated to one output per D samples. Sampling D times faster
+ * than the reported rate lowers the noise without more frames on the bus.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note State is kept channel-major, one row per quantity with a column per
+ * channel, so a round of every channel walks each row once (add_round()).
+ *
+ * @note Stages, in order:
+ * - median of the last median samples (1: off), odd up to FILTER_MEDIAN_MAX;
+ *   fewer until the window has filled
+ * - MODE_NONE: every Dth median; MODE_EMA: y += (x - y) / 2^ema_shift, every
+ *   Dth value; MODE_BOXCAR: mean of each D medians
+ *
+ * Values are in the unit of the caller, e.g. centi-degrees C. Channels that
+ * miss a sample just fall behind; they do not hold the others up.
+ */
+#pragma once
+#include "mbed.h"
+
+#define FILTER_CHANNELS     (8)
+#define FILTER_MEDIAN_MAX   (5)
+#define FILTER_EMA_SHIFT_MAX (7)
+#define FILTER_DECIMATE_MAX (16)
+#define FILTER_EMA_FRAC     (8)     /* Fraction bits of the EMA state */
+
+class ChannelFilter
+{
+    public:
+        enum mode {
+            MODE_NONE = 0,
+            MODE_EMA = 1,
+            MODE_BOXCAR = 2,
+        };
+
+        struct config {
+            uint8_t     median;     /* Window, 1 (off), 3 or 5 */
+            uint8_t     mode;       /* See enum mode */
+            uint8_t     ema_shift;  /* MODE_EMA: 1 to FILTER_EMA_SHIFT_MAX */
+            uint8_t     decimation; /* Samples per output, 1 to FILTER_DECIMATE_MAX */
+        };
+
+        /**
+         * @brief Construct a new filter that passes every sample through.
+         */
+        ChannelFilter(void);
+
+        static bool valid(const config& conf);
+
+        /**
+         * @brief Use conf from now on and forget every channel's history.
+         *
+         * @return false If conf is not valid(); the old one is kept.
+         */
+        bool configure(const config& conf);
+
+        const config& configuration(void) const { return _config; }
+
+        /**
+         * @brief Samples to take per output.
+         */
+        uint8_t decimation(void) const { return _config.decimation; }
+
+        /**
+         * @brief Forget every channel's history.
+         */
+        void reset(void);
+
+        /**
+         * @brief Forget one channel's history, e.g. after it was out of use.
+         */
+        void reset(uint8_t channel);
+
+        /**
+         * @brief Filter one sample of one channel.
+         *
+         * @param out Filtered value, set if an output is due.
+         * @return true If an output is due.
+         */
+        bool add(uint8_t channel, int32_t value, int32_t* out);
+
+        /**
+         * @brief Filter a sample of every channel in mask at once.
+         *
+         * @param values Indexed by channel; only those in mask are read.
+         * @param out Indexed by channel; set for those in the result.
+         * @return Bitmap of the channels with an output due.
+         */
+        uint8_t add_round(const int32_t values[FILTER_CHANNELS], uint8_t mask, int32_t out[FILTER_CHANNELS]);
+
+    private:
+        /**
+         * @brief Median of the samples in channel's window.
+         */
+        int32_t _median(uint8_t channel) const;
+
+        config          _config;
+
+        /**
+         * @brief Median window, _window[i][channel], written at _pos.
+         */
+        int32_t         _window[FILTER_MEDIAN_MAX][FILTER_CHANNELS];
+        uint8_t         _pos[FILTER_CHANNELS];
+        uint8_t         _filled[FILTER_CHANNELS];
+
+        /**
+         * @brief MODE_EMA: state with FILTER_EMA_FRAC fraction bits.
+         * MODE_BOXCAR: running sum.
+         */
+        int32_t         _acc[FILTER_CHANNELS];
+        uint8_t         _count[FILTER_CHANNELS];
+        uint8_t         _primed;    /* Bit per channel: _acc holds an EMA */
+};
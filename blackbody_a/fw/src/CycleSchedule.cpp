@@ -0,0 +1,279 @@
+/**
+ * @file CycleSchedule.cpp
+ * @brief Table-driven cooperative scheduler for the Blackbody A measurement
+ * cycle.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#include "CycleSchedule.h"
+#include <cstring>
+
+CycleSchedule::CycleSchedule()
+    : _active(0), _ready(1), _build(2), _overflow(false), _pending(false), _running(false), _abort(false),
+      _background(nullptr), _wake(nullptr),
+      _cycle_us(0), _anchored(false), _last_start_us(0), _have_last_start(false),
+      _load_ppm(0), _failed_task(0)
+{
+    memset(_num_tasks, 0, sizeof(_num_tasks));
+    memset(_num_slots, 0, sizeof(_num_slots));
+    reset_timing();
+    _clock.start();
+}
+
+void CycleSchedule::clear(void)
+{
+    _num_tasks[_build] = 0;
+    _overflow = false;
+}
+
+void CycleSchedule::add_task(task_fn run, uint8_t arg, uint16_t rate_hz, uint32_t duration_us,
+                             uint8_t priority, uint32_t phase_us, uint32_t deadline_us)
+{
+    if (rate_hz == 0) {
+        return;
+    }
+    uint8_t& n = _num_tasks[_build];
+    if (n >= CYCLE_MAX_TASKS) {
+        _overflow = true;
+        return;
+    }
+    uint32_t period_us = CYCLE_PERIOD_US / rate_hz;
+    if (deadline_us == 0 || deadline_us > period_us) {
+        deadline_us = period_us;
+    }
+    _tasks[_build][n++] = { run, arg, rate_hz, duration_us, priority, phase_us % period_us, deadline_us };
+}
+
+uint32_t CycleSchedule::_release(const task& t, uint16_t k)
+{
+    return t.phase_us + (uint32_t)((uint64_t)k * CYCLE_PERIOD_US / t.rate_hz);
+}
+
+CycleSchedule::build_result CycleSchedule::build(void)
+{
+    const uint8_t next = _build;
+    const task* tasks = _tasks[next];
+    const uint8_t num_tasks = _num_tasks[next];
+    if (_overflow) {
+        _failed_task = CYCLE_MAX_TASKS;
+        return BUILD_TOO_MANY_TASKS;
+    }
+
+    uint64_t load = 0;
+    for (uint8_t i = 0; i < num_tasks; ++i) {
+        load += (uint64_t)tasks[i].rate_hz * tasks[i].duration_us;
+    }
+    _load_ppm = (uint32_t)(load * 1000000 / CYCLE_PERIOD_US);
+    if (load > CYCLE_PERIOD_US) {
+        _failed_task = 0;
+        return BUILD_OVERLOADED;
+    }
+
+    // Non-preemptive EDF over one cycle. jobs[i] is the next job of task i.
+    uint16_t jobs[CYCLE_MAX_TASKS] = {0};
+    uint16_t num_slots = 0;
+    uint32_t now = 0;
+    while (true) {
+        int8_t best = -1;
+        uint32_t best_deadline = 0;
+        uint32_t next_release = UINT32_MAX;
+        for (uint8_t i = 0; i < num_tasks; ++i) {
+            if (jobs[i] >= tasks[i].rate_hz) {
+                continue;
+            }
+            uint32_t release = _release(tasks[i], jobs[i]);
+            if (release > now) {
+                if (release < next_release) {
+                    next_release = release;
+                }
+                continue;
+            }
+            // Due before the next release, or its own deadline, and within
+            // this cycle
+            uint32_t deadline = _release(tasks[i], jobs[i] + 1);
+            if (release + tasks[i].deadline_us < deadline) {
+                deadline = release + tasks[i].deadline_us;
+            }
+            if (deadline > CYCLE_PERIOD_US) {
+                deadline = CYCLE_PERIOD_US;
+            }
+            if (best < 0 || deadline < best_deadline
+                    || (deadline == best_deadline && tasks[i].priority < tasks[best].priority)) {
+                best = i;
+                best_deadline = deadline;
+            }
+        }
+        if (best < 0) {
+            if (next_release == UINT32_MAX) {
+                break;
+            }
+            now = next_release;
+            continue;
+        }
+        if (num_slots >= CYCLE_MAX_SLOTS) {
+            _failed_task = best;
+            return BUILD_TOO_MANY_SLOTS;
+        }
+        _slots[next][num_slots++] = { now, (uint8_t)best };
+        now += tasks[best].duration_us;
+        if (now > best_deadline) {
+            _failed_task = best;
+            return BUILD_DEADLINE_MISSED;
+        }
+        jobs[best]++;
+    }
+
+    _num_slots[next] = num_slots;
+    // Replaces any table still waiting; the next task set starts from
+    // scratch in that one's buffer
+    _build = _ready;
+    _ready = next;
+    _num_tasks[_build] = 0;
+    _pending = true;
+    if (!_running) {
+        _take_over();
+    }
+    return BUILD_OK;
+}
+
+void CycleSchedule::_take_over(void)
+{
+    uint8_t old = _active;
+    _active = _ready;
+    _ready = old;
+    _pending = false;
+    memset(_slot_late_max_us, 0, sizeof(_slot_late_max_us));
+}
+
+void CycleSchedule::run_cycle(void)
+{
+    if (_pending) {
+        _take_over();
+    }
+    _running = true;
+    _abort = false;
+    _start_cycle();
+    const task* tasks = _tasks[_active];
+    const slot* slots = _slots[_active];
+    const uint16_t num_slots = _num_slots[_active];
+    for (uint16_t i = 0; i < num_slots && !_abort; ++i) {
+        // First tick at or after the slot's place in the table; a slot that
+        // is already due runs at once
+        std::chrono::milliseconds offset((slots[i].start_us + 999) / 1000);
+        _sleep_until(_cycle_tick + offset);
+        if (_abort) {
+            break;
+        }
+        // Late against the tick waited for, so the rounding up is not counted
+        uint64_t due = _cycle_us + (uint64_t)offset.count() * 1000;
+        uint64_t now = _now_us();
+        _record_late(i, slots[i].task, now > due ? (uint32_t)(now - due) : 0);
+        const task& t = tasks[slots[i].task];
+        t.run(t.arg);
+    }
+    if (!_abort) {
+        // One period after this cycle started, however long the work took
+        _cycle_tick += std::chrono::milliseconds(CYCLE_PERIOD_US / 1000);
+        _cycle_us += CYCLE_PERIOD_US;
+        _sleep_until(_cycle_tick);
+    }
+    if (_abort) {
+        _anchored = false;
+        _have_last_start = false;
+    }
+    _running = false;
+    _abort = false;
+}
+
+void CycleSchedule::set_background(background_fn background, Semaphore* wake)
+{
+    _background = background;
+    _wake = background != nullptr ? wake : nullptr;
+}
+
+void CycleSchedule::_sleep_until(Kernel::Clock::time_point tick)
+{
+    if (_wake == nullptr) {
+        ThisThread::sleep_until(tick);
+        return;
+    }
+    while (!_abort && _wake->try_acquire_until(tick)) {
+        _background();
+    }
+}
+
+void CycleSchedule::_start_cycle(void)
+{
+    if (_anchored && _now_us() > _cycle_us + CYCLE_PERIOD_US) {
+        ++_timing.overruns;
+        _anchored = false;
+        _have_last_start = false;
+    }
+    if (!_anchored) {
+        // Start on a fresh tick, so that the tick and _clock agree on where
+        // the cycle starts
+        _cycle_tick = Kernel::Clock::now() + 1ms;
+        ThisThread::sleep_until(_cycle_tick);
+        _cycle_us = _now_us();
+        _anchored = true;
+    }
+    uint64_t start = _now_us();
+    if (_have_last_start) {
+        uint32_t period = (uint32_t)(start - _last_start_us);
+        _timing.periods++;
+        _timing.period_sum_us += period;
+        if (period < _timing.period_min_us) {
+            _timing.period_min_us = period;
+        }
+        if (period > _timing.period_max_us) {
+            _timing.period_max_us = period;
+        }
+    }
+    _last_start_us = start;
+    _have_last_start = true;
+    _timing.cycles++;
+}
+
+void CycleSchedule::_record_late(uint16_t slot, uint8_t task, uint32_t late_us)
+{
+    if (late_us > _slot_late_max_us[slot]) {
+        _slot_late_max_us[slot] = late_us;
+    }
+    if (late_us > _timing.late_max_us) {
+        _timing.late_max_us = late_us;
+        _timing.late_max_task = task;
+    }
+    _timing.late_sum_us += late_us;
+    _timing.slots_run++;
+}
+
+void CycleSchedule::reset_timing(void)
+{
+    memset(&_timing, 0, sizeof(_timing));
+    _timing.period_min_us = UINT32_MAX;
+    memset(_slot_late_max_us, 0, sizeof(_slot_late_max_us));
+}
+
+int32_t CycleSchedule::period_error_us(void) const
+{
+    if (_timing.periods == 0) {
+        return 0;
+    }
+    return (int32_t)(_timing.period_sum_us / _timing.periods) - CYCLE_PERIOD_US;
+}
+
+uint32_t CycleSchedule::period_jitter_us(void) const
+{
+    if (_timing.periods == 0) {
+        return 0;
+    }
+    return _timing.period_max_us - _timing.period_min_us;
+}
+
+uint32_t CycleSchedule::mean_late_us(void) const
+{
+    if (_timing.slots_run == 0) {
+        return 0;
+    }
+    return (uint32_t)(_timing.late_sum_us / _timing.slots_run);
+}
@@ -0,0 +1,292 @@
+/**
+ * @file CycleSchedule.h
+ * @brief Table-driven cooperative scheduler for the Blackbody A measurement
+ * cycle. Periodic tasks (heartbeat, RTDs, irradiance) are given a rate, a
+ * worst-case run time, a priority and a phase; build() lays their jobs out
+ * over one cycle with non-preemptive earliest deadline first and reports when
+ * they do not fit.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note Every job must finish before the next release of its task (or the end
+ * of the cycle, for the last one), or sooner if the task has a deadline of
+ * its own. Equal deadlines go to the lower priority number. The table
+ * repeats every CYCLE_PERIOD_US.
+ *
+ * @note Slots wake on absolute kernel ticks counted from where the cycle
+ * started, and each cycle starts exactly one period after the last, so the
+ * time tasks take never adds up into drift. How late each slot actually
+ * starts after the tick it waits for, and how long each cycle really was, is
+ * measured on a microsecond timer; see timing().
+ *
+ * @note A table built while a cycle is running takes over at the start of
+ * the next one. Both tables spread each task over the same cycle, so across
+ * the change no task waits longer than the longer of its old and new periods.
+ * Tasks may rebuild the schedule; everything runs in the thread calling
+ * run_cycle. Task sets are built in a buffer of their own, so a failed build
+ * leaves both the table in use and one waiting to take over as they were.
+ *
+ * @note Work that cannot wait for a slot, e.g. incoming commands, can be
+ * attached with set_background(): whenever its semaphore is released while
+ * the cycle waits for a slot, it runs at once in between.
+ */
+#pragma once
+#include "mbed.h"
+
+#define CYCLE_PERIOD_US     (1000000)
+#define CYCLE_MAX_TASKS     (16)
+#define CYCLE_MAX_SLOTS     (160)
+
+class CycleSchedule
+{
+    public:
+        /**
+         * @brief A task body, called with the argument it was added with.
+         */
+        typedef void (*task_fn)(uint8_t arg);
+
+        /**
+         * @brief Work run between slots on demand, see set_background().
+         */
+        typedef void (*background_fn)(void);
+
+        enum build_result {
+            BUILD_OK = 0,
+            BUILD_OVERLOADED,       /* Run times add up to more than a cycle */
+            BUILD_DEADLINE_MISSED,  /* A job cannot finish before its deadline */
+            BUILD_TOO_MANY_SLOTS,   /* More jobs than CYCLE_MAX_SLOTS */
+            BUILD_TOO_MANY_TASKS,   /* More tasks than CYCLE_MAX_TASKS */
+        };
+
+        CycleSchedule();
+
+        /**
+         * @brief Start a new task set. The table in use, and one built but
+         * not yet taken over, stay until the next successful build().
+         */
+        void clear(void);
+
+        /**
+         * @brief Add a periodic task to the new task set.
+         *
+         * @param run Task body.
+         * @param arg Passed to run, e.g. a sensor index.
+         * @param rate_hz Jobs per cycle. 0 leaves the task out.
+         * @param duration_us Worst-case run time of one job.
+         * @param priority Tie break between equal deadlines, 0 first.
+         * @param phase_us Offset of the first release, modulo the task period.
+         * @param deadline_us Time from each release to finish the job in, for
+         * a job that must not wait behind work due later. 0, or more than the
+         * period, for the next release.
+         */
+        void add_task(task_fn run, uint8_t arg, uint16_t rate_hz, uint32_t duration_us,
+                      uint8_t priority, uint32_t phase_us = 0, uint32_t deadline_us = 0);
+
+        /**
+         * @brief Lay out the new task set. On success it replaces the table in
+         * use, at once or, during run_cycle, from the next cycle on; otherwise
+         * the old table stays, and so does one still waiting for the next
+         * cycle, and the result says why.
+         */
+        build_result build(void);
+
+        /**
+         * @brief Run one cycle of the table, sleeping between slots.
+         */
+        void run_cycle(void);
+
+        /**
+         * @brief Run background each time wake is released while run_cycle
+         * waits for a slot or the next cycle. It may rebuild the schedule or
+         * abort the cycle, and counts against the lateness of the next slot.
+         *
+         * @param background nullptr to only sleep between slots.
+         */
+        void set_background(background_fn background, Semaphore* wake);
+
+        /**
+         * @brief Return from run_cycle after the slot running now, without
+         * waiting out the cycle. The next run_cycle starts a fresh timeline.
+         */
+        void abort_cycle(void) { _abort = true; }
+
+        /**
+         * @brief Timing since the last reset_timing().
+         */
+        struct timing_stats {
+            uint32_t    cycles;         /* Cycles started */
+            uint32_t    overruns;       /* Cycles started over a period late, timeline restarted */
+            uint32_t    periods;        /* Back to back cycles measured */
+            uint64_t    period_sum_us;
+            uint32_t    period_min_us;
+            uint32_t    period_max_us;
+            uint32_t    slots_run;
+            uint64_t    late_sum_us;    /* Slot start behind the tick it waited for */
+            uint32_t    late_max_us;
+            uint8_t     late_max_task;  /* Task of the latest slot, in add_task order */
+        };
+
+        const timing_stats& timing(void) const { return _timing; }
+
+        void reset_timing(void);
+
+        /**
+         * @brief Mean measured cycle period minus CYCLE_PERIOD_US: the drift
+         * per cycle.
+         */
+        int32_t period_error_us(void) const;
+
+        /**
+         * @brief Longest minus shortest measured cycle period.
+         */
+        uint32_t period_jitter_us(void) const;
+
+        /**
+         * @brief Mean lateness over every slot run.
+         */
+        uint32_t mean_late_us(void) const;
+
+        /**
+         * @brief Worst lateness of a slot in the table in use.
+         */
+        uint32_t slot_late_max_us(uint16_t slot) const { return _slot_late_max_us[slot]; }
+
+        /**
+         * @brief Slots in the table in use.
+         */
+        uint16_t slots(void) const { return _num_slots[_active]; }
+
+        /**
+         * @brief Start of a slot in the table in use, microseconds into the
+         * cycle.
+         */
+        uint32_t slot_start(uint16_t slot) const { return _slots[_active][slot].start_us; }
+
+        /**
+         * @brief Task of a slot in the table in use, in add_task order.
+         */
+        uint8_t slot_task(uint16_t slot) const { return _slots[_active][slot].task; }
+
+        /**
+         * @brief Sum of rate x run time of the last task set built, in parts
+         * per million of the cycle.
+         */
+        uint32_t load_ppm(void) const { return _load_ppm; }
+
+        /**
+         * @brief Task that could not be placed by the last failed build, in
+         * add_task order.
+         */
+        uint8_t failed_task(void) const { return _failed_task; }
+
+    private:
+        struct task {
+            task_fn     run;
+            uint8_t     arg;
+            uint16_t    rate_hz;
+            uint32_t    duration_us;
+            uint8_t     priority;
+            uint32_t    phase_us;
+            uint32_t    deadline_us;
+        };
+
+        struct slot {
+            uint32_t    start_us;
+            uint8_t     task;
+        };
+
+        /**
+         * @brief Release time of job k of a task, microseconds into the cycle.
+         */
+        static uint32_t _release(const task& t, uint16_t k);
+
+        /**
+         * @brief Make the table waiting in _ready the one in use.
+         */
+        void _take_over(void);
+
+        /**
+         * @brief Wait for the start of the cycle, or start a new timeline if
+         * there is none or it is over a period behind, and measure it.
+         */
+        void _start_cycle(void);
+
+        /**
+         * @brief Sleep until tick, running the background work whenever it
+         * is woken. Returns early on abort_cycle.
+         */
+        void _sleep_until(Kernel::Clock::time_point tick);
+
+        /**
+         * @brief Account for a slot starting late_us behind its tick.
+         */
+        void _record_late(uint16_t slot, uint8_t task, uint32_t late_us);
+
+        /**
+         * @brief Microseconds on _clock.
+         */
+        uint64_t _now_us(void) const { return _clock.elapsed_time().count(); }
+
+        /**
+         * @brief Task sets and tables: the one in use (_active), the last
+         * one built, which waits for the next cycle while _pending (_ready),
+         * and the one being built (_build). The three indices are always
+         * distinct.
+         */
+        task        _tasks[3][CYCLE_MAX_TASKS];
+        uint8_t     _num_tasks[3];
+        slot        _slots[3][CYCLE_MAX_SLOTS];
+        uint16_t    _num_slots[3];
+        uint8_t     _active;
+        uint8_t     _ready;
+        uint8_t     _build;
+
+        /**
+         * @brief add_task was called more than CYCLE_MAX_TASKS times.
+         */
+        bool        _overflow;
+
+        /**
+         * @brief A table was built during run_cycle and waits in _ready for
+         * the next cycle.
+         */
+        bool        _pending;
+
+        /**
+         * @brief Inside run_cycle.
+         */
+        bool        _running;
+
+        /**
+         * @brief Set by abort_cycle.
+         */
+        volatile bool _abort;
+
+        background_fn _background;
+        Semaphore*  _wake;
+
+        /**
+         * @brief Free running microsecond clock for measurements.
+         */
+        Timer       _clock;
+
+        /**
+         * @brief Start of the current cycle as a kernel tick and on _clock.
+         * Only valid while _anchored.
+         */
+        Kernel::Clock::time_point _cycle_tick;
+        uint64_t    _cycle_us;
+        bool        _anchored;
+
+        /**
+         * @brief Measured start of the last cycle, for its period.
+         */
+        uint64_t    _last_start_us;
+        bool        _have_last_start;
+
+        timing_stats _timing;
+        uint32_t    _slot_late_max_us[CYCLE_MAX_SLOTS];
+
+        uint32_t    _load_ppm;
+        uint8_t     _failed_task;
+};
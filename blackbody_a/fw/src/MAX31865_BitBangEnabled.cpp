@@ -36,39 +36,75 @@
 //#include <Arduino.h>
 
 #include <MAX31865_BitBangEnabled.h>
+#include "MAX31865_CVDTable.h"
 #include "mbed.h"
 
+/* Configuration bits that clear themselves: 1-shot (D5), fault detection
+   (D3:D2) and fault clear (D1). */
+#define CONFIGURATION_SELF_CLEARING  0x2E
+
+/* Coefficients, indexed by MAX31865_RTD::rtd_standard. */
+static constexpr MAX31865_CVDCoefficients cvd_coefficients[] = {
+  { RTD_A_DIN43760,     RTD_B_DIN43760,     RTD_C_DIN43760 },
+  { RTD_A_USINDUSTRIAL, RTD_B_USINDUSTRIAL, RTD_C_USINDUSTRIAL },
+  { RTD_A_ITS90,        RTD_B_ITS90,        RTD_C_ITS90 },
+};
+
+/* Conversion tables, built by the compiler and placed in flash.  The code
+   only depends on R/R0, and RREF/R0 is the same for the PT100 and PT1000,
+   so one table per standard serves both. */
+static_assert( RTD_RREF_PT100 * RTD_RESISTANCE_PT1000 == RTD_RREF_PT1000 * RTD_RESISTANCE_PT100,
+               "PT100 and PT1000 need separate tables" );
+typedef MAX31865_CVDTable<RTD_RESISTANCE_PT100, RTD_RREF_PT100> cvd_table;
+static constexpr cvd_table cvd_tables[] = {
+  cvd_table( cvd_coefficients[ MAX31865_RTD::RTD_DIN43760 ] ),
+  cvd_table( cvd_coefficients[ MAX31865_RTD::RTD_USINDUSTRIAL ] ),
+  cvd_table( cvd_coefficients[ MAX31865_RTD::RTD_ITS90 ] ),
+};
+
 /**
  * The constructor for the MAX31865_RTD class registers the CS pin and
- * configures it as an output.
+ * configures it as an output.  The chip is driven over a bit-banged bus on
+ * the given pins, which the object owns and frees.
  *
- * @param [in] cs_pin Arduino pin selected for the CS signal.
+ * @param [in] type PT100 or PT1000.
+ * @param [in] mosi Pin wired to SDI.
+ * @param [in] miso Pin wired to SDO.
+ * @param [in] sclk Pin wired to SCLK.
+ * @param [in] nss Pin wired to CS.
  */
 MAX31865_RTD::MAX31865_RTD( ptd_type type, PinName mosi, PinName miso, PinName sclk, PinName nss)
-    :spi(mosi,miso,sclk,nss),
-     nss( nss )
-     
+    : MAX31865_RTD( type, new MAX31865_BitBangTransport( mosi, miso, sclk, nss ) )
+{
+  owned_transport = transport;
+}
 
+
+
+/**
+ * Construct a MAX31865_RTD on an existing transport, e.g. a
+ * MAX31865_SPITransport.  The transport must outlive the object.
+ *
+ * @param [in] type PT100 or PT1000.
+ * @param [in] transport Bus used to reach the chip.
+ */
+MAX31865_RTD::MAX31865_RTD( ptd_type type, MAX31865_Transport* transport )
+    : transport( transport ), owned_transport( nullptr ), standard( RTD_DIN43760 ),
+      shadow_configuration( 0 ), shadow_high_threshold( 0 ), shadow_low_threshold( 0 ), shadow_valid( 0 ),
+      unverified( false )
 {
   /* Set the type of PTD. */
-      this->type = type;
-      
-      //spi.format(8,3); //8 bit messages, CPOL/SPHA mode set to 3 (11), see spi.h
-      //spi clock polarity/phase (CPOL & CPHA) is set to 11 in spi.format (bit 1 = polarity, bit 0 = phase, see spi.h)
-      //polarity of 1 indicates that the spi reading idles high (default setting is 1; polarity of 0 means idle is 0)
-      //phase of 1 indicates that data is read on the first edge/low-to-high leg (as opposed to phase 0,
-      //which reads data on the second edge/high-to-low transition)
-      //see https://deardevices.com/2020/05/31/spi-cpol-cpha/ to understand CPOL/CPHA
-      //spi.frequency(100000); 
-    
-    //nss = 1;
-  /* CS pin for the spi device. */
-  //this->cs_pin = cs_pin;
-  //pinMode( this->cs_pin, OUTPUT );
-
-  /* Pull the CS pin high to avoid conflicts on spi bus. */
-//   nss = 1;
-  //nss = type;
+  this->type = type;
+}
+
+
+
+/**
+ * Free the transport if the pin constructor made it.
+ */
+MAX31865_RTD::~MAX31865_RTD( )
+{
+  delete owned_transport;
 }
 
 
@@ -97,7 +133,6 @@ void MAX31865_RTD::configure( bool v_bias, bool conversion_mode, bool one_shot,
                               uint16_t high_threshold )
 {
   uint8_t control_bits = 0;
-   nss = 1;
   /* Assemble the control bit mask. */
   control_bits |= ( v_bias ? 0x80 : 0 );
   control_bits |= ( conversion_mode ? 0x40 : 0 );
@@ -113,49 +148,149 @@ void MAX31865_RTD::configure( bool v_bias, bool conversion_mode, bool one_shot,
   this->configuration_low_threshold  = low_threshold;
   this->configuration_high_threshold = high_threshold;
 
-  /* Perform an initial "reconfiguration." */
+  /* Perform an initial "reconfiguration."  Only registers that change are
+     written. */
   reconfigure( );
 }
 
 
 
 /**
- * Reconfigure the MAX31865 by writing the stored control bits and the stored fault
- * threshold values back to the chip.
+ * Reconfigure the MAX31865 by writing the stored control bits and the stored
+ * fault threshold values back to the chip, those registers only that the
+ * shadow says differ or are unknown.  Nothing moves on the bus, and there is
+ * no wait, when the chip already holds the configuration.
+ *
+ * @return The registers written, MAX31865_REG_* bits
  */ 
 
  //must edit reconfigure to be 2, 3, or 4-wire mode
-void MAX31865_RTD::reconfigure( )
+uint8_t MAX31865_RTD::reconfigure( )
 {
-  /* Write the configuration to the MAX31865. */
+  /* Vbias is bias( )'s to switch in one-shot mode. */
+  const uint8_t mask = ( this->configuration_control_bits & 0x40 ) ? 0xD1 : 0x51;
+  uint8_t buffer[5];
+  uint8_t stale = 0;
 
-  spi.select();
+  if(    !( this->shadow_valid & MAX31865_REG_CONFIGURATION )
+      || ( this->shadow_configuration & mask ) != ( this->configuration_control_bits & mask ) )
+  {
+    stale |= MAX31865_REG_CONFIGURATION;
+  }
+  if(    !( this->shadow_valid & MAX31865_REG_HIGH_THRESHOLD )
+      || this->shadow_high_threshold != this->configuration_high_threshold )
+  {
+    stale |= MAX31865_REG_HIGH_THRESHOLD;
+  }
+  if(    !( this->shadow_valid & MAX31865_REG_LOW_THRESHOLD )
+      || this->shadow_low_threshold != this->configuration_low_threshold )
+  {
+    stale |= MAX31865_REG_LOW_THRESHOLD;
+  }
+  if( stale == 0 )
+  {
+    return( 0 );
+  }
 
-  nss = 0;      //Chip select is negative logic;
   wait_us(100);
-  spi.write( 0x80 );    //configuration write register is address 0x80
-  spi.write( this->configuration_control_bits);
-  nss = 1;
-
-  /* Write the threshold values. */
-  nss = 0;
- // wait_us(100);
-  spi.write( 0x83 );    //threshold write registers start from 0x83
-  spi.write( ( this->configuration_high_threshold >> 8 ) & 0x00ff ); //MSBs of high threshold get written to MSB high register
-  spi.write(   this->configuration_high_threshold        & 0x00ff );    //LSBs of high threshold get written to MSB high register
-  spi.write( ( this->configuration_low_threshold >> 8 ) & 0x00ff );     //MSBs of low threshold get written to MSB high register
-  spi.write(   this->configuration_low_threshold        & 0x00ff );     //lSBs of low threshold get written to MSB high register
-  nss = 1;
-  
-  //relinquish control of spi bus
-  spi.deselect();
+
+  /* Write the configuration to the MAX31865. */
+  if( stale & MAX31865_REG_CONFIGURATION )
+  {
+    write_configuration( this->configuration_control_bits );
+  }
+
+  /* Write the threshold values, in one burst if both changed. */
+  buffer[0] = 0x83;    //threshold write registers start from 0x83
+  buffer[1] = ( this->configuration_high_threshold >> 8 ) & 0x00ff; //MSBs of high threshold get written to MSB high register
+  buffer[2] =   this->configuration_high_threshold        & 0x00ff; //LSBs of high threshold get written to LSB high register
+  buffer[3] = ( this->configuration_low_threshold >> 8 ) & 0x00ff;  //MSBs of low threshold get written to MSB low register
+  buffer[4] =   this->configuration_low_threshold        & 0x00ff;  //LSBs of low threshold get written to LSB low register
+  if( ( stale & MAX31865_REG_HIGH_THRESHOLD ) && ( stale & MAX31865_REG_LOW_THRESHOLD ) )
+  {
+    transport->transfer( buffer, buffer, 5 );
+  }
+  else if( stale & MAX31865_REG_HIGH_THRESHOLD )
+  {
+    transport->transfer( buffer, buffer, 3 );
+  }
+  else if( stale & MAX31865_REG_LOW_THRESHOLD )
+  {
+    buffer[2] = 0x85;    //low threshold write registers start from 0x85
+    transport->transfer( &buffer[2], &buffer[2], 3 );
+  }
+  this->shadow_high_threshold = this->configuration_high_threshold;
+  this->shadow_low_threshold  = this->configuration_low_threshold;
+  this->shadow_valid = MAX31865_REG_CONFIGURATION | MAX31865_REG_HIGH_THRESHOLD | MAX31865_REG_LOW_THRESHOLD;
+
+  return( stale );
+}
+
+
+
+/**
+ * Write the Configuration register and note in the shadow what it holds
+ * once the self-clearing bits have cleared.
+ *
+ * @param [in] control_bits Configuration register value.
+ */
+void MAX31865_RTD::write_configuration( uint8_t control_bits )
+{
+  uint8_t buffer[2];
+
+  buffer[0] = 0x80;    //configuration write register is address 0x80
+  buffer[1] = control_bits;
+  transport->transfer( buffer, buffer, 2 );
+
+  this->shadow_configuration = control_bits & ~CONFIGURATION_SELF_CLEARING;
+  this->shadow_valid |= MAX31865_REG_CONFIGURATION;
+}
+
+
+
+/**
+ * Clear the Fault Status register, leaving the rest of the configuration as
+ * it is.  Cheaper than reconfigure( ) when the chip is known to be set up.
+ */
+void MAX31865_RTD::clear_fault( )
+{
+  /* D1 set, with D5 (1-shot), D3 and D2 (fault detection) at 0. */
+  write_configuration( ( this->configuration_control_bits & ~0x2C ) | 0x02 );
+}
+
+
+
+/**
+ * The registers whose values last read from the chip are not what the
+ * shadow says was written, e.g. after a brown-out.  The self-clearing bits
+ * are left out; Vbias is compared with what bias( ) last wrote.
+ *
+ * @return MAX31865_REG_* bits
+ */
+uint8_t MAX31865_RTD::lost( ) const
+{
+  uint8_t lost = 0;
+
+  if( ( this->measured_configuration & ~CONFIGURATION_SELF_CLEARING ) != this->shadow_configuration )
+  {
+    lost |= MAX31865_REG_CONFIGURATION;
+  }
+  if( this->measured_high_threshold != this->shadow_high_threshold >> 1 )
+  {
+    lost |= MAX31865_REG_HIGH_THRESHOLD;
+  }
+  if( this->measured_low_threshold != this->shadow_low_threshold >> 1 )
+  {
+    lost |= MAX31865_REG_LOW_THRESHOLD;
+  }
+  return( lost );
 }
 
 
 
 /**
  * Apply the Callendar-Van Dusen equation to convert the RTD resistance
- * to temperature:
+ * to temperature.  At or above 0 degrees Celcius, solve
  *
  *   \f[
  *   t=\frac{-A\pm \sqrt{A^2-4B\left(1-\frac{R_t}{R_0}\right)}}{2B}
@@ -165,27 +300,76 @@ void MAX31865_RTD::reconfigure( )
  *
  * \f$A\f$ and \f$B\f$ are the RTD coefficients, \f$R_t\f$ is the current
  * resistance of the RTD, and \f$R_0\f$ is the resistance of the RTD at 0
- * degrees Celcius.
+ * degrees Celcius.  Below 0 degrees the equation gains the term
+ * \f$C(t-100)t^3\f$; the quadratic solution is refined with a fixed number
+ * of Newton steps (see MAX31865_CVDTable.h).
  *
  * For more information on measuring with an RTD, see:
  * <http://newton.ex.ac.uk/teaching/CDHW/Sensors/an046.pdf>.
  *
- * @param [in] resistance The measured RTD resistance.
+ * The L432 FPU is single precision, so this runs in software; prefer
+ * temperature_centi( ) for periodic sampling.
+ *
+ * @param [in] type PT100 or PT1000.
+ * @param [in] standard Coefficient set of the RTD.
+ * @param [in] raw_resistance The 15-bit RTD code.
  * @return Temperature in degrees Celcius.
  */
-double MAX31865_RTD::temperature( ) const
+double MAX31865_RTD::temperature( ptd_type type, rtd_standard standard, uint16_t raw_resistance )
 {
-  static const double a2   = 2.0 * RTD_B;
-  static const double b_sq = RTD_A * RTD_A;
+  const MAX31865_CVDCoefficients& cvd = cvd_coefficients[ standard ];
 
   const double rtd_resistance =
-    ( this->type == RTD_PT100 ) ? RTD_RESISTANCE_PT100 : RTD_RESISTANCE_PT1000;
+    ( type == RTD_PT100 ) ? RTD_RESISTANCE_PT100 : RTD_RESISTANCE_PT1000;
+  const double rtd_rref =
+    ( type == RTD_PT100 ) ? (double)RTD_RREF_PT100 : (double)RTD_RREF_PT1000;
+  const double resistance = (double)raw_resistance * rtd_rref / (double)RTD_ADC_RESOLUTION;
+  const double ratio = resistance / rtd_resistance;
 
-  double c = 1.0 - resistance( ) / rtd_resistance;
-  double D = b_sq - 2.0 * a2 * c;
-  double temperature_deg_C = ( -RTD_A + sqrt( D ) ) / a2;
+  double c = 1.0 - ratio;
+  double D = cvd.a * cvd.a - 4.0 * cvd.b * c;
+  double temperature_deg_C = ( -cvd.a + sqrt( D ) ) / ( 2.0 * cvd.b );
 
-  return( temperature_deg_C );
+  return( max31865_cvd::refine( temperature_deg_C, ratio, cvd.a, cvd.b, cvd.c ) );
+}
+
+
+
+/**
+ * Temperature of the last measured resistance, in degrees Celcius.
+ */
+double MAX31865_RTD::temperature( ) const
+{
+  return( temperature( this->type, this->standard, raw_resistance( ) ) );
+}
+
+
+
+/**
+ * Convert an RTD code to temperature using the compile-time Callendar-Van
+ * Dusen table for the RTD standard (see MAX31865_CVDTable.h).  Integer only;
+ * the result is within 0.01 degrees of temperature( ).
+ *
+ * @param [in] type PT100 or PT1000.
+ * @param [in] standard Coefficient set of the RTD.
+ * @param [in] raw_resistance The 15-bit RTD code.
+ * @return Temperature in hundredths of a degree Celcius.
+ */
+int32_t MAX31865_RTD::temperature_centi( ptd_type type, rtd_standard standard, uint16_t raw_resistance )
+{
+  ( void )type;
+  return( cvd_tables[ standard ].centi_degrees( raw_resistance ) );
+}
+
+
+
+/**
+ * Temperature of the last measured resistance, in hundredths of a degree
+ * Celcius.
+ */
+int32_t MAX31865_RTD::temperature_centi( ) const
+{
+  return( temperature_centi( this->type, this->standard, raw_resistance( ) ) );
 }
 
 
@@ -198,14 +382,9 @@ double MAX31865_RTD::temperature( ) const
  */
 uint8_t MAX31865_RTD::read_all( )
 {
+  uint8_t buffer[9] = { 0 };
   uint16_t combined_bytes = 0;
 
-  //spi clock polarity/phase (CPOL & CPHA) is set to 11 in spi.format (bit 1 = polarity, bit 0 = phase, see spi.h)
-  //polarity of 1 indicates that the spi reading idles high (default setting is 1; polarity of 0 means idle is 0)
-  //phase of 1 indicates that data is read on the first edge/low-to-high leg (as opposed to phase 0,
-  //which reads data on the second edge/high-to-low transition)
-  //see https://deardevices.com/2020/05/31/spi-cpol-cpha/ to understand CPOL/CPHA
-
   //chip select is negative logic, idles at 1
   //When chip select is set to 0, the chip is then waiting for a value to be written over spi
   //That value represents the first register that it reads from
@@ -213,65 +392,240 @@ uint8_t MAX31865_RTD::read_all( )
   //00 = configuration register, 01 = MSBs of resistance value, 02 = LSBs of
   //Registers available on datasheet at https://datasheets.maximintegrated.com/en/ds/MAX31865.pdf
   //The chip then automatically increments to read from the next register
-  
-  // when reading from multiple chips sequentially, the spi connection for a chip must be specified before the spi.write function executes.
-  // if spi.select() has not been executed beforehand, the spi connection between the ADC and microcontroller will re-initialize/transfer control to the current ADC as soon as
-  // it calls the first spi write after nss=0. However, transferring spi control causes the clock to go low to re-initialize the spi connection/handshake (this is while nss = 0), 
-  // so the microcontroller sees the spi re-initialization as one clock cycle.
-  // the re-initialization of the spi connection to the given ADC can be done before nss = 0 by executing spi.select() or performing spi.write(0x00). (0x00 is an arbitrary value)
-  // example: https://i.stack.imgur.com/o3KoR.jpg (erroneous low at start)
-  // see explanation at https://stackoverflow.com/questions/71366463/spi-extra-clock-cycle-over-communication-between-stm32-nucleo-l432kc-and-max3186
-  spi.select();
-  
-  /* Start the read operation. */
-  nss = 0; //tell the MAX31865 we want to start reading, waiting for starting address to be written
-  /* Tell the MAX31865 that we want to read, starting at register 0. */
-  
-  
-  spi.write( 0x00 ); //start reading values starting at register 00h
-
-  /* Read the MAX31865 registers in the following order:
+  //The transport asserts chip select around the whole burst, and takes care of
+  //the SPI clock polarity/phase and the extra clock cycle seen when control of
+  //the SPI peripheral moves between chips (see MAX31865_SPITransport.cpp).
+
+  /* Tell the MAX31865 that we want to read, starting at register 0, then
+     read the MAX31865 registers in the following order:
        Configuration (00)
        RTD (01 = MSBs, 02 = LSBs)
        High Fault Threshold (03 = MSBs, 04 = LSBs)
        Low Fault Threshold (05 = MSBs, 06 = LSBs)
        Fault Status (07) */
-    
-    this->measured_resistance = 0;
+  buffer[0] = 0x00; //start reading values starting at register 00h
+  transport->transfer( buffer, buffer, sizeof( buffer ) );
 
-  this->measured_configuration = spi.write( 0x00 ); //read from register 00
+  this->measured_configuration = buffer[1]; //read from register 00
     //automatic increment to register 01
-  combined_bytes  = spi.write( 0x00 ) << 8; //8 bit value from register 01, bit shifted 8 left
+  combined_bytes  = buffer[2] << 8; //8 bit value from register 01, bit shifted 8 left
     //automatic increment to register 02, OR with previous bit shifted value to get complete 16 bit value
-  combined_bytes |= spi.write( 0x00 );
+  combined_bytes |= buffer[3];
   //bit 0 of LSB is a fault bit, DOES NOT REPRESENT RESISTANCE VALUE
   //bit shift 16-bit value 1 right to remove fault bit and get complete 15 bit raw resistance reading
   this->measured_resistance = combined_bytes >> 1;
     //high fault threshold
-  combined_bytes  = spi.write( 0x00 ) << 8;
-  combined_bytes |= spi.write( 0x00 );
+  combined_bytes  = buffer[4] << 8;
+  combined_bytes |= buffer[5];
   this->measured_high_threshold = combined_bytes >> 1;
     //low fault threshold
-  combined_bytes  = spi.write( 0x00 ) << 8;
-  combined_bytes |= spi.write( 0x00 );
+  combined_bytes  = buffer[6] << 8;
+  combined_bytes |= buffer[7];
   this->measured_low_threshold = combined_bytes >> 1;
     //fault status
-  this->measured_status = spi.write( 0x00 );
+  this->measured_status = buffer[8] & 0xFC;    //D1 and D0 are don't care
+
+  /* Clear a fault: the caller gets it in the status and decides what to do
+     with the channel.  Then write back whatever the chip lost, e.g. in a
+     brown-out, and only that; clearing the fault already restores the
+     configuration.  A zero reading with the registers intact is the RTD's,
+     not the chip's, and rewriting them would not change it. */
+  this->shadow_valid &= ~lost( );
+  if( this->measured_status != 0 )
+  {
+    clear_fault( );
+  }
+  reconfigure( );
+  this->unverified = false;
+
+  return( status( ) );
+}
+
+
+
+/**
+ * Run the automatic fault detection cycle (Table 3 in the MAX31865
+ * datasheet) and read the Fault Status register.  Threshold and
+ * over/under-voltage faults show up on any conversion; the REFIN- and RTDIN-
+ * checks of bits D5 to D3, which find open or shorted wiring, only run in
+ * this cycle.  Conversions stop for up to MAX31865_FAULT_CYCLE_US and then
+ * resume with the stored configuration, which also clears the status; the
+ * thresholds are only written again if the chip lost them.
+ *
+ * Blocks for about 0.6 ms; call it on a slow cadence.
+ *
+ * @return Fault status byte; MAX31865_FAULT_CYCLE_TIMEOUT if the cycle never
+ *         ran or never finished
+ */
+uint8_t MAX31865_RTD::detect_faults( )
+{
+  uint8_t buffer[2];
+
+  /* 100X010Xb: bias on, conversions off, wiring and filter as configured. */
+  write_configuration( 0x80 | ( this->configuration_control_bits & 0x11 ) | MAX31865_FAULT_DETECTION_AUTO );
+
+  /* D3:D2 self-clear once the cycle is complete.  Vbias reading back off
+     means nothing answered, or the chip reset on the way. */
+  wait_us( MAX31865_FAULT_CYCLE_US );
+  for( uint8_t tries = 0; ; ++tries )
+  {
+    buffer[0] = 0x00;
+    transport->transfer( buffer, buffer, 2 );
+    if( ( buffer[1] & 0x8C ) == 0x80 )
+    {
+      break;
+    }
+    if( tries == 2 )
+    {
+      this->measured_status = MAX31865_FAULT_CYCLE_TIMEOUT;
+      write_configuration( this->configuration_control_bits );
+      reconfigure( );
+      return( status( ) );
+    }
+    wait_us( 100 );
+  }
+
+  buffer[0] = 0x07;
+  transport->transfer( buffer, buffer, 2 );
+  this->measured_status = buffer[1] & 0xFC;    //D1 and D0 are don't care
+
+  /* Back to the stored configuration, Vbias included; the thresholds stay. */
+  write_configuration( this->configuration_control_bits );
+  reconfigure( );
+  return( status( ) );
+}
+
+
+
+/**
+ * Switch Vbias on or off, for one-shot conversions: configure the chip with
+ * Vbias and auto conversion off, switch Vbias on, let it settle for 10.5
+ * time constants of the input filter plus 1 ms (see the MAX31865
+ * datasheet), start_conversion( ), then finish_conversion( ), which switches
+ * it off again.  The RTD only carries current, and heats, in between.
+ */
+void MAX31865_RTD::bias( bool on )
+{
+  /* The rest of the configuration, without 1-shot, fault detection or fault
+     clear. */
+  write_configuration( ( this->configuration_control_bits & ~0xAE ) | ( on ? 0x80 : 0 ) );
+}
+
 
-    //set chip select to 1; chip stops incrementing registers when chip select is high; ends read cycle
-  nss = 1;
-  //relingquish spi connection when chip is done reading
-  spi.deselect();
 
-  /* Reset the configuration if the measured resistance is
-     zero or a fault occurred. */
-  if(    ( this->measured_resistance == 0 )
-      || ( this->measured_status != 0 ) )
+/**
+ * Start a one-shot conversion; Vbias must have settled.  The result is
+ * ready MAX31865_CONVERSION_50HZ_US or MAX31865_CONVERSION_60HZ_US later,
+ * depending on the filter.  Conversions on several chips run side by side.
+ */
+void MAX31865_RTD::start_conversion( )
+{
+  write_configuration( ( this->configuration_control_bits & ~0xAE ) | 0x80 | 0x20 );
+}
+
+
+
+/**
+ * Wait for the conversion of start_conversion( ) and switch Vbias off.  The
+ * 1-shot bit self-clears when the result is in the RTD registers, so polling
+ * it stands in for the DRDY pin; a conversion that is not done yet gets up
+ * to MAX31865_CONVERSION_POLLS more polls, MAX31865_CONVERSION_POLL_US apart.
+ * The result stays in the registers for read_all( ) or read_resistance( )
+ * until the next conversion.
+ *
+ * @return 0, or MAX31865_FAULT_CYCLE_TIMEOUT if the conversion never
+ *         finished
+ */
+uint8_t MAX31865_RTD::finish_conversion( )
+{
+  uint8_t buffer[2];
+
+  for( uint8_t tries = 0; ; ++tries )
+  {
+    buffer[0] = 0x00;
+    transport->transfer( buffer, buffer, 2 );
+    /* Vbias still on, 1-shot cleared. */
+    if( ( buffer[1] & 0xA0 ) == 0x80 )
+    {
+      break;
+    }
+    if( tries == MAX31865_CONVERSION_POLLS )
+    {
+      bias( false );
+      this->measured_status = MAX31865_FAULT_CYCLE_TIMEOUT;
+      return( status( ) );
+    }
+    wait_us( MAX31865_CONVERSION_POLL_US );
+  }
+
+  bias( false );
+  return( 0 );
+}
+
+
+
+/**
+ * Read only the RTD resistance registers (01h and 02h).  This is the fast
+ * path for periodic sampling: a 3-byte burst instead of the 9 bytes moved by
+ * read_all( ).  Bit 0 of the LSB is set by the MAX31865 whenever the fault
+ * status register is non-zero, so a fault is still noticed on every read; in
+ * that case the full register set is read to fetch the fault status and the
+ * chip is reconfigured.  Call read_all( ) from time to time anyway to verify
+ * the configuration and thresholds.  A zero reading does not touch the bus
+ * again; it leaves verify_pending( ) set, for verify( ) off the sample path.
+ *
+ * @return Fault status byte
+ */
+uint8_t MAX31865_RTD::read_resistance( )
+{
+  uint8_t buffer[3] = { 0 };
+  uint16_t combined_bytes = 0;
+
+  buffer[0] = 0x01; //start reading values starting at register 01h
+  transport->transfer( buffer, buffer, sizeof( buffer ) );
+
+  combined_bytes  = buffer[1] << 8;
+  combined_bytes |= buffer[2];
+
+  if( combined_bytes & 0x0001 )
   {
-    reconfigure( );
+    return( read_all( ) );
+  }
+
+  this->measured_resistance = combined_bytes >> 1;
+  this->measured_status = 0;
+
+  if( this->measured_resistance == 0 )
+  {
+    this->unverified = true;
   }
 
   return( status( ) );
 }
 
 
+
+/**
+ * Read the configuration and thresholds back (registers 00h to 06h, one
+ * 8-byte burst), and write again those, and only those, that the chip lost.
+ * Meant for the background, e.g. once verify_pending( ) is set, rather than
+ * for the sample path: it leaves the last reading and status alone.
+ *
+ * @return The registers written back, MAX31865_REG_* bits; 0 if the chip
+ *         held its configuration
+ */
+uint8_t MAX31865_RTD::verify( )
+{
+  uint8_t buffer[8] = { 0 };
+
+  buffer[0] = 0x00; //start reading values starting at register 00h
+  transport->transfer( buffer, buffer, sizeof( buffer ) );
+
+  this->measured_configuration  = buffer[1];
+  this->measured_high_threshold = ( ( buffer[4] << 8 ) | buffer[5] ) >> 1;
+  this->measured_low_threshold  = ( ( buffer[6] << 8 ) | buffer[7] ) >> 1;
+  this->shadow_valid &= ~lost( );
+  this->unverified = false;
+
+  return( reconfigure( ) );
+}
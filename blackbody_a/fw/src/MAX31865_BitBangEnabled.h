@@ -35,7 +35,7 @@
 
 #include <stdint.h>
 #include "mbed.h"
-#include "BitBang.cpp"
+#include "MAX31865_Transport.h"
 
 #define MAX31865_FAULT_HIGH_THRESHOLD  ( 1 << 7 )
 #define MAX31865_FAULT_LOW_THRESHOLD   ( 1 << 6 )
@@ -43,31 +43,50 @@
 #define MAX31865_FAULT_REFIN_FORCE     ( 1 << 4 )
 #define MAX31865_FAULT_RTDIN_FORCE     ( 1 << 3 )
 #define MAX31865_FAULT_VOLTAGE         ( 1 << 2 )
+/* Not a chip bit: a fault detection cycle or a one-shot conversion that never
+   ran or never finished, e.g. with no chip answering on the bus.  See
+   MAX31865_RTD::detect_faults( ) and MAX31865_RTD::finish_conversion( ). */
+#define MAX31865_FAULT_CYCLE_TIMEOUT   ( 1 << 1 )
 
 #define MAX31865_FAULT_DETECTION_NONE      ( 0x00 << 2 )
 #define MAX31865_FAULT_DETECTION_AUTO      ( 0x01 << 2 )
 #define MAX31865_FAULT_DETECTION_MANUAL_1  ( 0x02 << 2 )
 #define MAX31865_FAULT_DETECTION_MANUAL_2  ( 0x03 << 2 )
 
+/* Automatic fault detection cycle, CS high to cycle complete (max). */
+#define MAX31865_FAULT_CYCLE_US  600
 
+/* One-shot conversion, CS high to data ready (max), with the 50 Hz and the
+   60 Hz filter. */
+#define MAX31865_CONVERSION_50HZ_US  62500
+#define MAX31865_CONVERSION_60HZ_US  52000
+/* How long finish_conversion( ) keeps polling a conversion that is not done. */
+#define MAX31865_CONVERSION_POLL_US  1000
+#define MAX31865_CONVERSION_POLLS    5
 
-/* RTD data, RTD current, and measurement reference
-   voltage. The ITS-90 standard is used; other RTDs
-   may have coefficients defined by the DIN 43760 or
-   the U.S. Industrial (American) standard. */
-#define RTD_A_ITS90         3.9080e-3
+/* Registers, as reported by MAX31865_RTD::verify( ). */
+#define MAX31865_REG_CONFIGURATION   ( 1 << 0 )
+#define MAX31865_REG_HIGH_THRESHOLD  ( 1 << 1 )
+#define MAX31865_REG_LOW_THRESHOLD   ( 1 << 2 )
+
+
+
+/* Callendar-Van Dusen coefficients of the RTD standards,
+   from Maxim application note 3450 (Table 1). The
+   standard is selected per channel at run time, see
+   MAX31865_RTD::set_standard( ).  DIN 43760
+   (alpha = 0.00385) is the common PT100/PT1000. */
+#define RTD_A_ITS90         3.9848e-3
 #define RTD_A_USINDUSTRIAL  3.9692e-3
-#define RTD_A_DIN43760      3.9848e-3
+#define RTD_A_DIN43760      3.9080e-3
 #define RTD_B_ITS90         -5.870e-7
 #define RTD_B_USINDUSTRIAL  -5.8495e-7
 #define RTD_B_DIN43760      -5.8019e-7
 /* RTD coefficient C is required only for temperatures
-   below 0 deg. C.  The selected RTD coefficient set
-   is specified below. */
-#define SELECT_RTD_HELPER(x) x
-#define SELECT_RTD(x) SELECT_RTD_HELPER(x)
-#define RTD_A         SELECT_RTD(RTD_A_ITS90)
-#define RTD_B         SELECT_RTD(RTD_B_ITS90)
+   below 0 deg. C. */
+#define RTD_C_ITS90         -4.0000e-12
+#define RTD_C_USINDUSTRIAL  -4.2325e-12
+#define RTD_C_DIN43760      -4.2735e-12
 /*
  * The reference resistor on the hardware; see the MAX31865 datasheet
  * for details.  The values 400 and 4000 Ohm are recommended values for
@@ -90,13 +109,30 @@ class MAX31865_RTD
 {
 public:
   enum ptd_type { RTD_PT100, RTD_PT1000 };
+  enum rtd_standard { RTD_DIN43760, RTD_USINDUSTRIAL, RTD_ITS90 };
 
   MAX31865_RTD( ptd_type type,PinName pinmosi, PinName pinmiso, PinName pinsclk, PinName pinnss);
+  MAX31865_RTD( ptd_type type, MAX31865_Transport* transport );
+  ~MAX31865_RTD( );
+  MAX31865_RTD( const MAX31865_RTD& ) = delete;
+  MAX31865_RTD& operator=( const MAX31865_RTD& ) = delete;
   void configure( bool v_bias, bool conversion_mode, bool one_shot, bool three_wire,
                   uint8_t fault_cycle, bool fault_clear, bool filter_50hz,
                   uint16_t low_threshold, uint16_t high_threshold );
   uint8_t read_all( );
+  uint8_t read_resistance( );
+  uint8_t verify( );
+  bool verify_pending( ) const { return( unverified ); }
+  uint8_t detect_faults( );
+  void bias( bool on );
+  void start_conversion( );
+  uint8_t finish_conversion( );
+  void set_standard( rtd_standard standard ) { this->standard = standard; }
+  rtd_standard get_standard( ) const { return( standard ); }
   double temperature( ) const;
+  int32_t temperature_centi( ) const;
+  static double temperature( ptd_type type, rtd_standard standard, uint16_t raw_resistance );
+  static int32_t temperature_centi( ptd_type type, rtd_standard standard, uint16_t raw_resistance );
   uint8_t configuration( ) const { return( (measured_configuration == configuration_control_bits)? configuration_control_bits:measured_configuration); }
   uint8_t status( ) const { return( measured_status ); }
   uint16_t low_threshold( ) const { return( measured_low_threshold ); }
@@ -114,15 +150,30 @@ private:
         /*!
     * spi Interface
     */
-    BitBangSPI spi; // mosi, miso, sclk
-    DigitalOut nss;
+    MAX31865_Transport* transport;
+  /* The bit-banged transport made by the pin constructor, nullptr when the
+     caller owns it. */
+  MAX31865_Transport* owned_transport;
   /* Our configuration. */
  // uint8_t  cs_pin;
   ptd_type type;
+  rtd_standard standard;
   uint8_t  configuration_control_bits;
   uint16_t configuration_low_threshold;
   uint16_t configuration_high_threshold;
-  void reconfigure( );
+  uint8_t reconfigure( );
+  void write_configuration( uint8_t control_bits );
+  void clear_fault( );
+  uint8_t lost( ) const;
+
+  /* What the chip holds, as far as we know: what was last written to it and
+     has not read back different since.  Registers not in shadow_valid are
+     unknown. */
+  uint8_t  shadow_configuration;
+  uint16_t shadow_high_threshold;
+  uint16_t shadow_low_threshold;
+  uint8_t  shadow_valid;
+  bool     unverified;
 
   /* Values read from the device. */
   uint8_t  measured_configuration;
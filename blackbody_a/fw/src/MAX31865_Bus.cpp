@@ -0,0 +1,86 @@
+/**
+ * @file MAX31865_Bus.cpp
+ * @brief Bit-banged MAX31865 bus with a chip select per chip.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#include "MAX31865_Bus.h"
+
+MAX31865_Bus::MAX31865_Bus(PinName mosi, PinName miso, PinName sclk)
+    : _chips(0)
+{
+    gpio_init_out_ex(&_mosi, mosi, 0);
+    gpio_init_in_ex(&_miso, miso, PullNone);
+    gpio_init_out_ex(&_sclk, sclk, 0);
+}
+
+int MAX31865_Bus::add(PinName cs, I2C* i2c)
+{
+    if (_chips >= MAX31865_BUS_CHIPS || cs == NC) {
+        return -1;
+    }
+    // The console owns its pins whatever the pin map says
+    if (cs == USBTX || cs == USBRX) {
+        return -1;
+    }
+    if (cs == _mosi.pin || cs == _miso.pin || cs == _sclk.pin) {
+        return -1;
+    }
+    for (uint8_t chip = 0; chip < _chips; ++chip) {
+        if (_cs[chip].pin == cs) {
+            return -1;
+        }
+    }
+
+    if (i2c) {
+        // Released high, the I2C pull-ups hold CS up
+        gpio_init_inout(&_cs[_chips], cs, PIN_OUTPUT, OpenDrainNoPull, 1);
+    } else {
+        gpio_init_out_ex(&_cs[_chips], cs, 1);
+    }
+    _i2c[_chips] = i2c;
+    return _chips++;
+}
+
+void MAX31865_Bus::transfer(uint8_t chip, const uint8_t* tx, uint8_t* rx, int length)
+{
+    if (chip >= _chips) {
+        // Nobody selected, SDO floats high
+        memset(rx, 0xFF, length);
+        return;
+    }
+    I2C* i2c = _i2c[chip];
+    if (i2c) {
+        // Nothing else may move SDA or SCL while they double as CS
+        i2c->lock();
+    }
+    gpio_write(&_cs[chip], 0);
+    wait_ns(MAX31865_T_CC_NS);
+    _burst(tx, rx, length);
+    wait_ns(MAX31865_T_CCH_NS);
+    gpio_write(&_cs[chip], 1);
+    wait_ns(MAX31865_T_CWH_NS);
+    if (i2c) {
+        i2c->unlock();
+    }
+}
+
+size_t MAX31865_Bus::channel_bytes(void)
+{
+    return sizeof(MAX31865_Bus) / MAX31865_BUS_CHIPS + sizeof(MAX31865_BusTransport);
+}
+
+void MAX31865_Bus::_burst(const uint8_t* tx, uint8_t* rx, int length)
+{
+    for (int n = 0; n < length; ++n) {
+        uint8_t data = tx[n];
+        uint8_t received = 0;
+        for (int i = 7; i >= 0; --i) {
+            gpio_write(&_mosi, (data >> i) & 0x1);
+            gpio_write(&_sclk, 1);
+            received |= gpio_read(&_miso) << i;
+            gpio_write(&_sclk, 0);
+        }
+        rx[n] = received;
+    }
+}
@@ -0,0 +1,128 @@
+/**
+ * @file MAX31865_Bus.h
+ * @brief Bit-banged bus shared by every MAX31865 on a board. SDI, SDO and
+ * SCLK are set up once; each chip is only a chip select, addressed by its
+ * index, so a channel costs one GPIO handle instead of a bus of its own.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note A chip select may double as another function on the board. On the
+ * Nucleo-32, solder bridges SB16 and SB18 tie A4 and A5 to the I2C pins D4
+ * and D5: a push-pull CS there fights the I2C bus. Such a chip is added with
+ * that I2C bus; its CS is then driven open-drain, left to the I2C pull-ups
+ * when high, and only pulled low with the I2C bus held. A pin the console
+ * uses (USBTX, USBRX, A7 shares USBTX) is refused outright.
+ *
+ * A chip costs the GPIO handle of its CS, an I2C pointer and a
+ * MAX31865_BusTransport, see channel_bytes(), where a MAX31865_BitBangTransport
+ * carries four GPIO handles.
+ */
+#pragma once
+#include "mbed.h"
+#include "MAX31865_Transport.h"
+
+#ifndef MAX31865_BUS_CHIPS
+#define MAX31865_BUS_CHIPS  (16)    /* Chips per bus */
+#endif
+
+/* MAX31865 serial interface timing, datasheet minimums */
+#define MAX31865_SCLK_MAX_HZ    (5000000)
+#define MAX31865_T_CC_NS        (400)   /* CS low to first SCLK edge */
+#define MAX31865_T_CCH_NS       (100)   /* Last SCLK edge to CS high */
+#define MAX31865_T_CWH_NS       (400)   /* CS high between bursts */
+#define MAX31865_T_CH_NS        (100)   /* SCLK high */
+#define MAX31865_T_CL_NS        (100)   /* SCLK low */
+#define MAX31865_T_CDH_NS       (35)    /* SDI hold after the latching edge */
+#define MAX31865_T_CDD_NS       (80)    /* SCLK to SDO valid, maximum */
+
+class MAX31865_Bus
+{
+    public:
+        /**
+         * @brief Construct a new bus with no chips on it.
+         *
+         * @param mosi Pin wired to every MAX31865 SDI.
+         * @param miso Pin wired to every MAX31865 SDO.
+         * @param sclk Pin wired to every MAX31865 SCLK.
+         */
+        MAX31865_Bus(PinName mosi, PinName miso, PinName sclk);
+
+        virtual ~MAX31865_Bus() {}
+
+        /**
+         * @brief Add a chip and deselect it.
+         *
+         * @param cs Pin wired to the chip's CS.
+         * @param i2c I2C bus that the pin is tied to on the board, if any.
+         * @return Index of the chip, or -1 if the bus is full or cs is NC,
+         * one of the bus pins, a console pin or already a chip select.
+         */
+        int add(PinName cs, I2C* i2c = nullptr);
+
+        /**
+         * @brief Assert CS of chip, clock length bytes out of tx while
+         * clocking length bytes into rx, then release CS. See
+         * MAX31865_Transport::transfer(). CS is held for the MAX31865
+         * setup, hold and inactive times around the burst. A chip that add()
+         * refused, e.g. (uint8_t)-1, reads 0xFF.
+         */
+        void transfer(uint8_t chip, const uint8_t* tx, uint8_t* rx, int length);
+
+        /**
+         * @brief Chips on the bus.
+         */
+        uint8_t chips(void) const { return _chips; }
+
+        /**
+         * @brief RAM per chip on a full bus: a share of the bus plus a
+         * MAX31865_BusTransport.
+         */
+        static size_t channel_bytes(void);
+
+    protected:
+        /**
+         * @brief Clock a burst with CS already asserted, through the GPIO
+         * HAL: per bit SDI set up, SCLK high, SDO sampled, SCLK low. The HAL
+         * is slow enough to meet every MAX31865 timing on its own.
+         */
+        virtual void _burst(const uint8_t* tx, uint8_t* rx, int length);
+
+    private:
+        gpio_t      _mosi;
+        gpio_t      _miso;
+        gpio_t      _sclk;
+
+        /**
+         * @brief Chip selects, active low, in add() order.
+         */
+        gpio_t      _cs[MAX31865_BUS_CHIPS];
+
+        /**
+         * @brief I2C bus each chip select is tied to, or nullptr.
+         */
+        I2C*        _i2c[MAX31865_BUS_CHIPS];
+
+        uint8_t     _chips;
+};
+
+/**
+ * @brief Transport for one chip on a MAX31865_Bus, for MAX31865_RTD.
+ */
+class MAX31865_BusTransport : public MAX31865_Transport
+{
+    public:
+        /**
+         * @param bus Bus the chip is on.
+         * @param chip Index from MAX31865_Bus::add().
+         */
+        MAX31865_BusTransport(MAX31865_Bus* bus, uint8_t chip) : _bus(bus), _chip(chip) {}
+
+        void transfer(const uint8_t* tx, uint8_t* rx, int length) override
+        {
+            _bus->transfer(_chip, tx, rx, length);
+        }
+
+    private:
+        MAX31865_Bus*   _bus;
+        uint8_t         _chip;
+};
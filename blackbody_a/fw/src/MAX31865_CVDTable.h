@@ -0,0 +1,134 @@
+/**
+ * @file MAX31865_CVDTable.h
+ * @brief Compile-time Callendar-Van Dusen lookup table. Converts a raw 15-bit
+ * MAX31865 RTD code to centi-degrees Celsius with integer arithmetic only.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note Above 0 C the Callendar-Van Dusen equation is the A/B quadratic and is
+ * inverted exactly. Below 0 C the C term is added, and the quadratic solution
+ * is refined with a fixed number of Newton steps, so the cost does not depend
+ * on the reading.
+ *
+ * @note The table holds the temperature in milli-degrees every 2^SHIFT codes,
+ * and the codes in between are linearly interpolated. With SHIFT = 6 that is
+ * 513 entries (about 2 kB of flash) per RTD type. Interpolation adds at most
+ * 0.002 C at the top of the range, so results stay within 0.01 C of the double
+ * precision conversion.
+ */
+#pragma once
+#include <stdint.h>
+
+namespace max31865_cvd {
+
+/** @brief Newton square root, usable in constant expressions. */
+constexpr double sqrt(double x)
+{
+    if (x <= 0.0) return 0.0;
+    double r = x > 1.0 ? x : 1.0;
+    for (int i = 0; i < 100; ++i) {
+        double next = 0.5 * (r + x / r);
+        if (next >= r) break;
+        r = next;
+    }
+    return r;
+}
+
+/** @brief Round to the nearest integer, halves away from zero. */
+constexpr int32_t round(double x)
+{
+    return x >= 0.0 ? (int32_t)(x + 0.5) : -(int32_t)(-x + 0.5);
+}
+
+/** Newton steps for the below 0 C branch. Three reach double precision. */
+#define MAX31865_CVD_NEWTON_STEPS (4)
+
+/**
+ * @brief Refine the quadratic solution t0 with the C term, for
+ * R/R0 = 1 + A t + B t^2 + C (t - 100) t^3. Does nothing at or above 0 C.
+ */
+constexpr double refine(double t0, double ratio, double a, double b, double c)
+{
+    double t = t0;
+    if (t >= 0.0) return t;
+    for (int i = 0; i < MAX31865_CVD_NEWTON_STEPS; ++i) {
+        const double t2 = t * t;
+        const double f  = 1.0 + a * t + b * t2 + c * (t - 100.0) * t2 * t - ratio;
+        const double df = a + 2.0 * b * t + c * (4.0 * t - 300.0) * t2;
+        t -= f / df;
+    }
+    return t;
+}
+
+/**
+ * @brief Temperature in C at resistance ratio R/R0, usable in constant
+ * expressions.
+ */
+constexpr double temperature(double ratio, double a, double b, double c)
+{
+    const double t0 = (-a + sqrt(a * a - 4.0 * b * (1.0 - ratio))) / (2.0 * b);
+    return refine(t0, ratio, a, b, c);
+}
+
+} // namespace max31865_cvd
+
+/**
+ * @brief Callendar-Van Dusen coefficients of an RTD standard.
+ */
+struct MAX31865_CVDCoefficients
+{
+    double a;
+    double b;
+    double c;
+};
+
+/**
+ * @brief Lookup table for an RTD with resistance r0 at 0 C, read against
+ * reference resistor rref.
+ *
+ * @tparam R0 RTD resistance at 0 C, in ohms.
+ * @tparam RREF Reference resistance, in ohms.
+ * @tparam SHIFT log2 of the number of codes per table segment.
+ */
+template <unsigned R0, unsigned RREF, unsigned SHIFT = 6>
+class MAX31865_CVDTable
+{
+    public:
+        static constexpr int SEGMENTS = (1 << 15) >> SHIFT;
+
+        /**
+         * @brief Build the table for the given Callendar-Van Dusen
+         * coefficients.
+         */
+        constexpr MAX31865_CVDTable(const MAX31865_CVDCoefficients& cvd) : _milli()
+        {
+            for (int i = 0; i <= SEGMENTS; ++i) {
+                double ratio = (double)(i << SHIFT) * RREF / (1 << 15) / R0;
+                double t = max31865_cvd::temperature(ratio, cvd.a, cvd.b, cvd.c);
+                _milli[i] = max31865_cvd::round(1000.0 * t);
+            }
+        }
+
+        /**
+         * @brief Convert a raw RTD code (fault bit already removed).
+         *
+         * @param raw 15-bit ADC code.
+         * @return Temperature in hundredths of a degree Celsius.
+         */
+        int32_t centi_degrees(uint16_t raw) const
+        {
+            raw &= 0x7fff;
+            const uint32_t idx = raw >> SHIFT;
+            const int32_t frac = raw & ((1u << SHIFT) - 1);
+            const int32_t span = _milli[idx + 1] - _milli[idx];
+            const int32_t milli = _milli[idx] + ((span * frac + (1 << (SHIFT - 1))) >> SHIFT);
+            return milli >= 0 ? (milli + 5) / 10 : -((5 - milli) / 10);
+        }
+
+    private:
+        /**
+         * @brief Temperature in milli-degrees at codes 0, 2^SHIFT,
+         * 2 * 2^SHIFT, ... 2^15.
+         */
+        int32_t _milli[SEGMENTS + 1];
+};
@@ -0,0 +1,102 @@
+/**
+ * @file MAX31865_FastBus.h
+ * @brief MAX31865_Bus that clocks its bursts through the GPIO port registers
+ * instead of the HAL: one BSRR store per edge, one IDR load per bit, with the
+ * pins fixed at compile time, and SCLK paced to a chosen frequency.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note Each half of a clock period is a wait_ns() of half the period less
+ * the port accesses in it, MAX31865_FAST_EDGE_NS each. wait_ns() is
+ * calibrated against the core clock by mbed and only errs long, so SCLK runs
+ * at SCLK_HZ or a little under. The waits never go below what the MAX31865
+ * needs for SDI hold and SDO valid, whatever the frequency. Chip selects
+ * still go through the HAL, once per burst.
+ *
+ * BSRR stores are atomic, so an interrupt that drives another pin of the
+ * same port between two edges cannot be undone by the bus.
+ */
+#pragma once
+#include "MAX31865_Bus.h"
+
+#ifndef MAX31865_FAST_SCLK_HZ
+#define MAX31865_FAST_SCLK_HZ   (4000000)   /* Default SCLK */
+#endif
+
+#ifndef MAX31865_FAST_EDGE_NS
+#define MAX31865_FAST_EDGE_NS   (25)        /* One port access at 80 MHz, ns */
+#endif
+
+/**
+ * @brief Shared MAX31865 bus on fixed pins.
+ *
+ * @tparam MOSI Pin wired to every MAX31865 SDI.
+ * @tparam MISO Pin wired to every MAX31865 SDO.
+ * @tparam SCLK Pin wired to every MAX31865 SCLK.
+ * @tparam SCLK_HZ Clock frequency, MAX31865_SCLK_MAX_HZ at most.
+ */
+template <PinName MOSI, PinName MISO, PinName SCLK, uint32_t SCLK_HZ = MAX31865_FAST_SCLK_HZ>
+class MAX31865_FastBus : public MAX31865_Bus
+{
+    static_assert(SCLK_HZ > 0 && SCLK_HZ <= MAX31865_SCLK_MAX_HZ, "MAX31865 SCLK is 5 MHz at most");
+    static_assert(STM_PORT(MOSI) <= 2 && STM_PORT(MISO) <= 2 && STM_PORT(SCLK) <= 2,
+                  "Bus pins must be on port A, B or C");
+
+    public:
+        /**
+         * @brief Construct a new bus with no chips on it.
+         */
+        MAX31865_FastBus(void) : MAX31865_Bus(MOSI, MISO, SCLK) {}
+
+    protected:
+        void _burst(const uint8_t* tx, uint8_t* rx, int length) override
+        {
+            GPIO_TypeDef* mosi = _port(MOSI);
+            GPIO_TypeDef* miso = _port(MISO);
+            GPIO_TypeDef* sclk = _port(SCLK);
+            for (int n = 0; n < length; ++n) {
+                uint8_t data = tx[n];
+                uint8_t received = 0;
+                for (int i = 7; i >= 0; --i) {
+                    mosi->BSRR = (data >> i) & 0x1 ? _mask(MOSI) : _mask(MOSI) << 16;
+                    _wait(SETUP_NS);
+                    sclk->BSRR = _mask(SCLK);
+                    _wait(HIGH_NS);
+                    received |= ((miso->IDR >> STM_PIN(MISO)) & 0x1) << i;
+                    sclk->BSRR = _mask(SCLK) << 16;
+                    _wait(HOLD_NS);
+                }
+                rx[n] = received;
+            }
+        }
+
+    private:
+        static constexpr int32_t HALF_NS = 1000000000 / (2 * SCLK_HZ);
+
+        /* SCLK high: rising edge, wait, SDO load, falling edge */
+        static constexpr int32_t HIGH_NS = HALF_NS - 2 * MAX31865_FAST_EDGE_NS > MAX31865_T_CDD_NS - MAX31865_FAST_EDGE_NS
+            ? HALF_NS - 2 * MAX31865_FAST_EDGE_NS : MAX31865_T_CDD_NS - MAX31865_FAST_EDGE_NS;
+
+        /* SCLK low: falling edge, hold, SDI store, setup, rising edge */
+        static constexpr int32_t HOLD_NS = MAX31865_T_CDH_NS > MAX31865_FAST_EDGE_NS
+            ? MAX31865_T_CDH_NS - MAX31865_FAST_EDGE_NS : 0;
+        static constexpr int32_t SETUP_NS = HALF_NS - 2 * MAX31865_FAST_EDGE_NS - HOLD_NS > 0
+            ? HALF_NS - 2 * MAX31865_FAST_EDGE_NS - HOLD_NS : 0;
+
+        static GPIO_TypeDef* _port(PinName pin)
+        {
+            return STM_PORT(pin) == 0 ? GPIOA : STM_PORT(pin) == 1 ? GPIOB : GPIOC;
+        }
+
+        static uint32_t _mask(PinName pin)
+        {
+            return 1UL << STM_PIN(pin);
+        }
+
+        static void _wait(int32_t ns)
+        {
+            if (ns > 0) {
+                wait_ns(ns);
+            }
+        }
+};
@@ -0,0 +1,50 @@
+/**
+ * @file MAX31865_SPITransport.cpp
+ * @brief Hardware SPI transport for the MAX31865 driver.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#include "MAX31865_SPITransport.h"
+
+MAX31865_SPITransport::MAX31865_SPITransport(SPI* spi, PinName cs, int frequency)
+    : _spi(spi), _cs(cs, 1), _done(0)
+{
+    _spi->format(8, MAX31865_SPI_MODE);
+    _spi->frequency(frequency);
+#if DEVICE_SPI_ASYNCH
+    _spi->set_dma_usage(DMA_USAGE_ALWAYS);
+#endif
+}
+
+void MAX31865_SPITransport::transfer(const uint8_t* tx, uint8_t* rx, int length)
+{
+    _spi->lock();
+
+    // When another SPI object last used the peripheral, mbed reclaims and
+    // reinitializes it on the first transfer, after CS has already gone low.
+    // SCLK drops to the mode 0 idle level while that happens, and the
+    // MAX31865 counts it as an extra clock. format() performs the same
+    // reclaim, so doing it here with CS still high parks SCLK at the mode 3
+    // idle level before the chip is listening.
+    // See https://stackoverflow.com/questions/71366463/spi-extra-clock-cycle-over-communication-between-stm32-nucleo-l432kc-and-max3186
+    _spi->format(8, MAX31865_SPI_MODE);
+
+    _cs = 0;
+#if DEVICE_SPI_ASYNCH
+    _spi->transfer(tx, length, rx, length,
+                   callback(this, &MAX31865_SPITransport::_complete),
+                   SPI_EVENT_COMPLETE);
+    _done.acquire();
+#else
+    _spi->write((const char*)tx, length, (char*)rx, length);
+#endif
+    _cs = 1;
+
+    _spi->unlock();
+}
+
+void MAX31865_SPITransport::_complete(int event)
+{
+    (void)event;
+    _done.release();
+}
@@ -0,0 +1,56 @@
+/**
+ * @file MAX31865_SPITransport.h
+ * @brief Hardware SPI transport for the MAX31865 driver. Each register burst
+ * is a single DMA transfer.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note The MAX31865 only supports SPI modes 1 and 3 (CPHA = 1), and SCLK up to
+ * 5 MHz. Mode 3 is used so that SCLK idles high between bursts.
+ *
+ * @note Hardware SPI needs SDI on an SPIx_MOSI pin and SDO on an SPIx_MISO pin
+ * (PB_5/D11 and PB_4/D12 for SPI1 on the L432KC). Blackbody A v0.2.0 routes
+ * them the other way around; use MAX31865_BitBangTransport on that board.
+ */
+#pragma once
+#include "mbed.h"
+#include "MAX31865_Transport.h"
+
+#define MAX31865_SPI_MODE       (3)
+#define MAX31865_SPI_FREQUENCY  (4000000) /* Hz */
+
+class MAX31865_SPITransport : public MAX31865_Transport
+{
+    public:
+        /**
+         * @brief Construct a new hardware SPI transport.
+         *
+         * @param spi SPI bus shared by every MAX31865 on the board.
+         * @param cs Pin wired to this MAX31865's CS.
+         * @param frequency SCLK frequency in Hz. Default MAX31865_SPI_FREQUENCY.
+         */
+        MAX31865_SPITransport(SPI* spi, PinName cs, int frequency = MAX31865_SPI_FREQUENCY);
+
+        void transfer(const uint8_t* tx, uint8_t* rx, int length) override;
+
+    private:
+        /**
+         * @brief DMA completion callback, runs in interrupt context.
+         */
+        void _complete(int event);
+
+        /**
+         * @brief Reference to the SPI bus object.
+         */
+        SPI*        _spi;
+
+        /**
+         * @brief Chip select, active low.
+         */
+        DigitalOut  _cs;
+
+        /**
+         * @brief Released by _complete when the burst has finished.
+         */
+        Semaphore   _done;
+};
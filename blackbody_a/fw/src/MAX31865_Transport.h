@@ -0,0 +1,68 @@
+/**
+ * @file MAX31865_Transport.h
+ * @brief Bus transports for the MAX31865 driver. A transport moves one
+ * register burst per call, with chip select asserted for the whole burst, so
+ * that MAX31865_RTD does not need to know whether the bus is bit-banged,
+ * hardware SPI, or a host mock.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#pragma once
+#include <stdint.h>
+#include "mbed.h"
+#include "BitBang.cpp"
+
+/**
+ * @brief Interface for a MAX31865 register burst.
+ */
+class MAX31865_Transport
+{
+    public:
+        virtual ~MAX31865_Transport() {}
+
+        /**
+         * @brief Assert CS, clock length bytes out of tx while clocking length
+         * bytes into rx, then release CS. tx[0] is the register address, with
+         * bit 7 set for a write.
+         *
+         * @param tx Bytes to send.
+         * @param rx Bytes received. May alias tx.
+         * @param length Number of bytes in the burst, address included.
+         */
+        virtual void transfer(const uint8_t* tx, uint8_t* rx, int length) = 0;
+};
+
+/**
+ * @brief Bit-banged transport over four GPIOs. Works on any pins, which is what
+ * Blackbody A v0.2.0 needs: SDI and SDO are routed to PB_4 and PB_5, the
+ * opposite way around from the SPI1/SPI3 alternate functions.
+ */
+class MAX31865_BitBangTransport : public MAX31865_Transport
+{
+    public:
+        /**
+         * @brief Construct a new bit-banged transport.
+         *
+         * @param mosi Pin wired to the MAX31865 SDI.
+         * @param miso Pin wired to the MAX31865 SDO.
+         * @param sclk Pin wired to the MAX31865 SCLK.
+         * @param cs Pin wired to the MAX31865 CS.
+         */
+        MAX31865_BitBangTransport(PinName mosi, PinName miso, PinName sclk, PinName cs)
+            : _spi(mosi, miso, sclk, cs)
+        {
+            _spi.deselect();
+        }
+
+        void transfer(const uint8_t* tx, uint8_t* rx, int length) override
+        {
+            _spi.select();
+            for (int i = 0; i < length; ++i) {
+                rx[i] = _spi.write(tx[i]);
+            }
+            _spi.deselect();
+        }
+
+    private:
+        BitBangSPI _spi;
+};
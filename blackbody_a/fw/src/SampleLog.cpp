@@ -0,0 +1,95 @@
+/**
+ * @file SampleLog.cpp
+ * @brief RAM ring of recent samples, dumped over CAN on request.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#include "SampleLog.h"
+
+SampleLog::SampleLog(CanTxQueue* tx, const TimeSync* time)
+    : _tx(tx), _time(time), _count(0), _dumping(false), _from_ms(0), _to_ms(0), _next(0), _end(0),
+      _sent(0), _lost(0)
+{
+}
+
+void SampleLog::add(uint8_t channel, int32_t value, uint64_t local_us)
+{
+    record& r = _ring[_count % SAMPLE_LOG_DEPTH];
+    r.time_ms = (uint32_t)(_time->to_master(local_us) / 1000);
+    r.channel = channel;
+    r.flags = _time->locked() ? SAMPLE_LOG_LOCKED : 0;
+    if (value > INT16_MAX || value < INT16_MIN) {
+        r.flags |= SAMPLE_LOG_CLIPPED;
+        value = value > INT16_MAX ? INT16_MAX : INT16_MIN;
+    }
+    r.value = value;
+    ++_count;
+}
+
+void SampleLog::start_dump(uint32_t from_ms, uint32_t to_ms)
+{
+    _dumping = true;
+    _from_ms = from_ms;
+    _to_ms = to_ms;
+    _next = _count - size();
+    _end = _count;
+    _sent = 0;
+    _lost = 0;
+}
+
+void SampleLog::cancel_dump(void)
+{
+    if (_dumping) {
+        _finish();
+    }
+}
+
+void SampleLog::pump(void)
+{
+    if (!_dumping) {
+        return;
+    }
+    // Records overwritten before the dump got to them are gone, whether in
+    // the range or not
+    uint32_t oldest = _count - size();
+    if (_next < oldest) {
+        uint32_t gone = (oldest < _end ? oldest : _end) - _next;
+        uint32_t lost = _lost + gone;
+        _lost = lost < 0xFFFF ? lost : 0xFFFF;
+        _next += gone;
+    }
+    for (uint16_t scanned = 0; scanned < SAMPLE_LOG_SCAN && _next != _end; ++scanned) {
+        if (_tx->pending(CanTxQueue::PRIORITY_BULK) >= CAN_TX_DEPTH - SAMPLE_LOG_HEADROOM) {
+            return;
+        }
+        const record& r = _ring[_next % SAMPLE_LOG_DEPTH];
+        ++_next;
+        // Unsigned differences, so a range across the 49 day wrap works
+        if ((uint32_t)(r.time_ms - _from_ms) >= (uint32_t)(_to_ms - _from_ms)) {
+            continue;
+        }
+        if (!_tx->write(CANMessage(CAN_LOG_DUMP, (const uint8_t*)&r, 8), CanTxQueue::PRIORITY_BULK)) {
+            --_next;
+            return;
+        }
+        ++_sent;
+    }
+    if (_next == _end) {
+        _finish();
+    }
+}
+
+void SampleLog::_finish(void)
+{
+    _dumping = false;
+    struct __attribute__((packed)) data {
+        uint16_t sent;
+        uint16_t lost;
+        uint32_t oldest_ms;
+    } data = {
+        .sent = _sent,
+        .lost = _lost,
+        .oldest_ms = size() > 0 ? _ring[(_count - size()) % SAMPLE_LOG_DEPTH].time_ms : 0
+    };
+    _tx->write(CANMessage(CAN_LOG_DUMP_END, (uint8_t*)&data, 8), CanTxQueue::PRIORITY_BULK);
+}
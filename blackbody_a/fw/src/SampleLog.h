@@ -0,0 +1,123 @@
+/**
+ * @file SampleLog.h
+ * @brief RAM ring of the most recent samples of every channel, in 8 byte
+ * fixed point records, so that samples the bus had no room for, or that a
+ * controller missed while it rebooted, can be read back later with a dump.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note Record and CAN_LOG_DUMP frame layout, 8 bytes:
+ * - [0..3] uint32 time on the common time base, ms, see TimeSync.h; wraps
+ *          after 49 days
+ * - [4..5] int16 value: RTDs in 0.01 C, irradiance in 0.1 W/m^2
+ * - [6]    channel: bit 7 set for irradiance, bits 6:0 the sensor index
+ * - [7]    flags, SAMPLE_LOG_LOCKED and SAMPLE_LOG_CLIPPED
+ *
+ * @note Dump protocol:
+ * - CAN_LOG_DUMP_REQ [0..3] from, [4..7] to, uint32 ms: dump every record
+ *   in the ring with from <= time < to, oldest first. Replaces a dump in
+ *   progress. Without data, cancels it.
+ * - CAN_LOG_DUMP, one per record, at PRIORITY_BULK and never more than the
+ *   bulk ring has room for, so live traffic always goes first.
+ * - CAN_LOG_DUMP_END [0..1] records sent, [2..3] records overwritten before
+ *   the dump got to them, in the range or not, uint16, [4..7] time of the
+ *   oldest record still in the ring, uint32 ms. Ends every dump, cancelled
+ *   or not.
+ *
+ * Records are kept in the order samples were taken, not sorted by time; a
+ * dump scans the whole ring as it stood at the request.
+ */
+#pragma once
+#include "mbed.h"
+#include "CanTxQueue.h"
+#include "TimeSync.h"
+
+#define CAN_LOG_DUMP_REQ    0x638
+#define CAN_LOG_DUMP        0x639
+#define CAN_LOG_DUMP_END    0x63A
+
+#ifndef SAMPLE_LOG_DEPTH
+#define SAMPLE_LOG_DEPTH    (2048)  /* Records, a power of 2; 8 bytes each */
+#endif
+#define SAMPLE_LOG_HEADROOM (2)     /* Bulk ring slots left for others */
+#define SAMPLE_LOG_SCAN     (256)   /* Most records looked at per pump() */
+
+#define SAMPLE_LOG_IRRAD    (0x80)  /* Channel bit of irradiance sensors */
+#define SAMPLE_LOG_LOCKED   (0x01)  /* Time is on the master's clock */
+#define SAMPLE_LOG_CLIPPED  (0x02)  /* Value saturated to fit an int16 */
+
+class SampleLog
+{
+    public:
+        struct __attribute__((packed)) record {
+            uint32_t    time_ms;
+            int16_t     value;
+            uint8_t     channel;
+            uint8_t     flags;
+        };
+
+        /**
+         * @brief Construct a new, empty log that stamps records with time
+         * and dumps through tx.
+         */
+        SampleLog(CanTxQueue* tx, const TimeSync* time);
+
+        /**
+         * @brief Add a sample, overwriting the oldest once full.
+         *
+         * @param channel Sensor index, | SAMPLE_LOG_IRRAD for irradiance.
+         * @param value In the unit of the channel; saturates to int16.
+         * @param local_us Local time the sample was taken, see
+         * TimeSync::local_us().
+         */
+        void add(uint8_t channel, int32_t value, uint64_t local_us);
+
+        /**
+         * @brief Start dumping the records in [from_ms, to_ms). Frames go
+         * out from pump().
+         */
+        void start_dump(uint32_t from_ms, uint32_t to_ms);
+
+        /**
+         * @brief Stop the dump in progress, if any, and send its
+         * CAN_LOG_DUMP_END.
+         */
+        void cancel_dump(void);
+
+        /**
+         * @brief Top up the bulk ring with the next records of the dump.
+         * Call often enough to keep it busy, e.g. at 10 Hz.
+         */
+        void pump(void);
+
+        bool dumping(void) const { return _dumping; }
+
+        /**
+         * @brief Records in the ring.
+         */
+        uint32_t size(void) const { return _count < SAMPLE_LOG_DEPTH ? _count : SAMPLE_LOG_DEPTH; }
+
+    private:
+        /**
+         * @brief Send CAN_LOG_DUMP_END and go idle.
+         */
+        void _finish(void);
+
+        CanTxQueue*     _tx;
+        const TimeSync* _time;
+
+        /**
+         * @brief Records ever added; record n sits at n % SAMPLE_LOG_DEPTH
+         * while n + SAMPLE_LOG_DEPTH > _count.
+         */
+        record          _ring[SAMPLE_LOG_DEPTH];
+        uint32_t        _count;
+
+        bool            _dumping;
+        uint32_t        _from_ms;
+        uint32_t        _to_ms;
+        uint32_t        _next;  /* Next record to look at */
+        uint32_t        _end;   /* _count at the request */
+        uint16_t        _sent;
+        uint16_t        _lost;
+};
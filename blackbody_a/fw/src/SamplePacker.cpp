@@ -0,0 +1,63 @@
+/**
+ * @file SamplePacker.cpp
+ * @brief Packs up to three int16 samples into one CAN frame.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#include "SamplePacker.h"
+
+SamplePacker::SamplePacker(CanTxQueue* tx, uint32_t id, const TimeSync* time)
+    : _tx(tx), _id(id), _time(time), _bitmap(0), _count(0), _bank(0), _first_us(0),
+      _last_channel(-1), _sequence(0)
+{
+}
+
+bool SamplePacker::add(uint8_t channel, int16_t value, uint64_t local_us)
+{
+    if (channel > PACKED_MAX_CHANNEL) {
+        return false;
+    }
+    if (channel <= _last_channel || (_count > 0 && channel / 8 != _bank)) {
+        flush();
+    }
+    _bank = channel / 8;
+    if (_count == 0) {
+        _first_us = local_us;
+    }
+    _bitmap |= 1 << (channel % 8);
+    _values[_count++] = value;
+    _last_channel = channel;
+    if (_count == PACKED_SAMPLES_PER_FRAME) {
+        flush();
+    }
+    return true;
+}
+
+void SamplePacker::flush(void)
+{
+    if (_count == 0) {
+        return;
+    }
+    uint8_t data[8] = {0};
+    data[0] = _bitmap;
+    for (uint8_t i = 0; i < _count; ++i) {
+        data[1 + 2 * i] = (uint16_t)_values[i] & 0xFF;
+        data[2 + 2 * i] = (uint16_t)_values[i] >> 8;
+    }
+    data[7] = _bank << 5 | _sequence;
+    _tx->write(CANMessage(_id, data, 8));
+    if (_time != nullptr) {
+        _tx->write(_time->sample_time(_id, data[7], _first_us));
+    }
+    _bitmap = 0;
+    _count = 0;
+}
+
+void SamplePacker::next_round(void)
+{
+    flush();
+    if (_last_channel >= 0) {
+        _sequence = (_sequence + 1) & 0x1F;
+        _last_channel = -1;
+    }
+}
@@ -0,0 +1,91 @@
+/**
+ * @file SamplePacker.h
+ * @brief Packs up to three int16 samples of different channels into one CAN
+ * frame, instead of one frame per sample, so a round of eight channels takes
+ * three frames.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note Frame layout, 8 bytes:
+ * - [0]    bitmap of the channels in the frame, bit n for channel
+ *          8 * bank + n
+ * - [1..6] one little endian int16 per set bit, in ascending channel order;
+ *          unused values are 0
+ * - [7]    bank in bits 7:5, round sequence (mod 32) in bits 4:0
+ *
+ * Frames of one round share a sequence number, so a receiver can put a
+ * snapshot back together. The caller ends each round with next_round(): with
+ * report-on-change a round may hold any subset of the channels, so rounds
+ * cannot be told apart by channel order. A channel missing from every frame
+ * of a round had no valid sample, or nothing new to report, see
+ * ChangeReporter.h.
+ *
+ * Eight banks of eight give channels 0 to PACKED_MAX_CHANNEL.
+ *
+ * Given a TimeSync, each frame is followed by a CAN_SAMPLE_TIME with the time
+ * of its first sample; the others in it were taken later in the same round.
+ */
+#pragma once
+#include "mbed.h"
+#include "CanTxQueue.h"
+#include "TimeSync.h"
+
+#define PACKED_SAMPLES_PER_FRAME    (3)
+#define PACKED_MAX_CHANNEL          (63)
+
+class SamplePacker
+{
+    public:
+        /**
+         * @brief Construct a new packer sending on id through tx, and
+         * stamping its frames with time if given.
+         */
+        SamplePacker(CanTxQueue* tx, uint32_t id, const TimeSync* time = nullptr);
+
+        /**
+         * @brief Add a sample to the current round. Channels of a round must
+         * come in ascending order; one at or below the last starts a new
+         * frame, still in the same round. The frame goes out once it is full
+         * or the round moves to another bank.
+         *
+         * @param channel 0 to PACKED_MAX_CHANNEL.
+         * @param value Sample, in the unit of the frame id.
+         * @param local_us Local time the sample was taken, see
+         * TimeSync::local_us().
+         * @return false If channel is out of range; the sample is dropped.
+         */
+        bool add(uint8_t channel, int16_t value, uint64_t local_us = 0);
+
+        /**
+         * @brief Send what is waiting.
+         */
+        void flush(void);
+
+        /**
+         * @brief End the round: send what is waiting and, if the round had
+         * any sample, move the sequence number on for the next.
+         */
+        void next_round(void);
+
+        /**
+         * @brief Sequence number of the current round.
+         */
+        uint8_t sequence(void) const { return _sequence; }
+
+    private:
+        CanTxQueue*     _tx;
+        uint32_t        _id;
+        const TimeSync* _time;
+
+        uint8_t         _bitmap;
+        uint8_t         _count;
+        uint8_t         _bank;
+        int16_t         _values[PACKED_SAMPLES_PER_FRAME];
+        uint64_t        _first_us;
+
+        /**
+         * @brief Last channel added this round, -1 before the first.
+         */
+        int16_t         _last_channel;
+        uint8_t         _sequence;
+};
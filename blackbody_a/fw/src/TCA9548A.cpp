@@ -0,0 +1,41 @@
+/**
+ * @file TCA9548A.cpp
+ * @brief Driver for the TCA9548A 1-to-8 I2C switch.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#include "TCA9548A.h"
+
+TCA9548A::TCA9548A(I2C* i2c, uint8_t addr)
+    : _i2c(i2c), _addr(addr << 1), _control(-1)
+{
+}
+
+int TCA9548A::select(uint8_t channel)
+{
+    if (channel >= TCA9548A_CHANNELS) {
+        return -1;
+    }
+    uint8_t control = 1 << channel;
+    if (_control == control) {
+        return 0;
+    }
+    return _write(control);
+}
+
+int TCA9548A::disable(void)
+{
+    return _write(0x00);
+}
+
+int TCA9548A::_write(uint8_t control)
+{
+    char write = (char)control;
+    if (_i2c->write(_addr, &write, 1) != 0) {
+        // Unknown state, write it again next time
+        _control = -1;
+        return -1;
+    }
+    _control = control;
+    return 0;
+}
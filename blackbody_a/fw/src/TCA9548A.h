@@ -0,0 +1,77 @@
+/**
+ * @file TCA9548A.h
+ * @brief Driver for the TCA9548A 1-to-8 I2C switch. Lets devices that share
+ * an address, like the TSL2591s on each Blackbody C, sit on one I2C bus.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note The switch has a single control register: bit n connects downstream
+ * channel n. Only one channel is connected at a time here, so a transaction
+ * never reaches two devices at the same address.
+ */
+#pragma once
+#include "mbed.h"
+
+#define TCA9548A_ADDR       (0x70) /* A2:A0 tied low */
+#define TCA9548A_CHANNELS   (8)
+
+class TCA9548A
+{
+    public:
+        /**
+         * @brief Construct a new TCA9548A.
+         *
+         * @param i2c Upstream I2C bus.
+         * @param addr 7-bit address of the switch. Default TCA9548A_ADDR.
+         */
+        TCA9548A(I2C* i2c, uint8_t addr = TCA9548A_ADDR);
+
+        /**
+         * @brief Connect channel and disconnect every other one. The control
+         * register is only written when the selection changes, so back to
+         * back transactions on one channel cost nothing extra.
+         *
+         * @return 0 on success, nonzero if the switch did not acknowledge.
+         */
+        int select(uint8_t channel);
+
+        /**
+         * @brief Disconnect every channel.
+         *
+         * @return 0 on success, nonzero if the switch did not acknowledge.
+         */
+        int disable(void);
+
+        /**
+         * @brief Hold the upstream bus across a select and the transaction
+         * that follows it.
+         */
+        void lock(void) { _i2c->lock(); }
+        void unlock(void) { _i2c->unlock(); }
+
+        /**
+         * @brief Upstream I2C bus.
+         */
+        I2C* i2c(void) const { return _i2c; }
+
+    private:
+        /**
+         * @brief Write the control register.
+         */
+        int _write(uint8_t control);
+
+        /**
+         * @brief Reference to the upstream I2C bus.
+         */
+        I2C*        _i2c;
+
+        /**
+         * @brief 8-bit (shifted) address of the switch.
+         */
+        int         _addr;
+
+        /**
+         * @brief Last control register value written, or -1 if unknown.
+         */
+        int         _control;
+};
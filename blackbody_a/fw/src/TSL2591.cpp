@@ -1,8 +1,33 @@
 #include "TSL2591.hpp"
 
-TSL2591::TSL2591 (I2C * tsl2591_i2c, uint8_t tsl2591_addr):
-    _i2c(tsl2591_i2c), _addr(tsl2591_addr<<1)
+static const float tsl2591GainScale[] = {1.0F, 25.0F, 428.0F, 9876.0F};
+
+/*
+ *  Full scale counts: 100 ms integrations stop at 37888
+ */
+static uint16_t tsl2591MaxCounts(uint8_t integ)
 {
+    return integ == TSL2591_INTT_100MS ? 37888 : 65535;
+}
+
+TSL2591::TSL2591 (I2C * tsl2591_i2c, uint8_t tsl2591_addr, InterruptIn * tsl2591_int):
+    TSL2591(new TSL2591_I2CBus(tsl2591_i2c, tsl2591_addr), tsl2591_int)
+{
+}
+/*
+ *  Construct on an existing bus, e.g. a mux channel
+ *  The bus must outlive the object
+ */
+TSL2591::TSL2591 (TSL2591_Bus * tsl2591_bus, InterruptIn * tsl2591_int):
+    _bus(tsl2591_bus), _int(tsl2591_int)
+{
+    ready = false;
+    _busy = false;
+    _continuous = false;
+    _autoRange = false;
+    saturated = false;
+    fullRate = 0.0F;
+    irRate = 0.0F;
     _init = false;
     _integ = TSL2591_INTT_100MS;
     _gain = TSL2591_GAIN_LOW;
@@ -13,10 +38,8 @@ TSL2591::TSL2591 (I2C * tsl2591_i2c, uint8_t tsl2591_addr):
  */
 bool TSL2591::init(void)
 {
-    char write[] = {(TSL2591_CMD_BIT|TSL2591_REG_ID)};
-    if(_i2c->write(_addr, write, 1, 0) == 0) {
-        char read[1];
-        _i2c->read(_addr, read, 1, 0);
+    char read[1];
+    if(_bus->read(TSL2591_CMD_BIT|TSL2591_REG_ID, read, 1) == 0) {
         if(read[0] == TSL2591_ID) {
             _init = true;
             setGain(TSL2591_GAIN_LOW);
@@ -33,7 +56,7 @@ bool TSL2591::init(void)
 void TSL2591::enable(void)
 {
     char write[] = {(TSL2591_CMD_BIT|TSL2591_REG_ENABLE), (TSL2591_EN_PON|TSL2591_EN_AEN|TSL2591_EN_AIEN|TSL2591_EN_NPIEN)};
-    _i2c->write(_addr, write, 2, 0);
+    _bus->write(write, 2);
 }
 /*
  *  Power Off TSL2591
@@ -41,7 +64,7 @@ void TSL2591::enable(void)
 void TSL2591::disable(void)
 {
     char write[] = {(TSL2591_CMD_BIT|TSL2591_REG_ENABLE), (TSL2591_EN_POFF)};
-    _i2c->write(_addr, write, 2, 0);
+    _bus->write(write, 2);
 }
 /*
  *  Set Gain and Write
@@ -49,11 +72,8 @@ void TSL2591::disable(void)
  */
 void TSL2591::setGain(tsl2591Gain_t gain)
 {
-    enable();
     _gain = gain;
-    char write[] = {(TSL2591_CMD_BIT|TSL2591_REG_CONTROL), static_cast<char>((_integ|_gain))};
-    _i2c->write(_addr, write, 2, 0);
-    disable();
+    writeControl();
 }
 /*
  *  Set Integration Time and Write
@@ -61,11 +81,93 @@ void TSL2591::setGain(tsl2591Gain_t gain)
  */
 void TSL2591::setTime(tsl2591IntegrationTime_t integ)
 {
-    enable();
     _integ = integ;
+    writeControl();
+}
+/*
+ *  Enable Auto Range
+ *  Step gain and integration time after every reading, see autoRange
+ */
+void TSL2591::setAutoRange(bool enable)
+{
+    _autoRange = enable;
+}
+/*
+ *  Auto Range
+ *  Pick the next gain and integration time from the last counts: the
+ *  shortest integration that still collects TSL2591_AUTO_MIN_COUNTS without
+ *  passing TSL2591_AUTO_HEADROOM of full scale, at the highest gain that
+ *  fits. A saturated reading only bounds the light from below, so step one
+ *  gain down (then to 100 ms) and look again.
+ */
+void TSL2591::autoRange(void)
+{
+    uint8_t gain = _gain >> 4;
+    uint8_t integ = _integ;
+    if(saturated) {
+        if(gain > 0) {
+            gain--;
+        } else {
+            integ = TSL2591_INTT_100MS;
+        }
+    } else {
+        uint16_t peak = full > ir ? full : ir;
+        float sensitivity = tsl2591GainScale[gain] * (integ + 1) * 100;
+        float rate = peak / sensitivity;
+        bool found = false;
+        for(uint8_t t = TSL2591_INTT_100MS; t <= TSL2591_INTT_600MS && !found; t++) {
+            for(int8_t g = 3; g >= 0; g--) {
+                float candidate = tsl2591GainScale[g] * (t + 1) * 100;
+                float predicted = rate * candidate;
+                // Leave the current setting only with some margin
+                float headroom = TSL2591_AUTO_HEADROOM * tsl2591MaxCounts(t);
+                if(candidate > sensitivity) {
+                    headroom /= TSL2591_AUTO_HYSTERESIS;
+                }
+                if(predicted > headroom) {
+                    continue;
+                }
+                float needed = TSL2591_AUTO_MIN_COUNTS;
+                if(t < integ) {
+                    needed *= TSL2591_AUTO_HYSTERESIS;
+                }
+                if(predicted >= needed || t == TSL2591_INTT_600MS) {
+                    gain = g;
+                    integ = t;
+                    found = true;
+                }
+                break;
+            }
+        }
+    }
+    if(gain != (_gain >> 4) || integ != _integ) {
+        _gain = (tsl2591Gain_t)(gain << 4);
+        _integ = (tsl2591IntegrationTime_t)integ;
+        writeControl();
+    }
+}
+/*
+ *  Write time and gain
+ *  Registers are writable with the ALS off, so no power cycle. While
+ *  streaming, AEN is cleared around the write: the datasheet does not say
+ *  that a CONTROL write restarts the integration in flight, so that result
+ *  could mix both settings. Setting AEN again starts a clean integration,
+ *  and a result already latched from the old setting is dropped.
+ */
+void TSL2591::writeControl(void)
+{
     char write[] = {(TSL2591_CMD_BIT|TSL2591_REG_CONTROL), static_cast<char>((_integ|_gain))};
-    _i2c->write(_addr, write, 2, 0);
-    disable();
+    if(!_continuous) {
+        _bus->write(write, 2);
+        return;
+    }
+    char pause[] = {(TSL2591_CMD_BIT|TSL2591_REG_ENABLE), (TSL2591_EN_PON|TSL2591_EN_AIEN|TSL2591_EN_NPIEN)};
+    _bus->write(pause, 2);
+    _bus->write(write, 2);
+    clearInterrupt();
+    enable();
+    ready = false;
+    armTimeout();
 }
 /*
  *  Read ALS
@@ -73,83 +175,204 @@ void TSL2591::setTime(tsl2591IntegrationTime_t integ)
  */
 void TSL2591::getALS(void)
 {
+    if(_continuous) {
+        // Already integrating, wait for the next result
+        while(!readALS()) {
+            ThisThread::sleep_for(10ms);
+        }
+        return;
+    }
     enable();
     for(uint8_t t=0; t<=_integ+1; t++) {
         ThisThread::sleep_for(100ms);
     }
-
-    // Channel 1
-    char write1[] = {(TSL2591_CMD_BIT|TSL2591_REG_CHAN1_L)};
-    _i2c->write(_addr, write1, 1, 0);
-    char read1[2];
-    _i2c->read(_addr, read1, 2, 0);
-
-    // Channel 0
-    char write2[] = {(TSL2591_CMD_BIT|TSL2591_REG_CHAN0_L)};
-    _i2c->write(_addr, write2, 1, 0);
-    char read2[2];
-    _i2c->read(_addr, read2, 2, 0);
-
-    // Channel 1 is 0xFFFF0000, Channel 0 is 0xFFFF
-    rawALS = (((read1[1]<<8)|read1[0])<<16)|((read2[1]<<8)|read2[0]);
+    readChannels();
     disable();
+    if(_autoRange) {
+        autoRange();
+    }
+}
+/*
+ *  Start ALS
+ *  Power on and return without waiting for the integration. ready is set,
+ *  and the callback (if any) runs in interrupt context, once the result can
+ *  be read: on the INT falling edge if the pin is wired, otherwise after the
+ *  integration time. Then call readALS from thread context.
+ */
+void TSL2591::startALS(Callback<void()> ready_cb)
+{
+    if(_continuous) {
+        return;
+    }
+    _ready = ready_cb;
+    ready = false;
+    _busy = true;
+    // A stale interrupt would pull INT low as soon as AIEN is set
+    clearInterrupt();
+    enable();
+    if(_int) {
+        _int->fall(callback(this, &TSL2591::handlerReady));
+    }
+    armTimeout();
+}
+/*
+ *  Start Continuous ALS
+ *  Leave the ALS on and integrating back to back. ready is set, and the
+ *  callback (if any) runs, as each result becomes valid; readALS harvests it
+ *  and leaves the sensor running. Runs until stopALS.
+ */
+void TSL2591::startContinuousALS(Callback<void()> ready_cb)
+{
+    if(_busy) {
+        stopALS();
+    }
+    _ready = ready_cb;
+    ready = false;
+    _busy = true;
+    _continuous = true;
+    // Interrupt at the end of every integration, whatever the thresholds
+    char write[] = {(TSL2591_CMD_BIT|TSL2591_REG_PERSIST), (TSL2591_PER_EVERY)};
+    _bus->write(write, 2);
+    clearInterrupt();
+    enable();
+    if(_int) {
+        _int->fall(callback(this, &TSL2591::handlerReady));
+    }
+    armTimeout();
+}
+/*
+ *  Stop ALS
+ *  Abandon any integration in flight, continuous or not, and power off
+ */
+void TSL2591::stopALS(void)
+{
+    _timeout.detach();
+    if(_int) {
+        _int->fall(nullptr);
+    }
+    disable();
+    clearInterrupt();
+    _busy = false;
+    _continuous = false;
+    ready = false;
+}
+/*
+ *  Signal the end of the integration in flight after the integration time,
+ *  or back INT up in case it never fires
+ */
+void TSL2591::armTimeout(void)
+{
+    std::chrono::milliseconds integration((_integ + 1) * 100);
+    if(_int) {
+        integration += 100ms;
+    }
+    _timeout.attach(callback(this, &TSL2591::handlerReady), integration);
+}
+/*
+ *  Read ALS started with startALS or startContinuousALS
+ *  Returns false if no integration is in flight or no new result is valid
+ *  yet, otherwise reads full, infrared, and visible. Powers off unless
+ *  streaming.
+ */
+bool TSL2591::readALS(void)
+{
+    if(!_busy) {
+        return false;
+    }
+    // STATUS and both channels in one burst
+    char read[5];
+    _bus->read(TSL2591_CMD_BIT|TSL2591_REG_STATUS, read, 5);
+    uint8_t status = read[0];
+    if(!(status & TSL2591_STATUS_AVALID)) {
+        return false;
+    }
+    if(_continuous) {
+        // AVALID stays set while streaming, AINT marks an unread result
+        if(!(status & TSL2591_STATUS_AINT)) {
+            return false;
+        }
+        parseChannels(&read[1]);
+        clearInterrupt();
+        ready = false;
+        armTimeout();
+        if(_autoRange) {
+            autoRange();
+        }
+        return true;
+    }
+    _timeout.detach();
+    parseChannels(&read[1]);
+    clearInterrupt();
+    disable();
+    _busy = false;
+    ready = false;
+    if(_autoRange) {
+        autoRange();
+    }
+    return true;
+}
+/*
+ *  Read both channels into rawALS, full, ir, and visible
+ */
+void TSL2591::readChannels(void)
+{
+    // C0DATAL through C1DATAH in one burst
+    char read[4];
+    _bus->read(TSL2591_CMD_BIT|TSL2591_REG_CHAN0_L, read, 4);
+    parseChannels(read);
+}
+/*
+ *  Unpack C0DATAL, C0DATAH, C1DATAL, C1DATAH into rawALS, full, ir, and
+ *  visible, and normalize to counts per (gain x ms) at the gain and
+ *  integration time they were taken with
+ */
+void TSL2591::parseChannels(const char * data)
+{
+    const uint8_t * d = (const uint8_t *)data;
+    // Channel 1 is 0xFFFF0000, Channel 0 is 0xFFFF
+    rawALS = ((uint32_t)((d[3]<<8)|d[2])<<16)|((d[1]<<8)|d[0]);
     full = rawALS & 0xFFFF;
     ir = rawALS >> 16;
     visible = full - ir;
+    uint16_t maxCounts = tsl2591MaxCounts(_integ);
+    saturated = full >= maxCounts || ir >= maxCounts;
+    float scale = tsl2591GainScale[_gain >> 4] * (_integ + 1) * 100;
+    fullRate = full / scale;
+    irRate = ir / scale;
+}
+/*
+ *  Clear ALS and no persist interrupts, releasing INT
+ */
+void TSL2591::clearInterrupt(void)
+{
+    char write[] = {(TSL2591_CMD_CLR_INT)};
+    _bus->write(write, 1);
+}
+/*
+ *  INT falling edge or integration timeout, interrupt context
+ */
+void TSL2591::handlerReady(void)
+{
+    if(!_busy || ready) {
+        return;
+    }
+    ready = true;
+    if(_ready) {
+        _ready();
+    }
 }
 /*
  *  Calculate Lux
  */
 void TSL2591::calcLux(void)
 {
-    float atime, again, cpl, lux1, lux2, lux3;
-    if((full == 0xFFFF)|(ir == 0xFFFF)) {
-        lux3 = 0;
+    float lux1, lux2, lux3;
+    if(saturated) {
         return;
     }
-    switch(_integ) {
-        case TSL2591_INTT_100MS:
-            atime = 100.0F;
-            break;
-        case TSL2591_INTT_200MS:
-            atime = 200.0F;
-            break;
-        case TSL2591_INTT_300MS:
-            atime = 300.0F;
-            break;
-        case TSL2591_INTT_400MS:
-            atime = 400.0F;
-            break;
-        case TSL2591_INTT_500MS:
-            atime = 500.0F;
-            break;
-        case TSL2591_INTT_600MS:
-            atime = 600.0F;
-            break;
-        default:
-            atime = 100.0F;
-            break;
-    }
-    switch(_gain) {
-        case TSL2591_GAIN_LOW:
-            again = 1.0F;
-            break;
-        case TSL2591_GAIN_MED:
-            again = 25.0F;
-            break;
-        case TSL2591_GAIN_HIGH:
-            again = 428.0F;
-            break;
-        case TSL2591_GAIN_MAX:
-            again = 9876.0F;
-            break;
-        default:
-            again = 1.0F;
-            break;
-    }
-    cpl = (atime * again) / TSL2591_LUX_DF;
-    lux1 = ((float)full - (TSL2591_LUX_COEFB * (float)ir)) / cpl;
-    lux2 = (( TSL2591_LUX_COEFC * (float)full ) - ( TSL2591_LUX_COEFD * (float)ir)) / cpl;
+    // Counts per (gain x ms) already divide out atime and again
+    lux1 = (fullRate - (TSL2591_LUX_COEFB * irRate)) * TSL2591_LUX_DF;
+    lux2 = ((TSL2591_LUX_COEFC * fullRate) - (TSL2591_LUX_COEFD * irRate)) * TSL2591_LUX_DF;
     lux3 = lux1 > lux2 ? lux1 : lux2;
     lux = (uint32_t)lux3;
 }
\ No newline at end of file
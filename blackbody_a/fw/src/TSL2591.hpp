@@ -2,11 +2,14 @@
 #define TSL2591_H
 
 #include "mbed.h"
+#include "TSL2591_Bus.h"
+#include "TSL2591_I2CBus.h"
 
 #define TSL2591_ADDR        (0x29)
 #define TSL2591_ID          (0x50)
 
 #define TSL2591_CMD_BIT     (0xA0)
+#define TSL2591_CMD_CLR_INT (0xE7)  // Special function: clear ALS and no persist interrupts
 
 #define TSL2591_EN_NPIEN    (0x80)
 #define TSL2591_EN_SAI      (0x40)
@@ -15,6 +18,13 @@
 #define TSL2591_EN_PON      (0x01)
 #define TSL2591_EN_POFF     (0x00)
 
+#define TSL2591_STATUS_AVALID   (0x01)
+#define TSL2591_STATUS_AINT     (0x10)
+
+#define TSL2591_AUTO_MIN_COUNTS     (1000)      // Precision target, 0.1 % of a reading
+#define TSL2591_AUTO_HEADROOM       (0.75F)     // Fraction of full scale the next reading may use
+#define TSL2591_AUTO_HYSTERESIS     (1.25F)     // Margin before leaving the current setting
+
 #define TSL2591_LUX_DF      (408.0F)
 #define TSL2591_LUX_COEFB   (1.64F)  // CH0 coefficient 
 #define TSL2591_LUX_COEFC   (0.59F)  // CH1 coefficient A
@@ -42,10 +52,10 @@ enum {
 };
 
 typedef enum {
-    TSL2591_GAIN_LOW    = 0x00,
-    TSL2591_GAIN_MED    = 0x01,
-    TSL2591_GAIN_HIGH   = 0x02,
-    TSL2591_GAIN_MAX    = 0x03,
+    TSL2591_GAIN_LOW    = 0x00,  // CONTROL AGAIN, bits 5:4
+    TSL2591_GAIN_MED    = 0x10,
+    TSL2591_GAIN_HIGH   = 0x20,
+    TSL2591_GAIN_MAX    = 0x30,
 } tsl2591Gain_t;
 
 typedef enum {
@@ -79,26 +89,52 @@ typedef enum {
 class TSL2591
 {
     public:
-    TSL2591(I2C * tsl2591_i2c, uint8_t tsl2591_addr=TSL2591_ADDR);
+    TSL2591(I2C * tsl2591_i2c, uint8_t tsl2591_addr=TSL2591_ADDR, InterruptIn * tsl2591_int=NULL);
+    TSL2591(TSL2591_Bus * tsl2591_bus, InterruptIn * tsl2591_int=NULL);
     bool init(void);
     void enable(void);
     void disable(void);
     void setGain(tsl2591Gain_t gain);
     void setTime(tsl2591IntegrationTime_t integ);
+    void setAutoRange(bool enable);
+    tsl2591Gain_t getGain(void) const { return _gain; }
+    tsl2591IntegrationTime_t getTime(void) const { return _integ; }
     void getALS(void);
+    void startALS(Callback<void()> ready=nullptr);
+    void startContinuousALS(Callback<void()> ready=nullptr);
+    void stopALS(void);
+    bool readALS(void);
+    bool busy(void) const { return _busy; }
+    bool continuous(void) const { return _continuous; }
     void calcLux(void);
+    volatile bool               ready;
     volatile uint32_t           rawALS;
     volatile uint16_t           ir;
     volatile uint16_t           full;
     volatile uint16_t           visible;
     volatile uint32_t           lux;
+    volatile float              fullRate;   // Counts per (gain x ms)
+    volatile float              irRate;     // Counts per (gain x ms)
+    volatile bool               saturated;
     
     protected:
-    I2C                         *_i2c;
-    uint8_t                     _addr;
+    TSL2591_Bus                 *_bus;
     bool                        _init;
     tsl2591Gain_t               _gain;
     tsl2591IntegrationTime_t    _integ;
+    InterruptIn                 *_int;
+    Timeout                     _timeout;
+    Callback<void()>            _ready;
+    volatile bool               _busy;
+    bool                        _continuous;
+    bool                        _autoRange;
+    void autoRange(void);
+    void writeControl(void);
+    void armTimeout(void);
+    void readChannels(void);
+    void parseChannels(const char * data);
+    void clearInterrupt(void);
+    void handlerReady(void);
 };
 
 #endif
\ No newline at end of file
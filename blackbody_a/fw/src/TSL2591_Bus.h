@@ -0,0 +1,38 @@
+/**
+ * @file TSL2591_Bus.h
+ * @brief I2C transaction layer for the TSL2591 driver. A bus moves one
+ * register transaction per call, so that TSL2591 does not need to know
+ * whether it sits directly on an mbed I2C bus, behind a mux, or on a host
+ * mock.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#pragma once
+#include "mbed.h"
+
+/**
+ * @brief Interface for a TSL2591 register transaction.
+ */
+class TSL2591_Bus
+{
+    public:
+        virtual ~TSL2591_Bus() {}
+
+        /**
+         * @brief Write length bytes in one transaction. data[0] is the command
+         * byte (register address or special function).
+         *
+         * @return 0 on success, nonzero if the sensor did not acknowledge.
+         */
+        virtual int write(const char* data, int length) = 0;
+
+        /**
+         * @brief Write the command byte, then read length bytes after a
+         * repeated start, in one transaction. With the normal operation
+         * command the register address auto-increments, so consecutive
+         * registers come back in a single burst.
+         *
+         * @return 0 on success, nonzero if the sensor did not acknowledge.
+         */
+        virtual int read(uint8_t command, char* data, int length) = 0;
+};
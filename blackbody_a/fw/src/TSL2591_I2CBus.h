@@ -0,0 +1,59 @@
+/**
+ * @file TSL2591_I2CBus.h
+ * @brief mbed I2C bus for the TSL2591 driver. Register reads are a single
+ * write, repeated start, read transaction, done in the background with
+ * I2C::transfer where the target supports it.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note The TSL2591 is specified up to 400 kHz (fast mode). The L432KC also
+ * supports 1 MHz fast mode plus, but only use it on a bus without a TSL2591.
+ */
+#pragma once
+#include "mbed.h"
+#include "TSL2591_Bus.h"
+
+#define TSL2591_I2C_FREQUENCY   (400000) /* Hz */
+
+class TSL2591_I2CBus : public TSL2591_Bus
+{
+    public:
+        /**
+         * @brief Construct a new I2C bus.
+         *
+         * @param i2c I2C bus the sensor sits on.
+         * @param addr 7-bit address of the sensor.
+         * @param frequency SCL frequency in Hz, applied to the whole bus.
+         * Default TSL2591_I2C_FREQUENCY.
+         */
+        TSL2591_I2CBus(I2C* i2c, uint8_t addr, int frequency = TSL2591_I2C_FREQUENCY);
+
+        int write(const char* data, int length) override;
+        int read(uint8_t command, char* data, int length) override;
+
+    private:
+        /**
+         * @brief Transfer completion callback, runs in interrupt context.
+         */
+        void _complete(int event);
+
+        /**
+         * @brief Reference to the I2C bus object.
+         */
+        I2C*            _i2c;
+
+        /**
+         * @brief 8-bit (shifted) address of the sensor.
+         */
+        int             _addr;
+
+        /**
+         * @brief Released by _complete when the transfer has finished.
+         */
+        Semaphore       _done;
+
+        /**
+         * @brief Event that ended the last transfer.
+         */
+        volatile int    _event;
+};
@@ -0,0 +1,35 @@
+/**
+ * @file TSL2591_MuxBus.cpp
+ * @brief TSL2591 bus on one channel of a TCA9548A.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#include "TSL2591_MuxBus.h"
+
+TSL2591_MuxBus::TSL2591_MuxBus(TCA9548A* mux, uint8_t channel, uint8_t addr, int frequency)
+    : _mux(mux), _channel(channel), _bus(mux->i2c(), addr, frequency)
+{
+}
+
+int TSL2591_MuxBus::write(const char* data, int length)
+{
+    // Another thread must not move the switch between select and write
+    _mux->lock();
+    int result = _mux->select(_channel);
+    if (result == 0) {
+        result = _bus.write(data, length);
+    }
+    _mux->unlock();
+    return result;
+}
+
+int TSL2591_MuxBus::read(uint8_t command, char* data, int length)
+{
+    _mux->lock();
+    int result = _mux->select(_channel);
+    if (result == 0) {
+        result = _bus.read(command, data, length);
+    }
+    _mux->unlock();
+    return result;
+}
@@ -0,0 +1,46 @@
+/**
+ * @file TSL2591_MuxBus.h
+ * @brief TSL2591 bus on one channel of a TCA9548A. Each transaction selects
+ * the channel first, so any number of sensors at 0x29 share the upstream bus.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#pragma once
+#include "mbed.h"
+#include "TCA9548A.h"
+#include "TSL2591_Bus.h"
+#include "TSL2591_I2CBus.h"
+
+class TSL2591_MuxBus : public TSL2591_Bus
+{
+    public:
+        /**
+         * @brief Construct a new mux channel bus.
+         *
+         * @param mux Switch the sensor sits behind.
+         * @param channel Downstream channel of the sensor, 0 - 7.
+         * @param addr 7-bit address of the sensor.
+         * @param frequency SCL frequency in Hz, applied to the whole bus.
+         * Default TSL2591_I2C_FREQUENCY.
+         */
+        TSL2591_MuxBus(TCA9548A* mux, uint8_t channel, uint8_t addr, int frequency = TSL2591_I2C_FREQUENCY);
+
+        int write(const char* data, int length) override;
+        int read(uint8_t command, char* data, int length) override;
+
+    private:
+        /**
+         * @brief Reference to the switch.
+         */
+        TCA9548A*       _mux;
+
+        /**
+         * @brief Downstream channel of the sensor.
+         */
+        uint8_t         _channel;
+
+        /**
+         * @brief Sensor transactions once the channel is selected.
+         */
+        TSL2591_I2CBus  _bus;
+};
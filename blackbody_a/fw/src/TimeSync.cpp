@@ -0,0 +1,153 @@
+/**
+ * @file TimeSync.cpp
+ * @brief Common time base for the boards on one CAN bus.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#include "TimeSync.h"
+#include <cstring>
+
+TimeSync::TimeSync(CanTxQueue* tx, bool master)
+    : _tx(tx), _master(master), _awaiting_tx(false), _sequence(0)
+{
+    _reset();
+    memset(&_stats, 0, sizeof(_stats));
+    _clock.start();
+}
+
+uint64_t TimeSync::local_us(void)
+{
+    return _clock.elapsed_time().count();
+}
+
+void TimeSync::send_sync(void)
+{
+    if (!_master) {
+        return;
+    }
+    _sequence++;
+    _awaiting_tx = true;
+    _tx->write(CANMessage(CAN_TIME_SYNC, &_sequence, 1), CanTxQueue::PRIORITY_URGENT);
+}
+
+void TimeSync::on_tx_complete(void)
+{
+    if (!_awaiting_tx) {
+        return;
+    }
+    uint64_t now = local_us();
+    _awaiting_tx = false;
+    uint8_t data[7];
+    data[0] = _sequence;
+    for (uint8_t i = 0; i < 6; ++i) {
+        data[1 + i] = now >> (8 * i);
+    }
+    _tx->write(CANMessage(CAN_TIME_FUP, data, 7), CanTxQueue::PRIORITY_URGENT);
+}
+
+bool TimeSync::handle(const CANMessage& msg, uint64_t rx_local_us)
+{
+    if (msg.id == CAN_TIME_SYNC && msg.len >= 1) {
+        _sync_sequence = msg.data[0];
+        _sync_local_us = rx_local_us;
+        _have_sync = true;
+        return true;
+    }
+    if (msg.id == CAN_TIME_FUP && msg.len >= 7) {
+        // A follow-up without its SYNC, e.g. one lost to a full ring, is
+        // of no use
+        if (!_master && _have_sync && msg.data[0] == _sync_sequence) {
+            uint64_t master_us = 0;
+            for (uint8_t i = 0; i < 6; ++i) {
+                master_us |= (uint64_t)msg.data[1 + i] << (8 * i);
+            }
+            _sample(_sync_local_us, master_us);
+        }
+        _have_sync = false;
+        return true;
+    }
+    return false;
+}
+
+uint64_t TimeSync::to_master(uint64_t local_us) const
+{
+    if (_master || _accepted == 0) {
+        return local_us;
+    }
+    return _to_master_ns(local_us) / 1000;
+}
+
+uint64_t TimeSync::_to_master_ns(uint64_t local_us) const
+{
+    int64_t elapsed = (int64_t)(local_us - _ref_local_us);
+    return _ref_master_ns + elapsed * 1000 + elapsed * _drift_ppb / 1000000;
+}
+
+CANMessage TimeSync::sample_time(uint32_t paired_id, uint8_t key, uint64_t sample_local_us) const
+{
+    uint64_t time = to_master(sample_local_us);
+    uint8_t data[8];
+    data[0] = (paired_id - 0x600) & 0x7F;
+    if (locked()) {
+        data[0] |= 0x80;
+    }
+    data[1] = key;
+    for (uint8_t i = 0; i < 6; ++i) {
+        data[2 + i] = time >> (8 * i);
+    }
+    return CANMessage(CAN_SAMPLE_TIME, data, 8);
+}
+
+void TimeSync::_sample(uint64_t local_us, uint64_t master_us)
+{
+    _stats.samples++;
+    if (_accepted == 0) {
+        _ref_local_us = local_us;
+        _ref_master_ns = master_us * 1000;
+        _accepted = 1;
+        return;
+    }
+    int64_t predicted = (int64_t)_to_master_ns(local_us);
+    int64_t residual = (int64_t)(master_us * 1000) - predicted;
+    _stats.last_residual_us = residual / 1000;
+    if (residual > TIME_SYNC_RESET_US * 1000LL || residual < -TIME_SYNC_RESET_US * 1000LL || _rejected_in_row >= 8) {
+        // A new master, or lost track: start from this sample
+        _stats.resets++;
+        _reset();
+        _ref_local_us = local_us;
+        _ref_master_ns = master_us * 1000;
+        _accepted = 1;
+        return;
+    }
+    if (locked() && residual < -TIME_SYNC_REJECT_US * 1000LL) {
+        _stats.rejected++;
+        _rejected_in_row++;
+        return;
+    }
+    _rejected_in_row = 0;
+    int64_t elapsed = (int64_t)(local_us - _ref_local_us);
+    if (elapsed <= 0) {
+        return;
+    }
+    // Second sample: take the rate outright. After that a second order
+    // loop, phase gain 1/2 and frequency gain 1/4, which settles in a few
+    // periods without ringing. The phase is kept in ns: halving a 1 us
+    // residual in whole us would leave the loop hunting by 1 ppm.
+    bool first = _accepted == 1;
+    _drift_ppb += (int32_t)(residual * 1000000 / elapsed / (first ? 1 : 4));
+    _ref_master_ns = predicted + (first ? residual : residual / 2);
+    _ref_local_us = local_us;
+    _accepted++;
+}
+
+void TimeSync::_reset(void)
+{
+    _have_sync = false;
+    _sync_sequence = 0;
+    _sync_local_us = 0;
+    _ref_local_us = 0;
+    _ref_master_ns = 0;
+    _drift_ppb = 0;
+    _accepted = 0;
+    _rejected_in_row = 0;
+}
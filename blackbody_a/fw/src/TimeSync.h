@@ -0,0 +1,171 @@
+/**
+ * @file TimeSync.h
+ * @brief Common time base for the boards on one CAN bus. One master
+ * broadcasts its clock; every other board estimates its offset and drift to
+ * it, so that samples from different boards can be stamped on one clock to
+ * the microsecond.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note Two step, once per TIME_SYNC_PERIOD:
+ * - CAN_TIME_SYNC [0] sequence. Slaves note their own clock when it arrives.
+ * - CAN_TIME_FUP  [0] sequence, [1..6] 48 bit little endian master time, us,
+ *   taken in the master's TX complete interrupt after CAN_TIME_SYNC.
+ *
+ * Both ends take their time at the end of the same frame, so the follow-up
+ * time minus the slave's receive time is the offset, free of queueing and
+ * arbitration. If a frame of the master's own completes first, the master
+ * stamps too early; such samples come out over TIME_SYNC_REJECT_US early
+ * against the estimate and are dropped.
+ *
+ * @note Measurement frames are followed by a CAN_SAMPLE_TIME, see
+ * sample_time():
+ * - [0]    bits 6:0 the measurement frame's identifier minus 0x600, bit 7
+ *          set if the time is on the master's clock, clear if it is board
+ *          uptime because no master has been heard yet
+ * - [1]    the measurement frame's key: the sensor index of a float frame,
+ *          byte 7 (bank and sequence) of a packed one
+ * - [2..7] 48 bit little endian time of the first sample in it, us
+ *
+ * @note Slaves track the master with a phase and frequency loop, in integer
+ * microseconds and parts per billion. now_us() is board uptime until the
+ * first follow-up arrives.
+ */
+#pragma once
+#include "mbed.h"
+#include "CanTxQueue.h"
+
+#define CAN_TIME_SYNC       0x62D
+#define CAN_TIME_FUP        0x62E
+#define CAN_SAMPLE_TIME     0x62F
+
+#define TIME_SYNC_PERIOD        (1000ms)
+#define TIME_SYNC_REJECT_US     (200)       /* Early stamps beyond this are dropped */
+#define TIME_SYNC_RESET_US      (1000000)   /* Start over past this, e.g. a new master */
+#define TIME_SYNC_LOCK_SAMPLES  (4)         /* Accepted samples before locked() */
+
+class TimeSync
+{
+    public:
+        struct stats {
+            uint32_t    samples;    /* Follow-ups matched to a SYNC */
+            uint32_t    rejected;   /* Of those, dropped as early stamps */
+            uint32_t    resets;     /* Estimate started over */
+            int32_t     last_residual_us;   /* Master time minus estimate at the last sample */
+        };
+
+        /**
+         * @brief Construct a new time base. A master sends through tx and
+         * must be given the TX complete interrupt, see on_tx_complete().
+         */
+        TimeSync(CanTxQueue* tx, bool master);
+
+        /**
+         * @brief Master: broadcast CAN_TIME_SYNC. Call every
+         * TIME_SYNC_PERIOD. No-op on a slave.
+         */
+        void send_sync(void);
+
+        /**
+         * @brief Master: TX complete interrupt. Stamps the SYNC in flight and
+         * queues its follow-up.
+         */
+        void on_tx_complete(void);
+
+        /**
+         * @brief Slave: take CAN_TIME_SYNC and CAN_TIME_FUP.
+         *
+         * @param rx_local_us Local time the frame arrived, from the RX
+         * interrupt.
+         * @return true If msg was a time sync frame.
+         */
+        bool handle(const CANMessage& msg, uint64_t rx_local_us);
+
+        /**
+         * @brief Free running board clock, us since power on. Interrupt
+         * safe.
+         */
+        virtual uint64_t local_us(void);
+
+        /**
+         * @brief Master time for a local time, or the local time itself
+         * until locked() on a slave.
+         */
+        uint64_t to_master(uint64_t local_us) const;
+
+        /**
+         * @brief Now on the common time base, see to_master().
+         */
+        uint64_t now_us(void) { return to_master(local_us()); }
+
+        /**
+         * @brief On the master's clock: the master itself, or a slave with
+         * TIME_SYNC_LOCK_SAMPLES samples in its estimate.
+         */
+        bool locked(void) const { return _master || _accepted >= TIME_SYNC_LOCK_SAMPLES; }
+
+        bool master(void) const { return _master; }
+
+        /**
+         * @brief Rate of the master's clock against ours, minus 1.
+         */
+        int32_t drift_ppb(void) const { return _drift_ppb; }
+
+        const stats& statistics(void) const { return _stats; }
+
+        /**
+         * @brief CAN_SAMPLE_TIME for a measurement frame.
+         *
+         * @param paired_id Identifier of the measurement frame.
+         * @param key Sensor index, or byte 7 of a packed frame.
+         * @param sample_local_us Local time the sample was taken.
+         */
+        CANMessage sample_time(uint32_t paired_id, uint8_t key, uint64_t sample_local_us) const;
+
+        virtual ~TimeSync() {}
+
+    private:
+        /**
+         * @brief Fold one offset sample into the estimate.
+         */
+        void _sample(uint64_t local_us, uint64_t master_us);
+
+        /**
+         * @brief Slave: master time for a local time, ns.
+         */
+        uint64_t _to_master_ns(uint64_t local_us) const;
+
+        /**
+         * @brief Forget the estimate.
+         */
+        void _reset(void);
+
+        CanTxQueue*     _tx;
+        bool            _master;
+        Timer           _clock;
+
+        /**
+         * @brief Master: SYNC sent, waiting for its TX complete.
+         */
+        volatile bool   _awaiting_tx;
+        uint8_t         _sequence;
+
+        /**
+         * @brief Slave: last SYNC seen.
+         */
+        uint8_t         _sync_sequence;
+        uint64_t        _sync_local_us;
+        bool            _have_sync;
+
+        /**
+         * @brief Slave estimate: master time _ref_master_ns at local time
+         * _ref_local_us, and the master's rate from there on.
+         */
+        uint64_t        _ref_local_us;
+        uint64_t        _ref_master_ns;
+        int32_t         _drift_ppb;
+        uint32_t        _accepted;
+        uint8_t         _rejected_in_row;
+
+        stats           _stats;
+};
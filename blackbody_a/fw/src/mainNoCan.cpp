@@ -13,8 +13,8 @@
  * 
  *  - D2  | CAN_TX
  *  - D10 | CAN_RX
- *  - D4  | I2C_SDA to Blackbody C
- *  - D5  | I2C_SCL to Blackbody C
+ *  - D4  | I2C_SDA to Blackbody C (TCA9548A if IRRAD_MUX)
+ *  - D5  | I2C_SCL to Blackbody C (TCA9548A if IRRAD_MUX)
  *  - D11 | SPI_MISO to RTDs
  *  - D12 | SPI_MOSI to RTDs
  *  - D13 | SPI_SCLK to RTDs
@@ -29,11 +29,21 @@
  */
 #include "mbed.h"
 #include "MAX31865_BitBangEnabled.h"  //RTD Sensor
+#include "MAX31865_SPITransport.h"
+#include "MAX31865_FastBus.h"
 #include "TSL2591.hpp"  
+#include "TSL2591_MuxBus.h"
+#include "CycleSchedule.h"
+#include "CanTxQueue.h"
+#include "CanRxQueue.h"
+#include "TimeSync.h"
+#include "SamplePacker.h"
+#include "SampleLog.h"
+#include "ChannelFilter.h"
+#include "ChangeReporter.h"
 #include <cstdio>
 
 #define __LOOPBACK__      0
-#define NUM_IRRAD_SENSORS 1
 #define NUM_TEMP_SENSORS 7
 #define CAN_HEARTBEAT   0x620
 #define CAN_SET_MODE    0x621
@@ -43,9 +53,127 @@
 #define CAN_IRR_CONF    0x625
 #define CAN_RTD_MEAS    0x626
 #define CAN_IRR_MEAS    0x627
+#define CAN_SCHED_DIAG  0x628
+#define CAN_TX_STATS_REQ 0x629
+#define CAN_TX_STATS    0x62A
+#define CAN_RTD_PACKED  0x62B
+#define CAN_IRR_PACKED  0x62C
+#define CAN_FILTER_CONF 0x63B
+
+// Acceptance filter: only 0x620 to 0x63F reach the RX FIFO, the rest of the
+// bus never interrupts the MCU.
+#define CAN_RX_FILTER_ID    0x620
+#define CAN_RX_FILTER_MASK  0x7E0
 
 #define debug 0
 
+// RTD bus backend. Hardware SPI needs SDI on D11 and SDO on D12, the opposite
+// of the v0.2.0 routing, see MAX31865_SPITransport.h.
+#define RTD_HARDWARE_SPI 0
+
+// RTD conversions. One-shot: each round, every active RTD gets Vbias, they
+// convert side by side and are switched off together, then read one by one,
+// so an RTD carries current for about 70 ms a round instead of all the time.
+// 0 keeps them converting continuously with Vbias on.
+#ifndef RTD_ONE_SHOT
+#define RTD_ONE_SHOT 1
+#endif
+
+// Vbias settling before a one-shot conversion: 1 ms plus 10.5 time constants
+// of the RTD input filter, see the MAX31865 datasheet. 2 ms leaves room for
+// 95 us of RC.
+#define RTD_BIAS_SETTLE_US 2000
+// Margin on a conversion with the 50 Hz filter before finishing the round.
+#define RTD_CONVERSION_US (MAX31865_CONVERSION_50HZ_US + 1000)
+// Between the reads of a one-shot round, for each sample's frames to leave
+// before the next.
+#define RTD_READ_GAP_US 2000
+
+// Number of RTD samples per channel between full register dumps. The samples
+// in between only read the resistance registers. Adjustable with byte 3 of
+// CAN_RTD_CONF.
+#define RTD_HEALTH_CHECK_PERIOD 32
+
+// Worst-case run time of each task, for laying out the cycle. Bit-banged
+// full register dumps dominate the RTDs; irradiance is per active sensor.
+#define SCHED_HEARTBEAT_US      200
+#define SCHED_TIME_SYNC_US      200
+#define SCHED_RTD_US            1000
+#define SCHED_IRRAD_US          1500
+#define SCHED_DIAG_US           200
+#define SCHED_LOG_DUMP_US       600
+#define SCHED_RTD_FAULT_US      1500
+#define SCHED_RTD_BIAS_US       100
+
+// Tie break between equal deadlines, 0 first.
+enum SchedulePriority {
+    PRIORITY_HEARTBEAT = 0,
+    PRIORITY_TIME_SYNC = 1,
+    PRIORITY_IRRAD = 2,
+    PRIORITY_RTD = 3,
+    PRIORITY_DIAG = 4,
+    PRIORITY_LOG_DUMP = 5,
+    PRIORITY_RTD_FAULT = 6
+};
+
+// Rate of the MAX31865 fault detection cycle, one active RTD at a time, so
+// each of seven is checked every 7 s. The cycle stops that chip's
+// conversions for 0.6 ms, see MAX31865_RTD::detect_faults(). With one-shot
+// conversions it runs after a round instead, when no chip is converting.
+// The same slot reads back the registers of an RTD that read zero, see
+// MAX31865_RTD::verify().
+#define RTD_FAULT_CHECK_HZ 1
+
+// Rate at which a dump of the sample log tops up the bulk transmit ring, see
+// SampleLog.h. 14 frames at 10 Hz take about a fifth of the bus.
+#define LOG_DUMP_HZ 10
+#define LOG_DUMP_PERIOD (100ms)
+
+// This board keeps the time for the bus, see TimeSync.h. Exactly one board,
+// or the vehicle controller, may; the others follow it.
+#ifndef TIME_SYNC_MASTER
+#define TIME_SYNC_MASTER 0
+#endif
+
+// Measurement frame formats, selected with RTD_CONF byte 4 and IRR_CONF byte
+// 3. Packed frames carry three samples each, see SamplePacker.h: RTDs in
+// centi-degrees C, irradiance in 0.1 W/m^2. Every sample also goes to the
+// sample log, whatever the format; with FORMAT_LOG only there, for rates the
+// bus cannot carry live.
+enum FrameFormat {
+    FORMAT_FLOAT = 0,   // RTD_MEAS / IRR_MEAS, one float per frame
+    FORMAT_PACKED = 1,  // RTD_PACKED / IRR_PACKED
+    FORMAT_LOG = 2      // Nothing live, dump it from the log
+};
+
+// Cycles of timing behind each CAN_SCHED_DIAG report.
+#define SCHED_DIAG_CYCLES 10
+
+// BB_FAULT code for requested rates that do not fit in the cycle.
+#define FAULT_SCHEDULE 0x10
+// BB_FAULT code for a FILTER_CONF that is not valid.
+#define FAULT_FILTER 0x11
+// BB_FAULT code for irradiance sampled faster than the TSL2591s integrate:
+// the most they deliver now, in Hz, follows.
+#define FAULT_IRRAD_RATE 0x12
+// BB_FAULT code for RTD faults: a byte per RTD follows, see rtd_fault().
+#define FAULT_RTD 0x20
+// Bit 0 of an RTD's fault byte, free in the MAX31865 fault status: the
+// channel is out of sampling until CAN_ACK_FAULT.
+#define RTD_QUARANTINED 0x01
+
+// Irradiance sensors behind a TCA9548A I2C switch, one per channel. Every
+// TSL2591 answers at 0x29, so without the switch only one sensor can sit on
+// the bus, see SYSTEM_DESIGN.md.
+#ifndef IRRAD_MUX
+#define IRRAD_MUX 0
+#endif
+#if IRRAD_MUX
+#define NUM_IRRAD_SENSORS TCA9548A_CHANNELS
+#else
+#define NUM_IRRAD_SENSORS 1
+#endif
+
 enum State {
     STATE_STOP = 0,
     STATE_RUN = 1,
@@ -55,7 +183,15 @@ enum State {
 DigitalOut led_heartbeat(D1);
 DigitalOut led_tracking(D0);
 DigitalOut led_error(D3);
-CAN can(D10, D2);
+IsrCAN can(D10, D2);
+// Every frame goes out through here, see CanTxQueue.h.
+CanTxQueue can_tx(&can);
+// And comes in through here, see CanRxQueue.h. Commands are handled between
+// slots as soon as they arrive; a CONF frame retimes sampling from the next
+// cycle on.
+CanRxQueue can_rx(&can);
+// Common time base for sample timestamps.
+TimeSync time_sync(&can_tx, TIME_SYNC_MASTER);
 
 enum State current_state;
 bool is_error;
@@ -63,32 +199,123 @@ bool set_mode;
 bool ack_fault;
 
 static I2C i2c1(I2C_SDA, I2C_SCL);
+#if IRRAD_MUX
+static TCA9548A irrad_mux(&i2c1);
+static TSL2591_MuxBus irrad_bus0(&irrad_mux, 0, TSL2591_ADDR);
+static TSL2591_MuxBus irrad_bus1(&irrad_mux, 1, TSL2591_ADDR);
+static TSL2591_MuxBus irrad_bus2(&irrad_mux, 2, TSL2591_ADDR);
+static TSL2591_MuxBus irrad_bus3(&irrad_mux, 3, TSL2591_ADDR);
+static TSL2591_MuxBus irrad_bus4(&irrad_mux, 4, TSL2591_ADDR);
+static TSL2591_MuxBus irrad_bus5(&irrad_mux, 5, TSL2591_ADDR);
+static TSL2591_MuxBus irrad_bus6(&irrad_mux, 6, TSL2591_ADDR);
+static TSL2591_MuxBus irrad_bus7(&irrad_mux, 7, TSL2591_ADDR);
+static TSL2591 irrad0(&irrad_bus0);
+static TSL2591 irrad1(&irrad_bus1);
+static TSL2591 irrad2(&irrad_bus2);
+static TSL2591 irrad3(&irrad_bus3);
+static TSL2591 irrad4(&irrad_bus4);
+static TSL2591 irrad5(&irrad_bus5);
+static TSL2591 irrad6(&irrad_bus6);
+static TSL2591 irrad7(&irrad_bus7);
+#else
 static TSL2591 irrad(&i2c1, TSL2591_ADDR);
+#endif
 typedef struct IrradianceSensors {
     uint8_t active_sensors_packed;
+#if IRRAD_MUX
+    TSL2591* sensors[NUM_IRRAD_SENSORS] = {&irrad0, &irrad1, &irrad2, &irrad3, &irrad4, &irrad5, &irrad6, &irrad7};
+#else
     TSL2591* sensors[NUM_IRRAD_SENSORS] = {&irrad}; // TODO: fix this init DONE
+#endif
     uint16_t raw_sensor_vals[NUM_IRRAD_SENSORS];
     uint16_t sample_frequency;
+    uint8_t format;
 } IrradianceSensors;
 
-MAX31865_RTD rtd0(MAX31865_RTD::RTD_PT100, D12, D11, D13, A6);
-MAX31865_RTD rtd1(MAX31865_RTD::RTD_PT100, D12, D11, D13, A4);  // hates irrad
-MAX31865_RTD rtd2(MAX31865_RTD::RTD_PT100, D12, D11, D13, A3); 
-MAX31865_RTD rtd3(MAX31865_RTD::RTD_PT100, D12, D11, D13, A0); 
-// MAX31865_RTD rtd4(MAX31865_RTD::RTD_PT100, D12, D11, D13, A7);  // hates print
-MAX31865_RTD rtd5(MAX31865_RTD::RTD_PT100, D12, D11, D13, A5);  // hates irrad
-MAX31865_RTD rtd6(MAX31865_RTD::RTD_PT100, D12, D11, D13, A2); 
-MAX31865_RTD rtd7(MAX31865_RTD::RTD_PT100, D12, D11, D13, A1); 
+#if RTD_HARDWARE_SPI
+static SPI rtd_spi(D11, D12, D13); // mosi, miso, sclk
+static MAX31865_SPITransport rtd_bus0(&rtd_spi, A6);
+static MAX31865_SPITransport rtd_bus1(&rtd_spi, A4);
+static MAX31865_SPITransport rtd_bus2(&rtd_spi, A3);
+static MAX31865_SPITransport rtd_bus3(&rtd_spi, A0);
+static MAX31865_SPITransport rtd_bus5(&rtd_spi, A5);
+static MAX31865_SPITransport rtd_bus6(&rtd_spi, A2);
+static MAX31865_SPITransport rtd_bus7(&rtd_spi, A1);
+#else
+// One set of bus pins for every chip, a chip select each. A4 and A5 are
+// bridged to SDA and SCL (SB16, SB18), so their chip selects go open-drain
+// and wait for the I2C bus. A7 is USBTX, the console has it, so rtd4 stays
+// off the bus. SCLK is driven through the port registers at 4 MHz.
+static MAX31865_FastBus<D12, D11, D13> rtd_spi; // mosi, miso, sclk
+static MAX31865_BusTransport rtd_bus0(&rtd_spi, rtd_spi.add(A6));
+static MAX31865_BusTransport rtd_bus1(&rtd_spi, rtd_spi.add(A4, &i2c1));
+static MAX31865_BusTransport rtd_bus2(&rtd_spi, rtd_spi.add(A3));
+static MAX31865_BusTransport rtd_bus3(&rtd_spi, rtd_spi.add(A0));
+static MAX31865_BusTransport rtd_bus5(&rtd_spi, rtd_spi.add(A5, &i2c1));
+static MAX31865_BusTransport rtd_bus6(&rtd_spi, rtd_spi.add(A2));
+static MAX31865_BusTransport rtd_bus7(&rtd_spi, rtd_spi.add(A1));
+#endif
+
+MAX31865_RTD rtd0(MAX31865_RTD::RTD_PT100, &rtd_bus0);
+MAX31865_RTD rtd1(MAX31865_RTD::RTD_PT100, &rtd_bus1);  // CS on SDA
+MAX31865_RTD rtd2(MAX31865_RTD::RTD_PT100, &rtd_bus2); 
+MAX31865_RTD rtd3(MAX31865_RTD::RTD_PT100, &rtd_bus3); 
+// MAX31865_RTD rtd4(MAX31865_RTD::RTD_PT100, &rtd_bus4);  // CS on USBTX
+MAX31865_RTD rtd5(MAX31865_RTD::RTD_PT100, &rtd_bus5);  // CS on SCL
+MAX31865_RTD rtd6(MAX31865_RTD::RTD_PT100, &rtd_bus6); 
+MAX31865_RTD rtd7(MAX31865_RTD::RTD_PT100, &rtd_bus7); 
+
+// Callendar-Van Dusen coefficient set of each RTD channel, in sensors[] order.
+static const MAX31865_RTD::rtd_standard rtd_standards[NUM_TEMP_SENSORS] = {
+    MAX31865_RTD::RTD_DIN43760, MAX31865_RTD::RTD_DIN43760, MAX31865_RTD::RTD_DIN43760,
+    MAX31865_RTD::RTD_DIN43760, MAX31865_RTD::RTD_DIN43760, MAX31865_RTD::RTD_DIN43760,
+    MAX31865_RTD::RTD_DIN43760
+};
+
 typedef struct TemperatureSensors {
     uint8_t active_sensors_packed;
     MAX31865_RTD* sensors[7] = {&rtd0, &rtd1, &rtd2, &rtd3, &rtd5, &rtd6, &rtd7}; // TODO: fix this init DONE
     float raw_sensor_vals[NUM_TEMP_SENSORS];
     float temps[NUM_TEMP_SENSORS];
     uint16_t sample_frequency;
+    uint8_t health_check_period;
+    uint8_t samples_since_check[NUM_TEMP_SENSORS];
+    uint8_t format;
+    uint8_t faults[NUM_TEMP_SENSORS];   // Last reported, see rtd_fault()
+    uint8_t next_fault_check;
+    uint8_t converting;     // One-shot round in flight, bit per RTD
+    uint8_t converted;      // Done and not read yet, bit per RTD
+    uint64_t bias_us;       // When the round got Vbias, local time
+    uint64_t converted_us;  // When it was done, local time
+    uint16_t rounds;        // Since the last fault check
 } TemperatureSensors;
 
+// What the cycle is laid out from, see build_schedule().
+typedef struct ScheduleRates {
+    uint8_t rtd_active;         // Bit per RTD
+    uint16_t rtd_frequency;     // Reported samples per second
+    uint8_t rtd_decimation;     // Samples per reported one
+    uint8_t irrad_active;
+    uint16_t irrad_frequency;
+    uint8_t irrad_decimation;
+} ScheduleRates;
+
 IrradianceSensors irradiance_sensors;
 TemperatureSensors temperature_sensors;
+CycleSchedule schedule;
+SamplePacker rtd_packer(&can_tx, CAN_RTD_PACKED, &time_sync);
+SamplePacker irrad_packer(&can_tx, CAN_IRR_PACKED, &time_sync);
+// The most recent samples of every channel, see SampleLog.h.
+SampleLog sample_log(&can_tx, &time_sync);
+// Per channel filter chains, see ChannelFilter.h. Sensors are sampled
+// decimation times faster than their sample frequency; what goes out, live or
+// to the log, is the filter output. Irradiance is filtered in 0.01 W/m^2.
+ChannelFilter rtd_filter;
+ChannelFilter irrad_filter;
+// Report-on-change of the filter output, see ChangeReporter.h: live frames
+// only, the log still gets every sample. Deadbands in 0.01 C and 0.01 W/m^2.
+ChangeReporter rtd_reporter;
+ChangeReporter irrad_reporter;
 
 
 /**
@@ -107,49 +334,135 @@ void event_measure_irradiance_sensors(void);
 void event_measure_temp_sensors(void);
 
 /**
- * @brief Event to process incoming CAN messages.
+ * @brief Event to process every CAN message waiting in can_rx.
  */
 void event_process_can_message(void);
 
+/**
+ * @brief Act on one incoming CAN message.
+ */
+void event_handle_can_message(const CANMessage& message);
+
 /**
  * @brief Event to update the state machine and manage any sensor tickers.
  */
 void event_update_state_machine(void);
 
+void measure_RTD(MAX31865_RTD*, uint8_t);
+
 /**
- * @brief Event to change our state to STATE_ERROR and output via CAN.
+ * @brief Record the MAX31865 fault status of an RTD. Any fault quarantines
+ * the channel: it is no longer sampled, the rest of the board carries on.
+ * A clean status later does not release it, CAN_ACK_FAULT does. Whenever a
+ * channel's fault byte changes, every RTD's goes out on CAN_BB_FAULT:
+ * - [0] FAULT_RTD
+ * - [1..7] per RTD, the MAX31865 fault status bits D7 to D2, bit 1
+ *   MAX31865_FAULT_CYCLE_TIMEOUT, bit 0 RTD_QUARANTINED
  */
-void event_process_error(void);
+void rtd_fault(uint8_t idx, uint8_t status);
 
-void measure_RTD(MAX31865_RTD*, uint8_t);
+/**
+ * @brief Release every quarantined RTD, each from a fresh filter.
+ */
+void release_rtds(void);
+
+/**
+ * @brief Stop the irradiance sensors that are streaming but no longer active
+ * (all of them outside STATE_RUN).
+ */
+void stop_irradiance_sensors(void);
+
+/**
+ * @brief Switch off Vbias on the RTDs of a one-shot round that will not be
+ * collected, e.g. when sampling stops.
+ */
+void stop_rtds(void);
 
-void cycle();
+/**
+ * @brief Reply to CAN_TX_STATS_REQ with one CAN_TX_STATS frame per transmit
+ * priority, optionally clearing the counters after.
+ */
+void event_report_tx_stats(bool clear);
+
+/**
+ * @brief The rates the schedule was last built from: the active sensors,
+ * sample frequencies and decimations in use.
+ */
+ScheduleRates current_rates(void);
+
+/**
+ * @brief Lay out the cycle from rates. Takes over from the next cycle if a
+ * cycle is running. If they do not fit, report FAULT_SCHEDULE and keep the
+ * previous layout; likewise FAULT_IRRAD_RATE if the irradiance sensors would
+ * be sampled faster than their integration time delivers. Only builds: the
+ * caller stores rates once it succeeded.
+ *
+ * @return true If the new layout is in use.
+ */
+bool build_schedule(const ScheduleRates& rates);
+
+void task_heartbeat(uint8_t);
+void task_time_sync(uint8_t);
+void task_measure_rtd(uint8_t idx);
+void task_rtd_fault_check(uint8_t);
+void task_rtd_bias(uint8_t);
+void task_rtd_convert(uint8_t);
+void task_rtd_finish(uint8_t);
+void task_measure_irradiance(uint8_t);
+void task_report_timing(uint8_t);
+void task_log_dump(uint8_t);
 
 int main() {
-    // #ifdef __LOOPBACK__
+    // #if __LOOPBACK__
     //     can.mode(CAN::LocalTest);
     //     printf("CAN Local Test\n");
     // #endif
     if (debug) printf("Begin\n");
+    can.filter(CAN_RX_FILTER_ID, CAN_RX_FILTER_MASK, CANStandard, 0);
+    can_rx.set_clock(callback(&time_sync, &TimeSync::local_us));
+    if (time_sync.master()) {
+        can_tx.attach_tx_complete(callback(&time_sync, &TimeSync::on_tx_complete));
+    }
     led_tracking = 1;
     led_error = 0;
     current_state = STATE_RUN;
     is_error = false;
     set_mode = true;
     ack_fault = false;
-    irradiance_sensors.active_sensors_packed = 1;
+    irradiance_sensors.active_sensors_packed = (1 << NUM_IRRAD_SENSORS) - 1;
     temperature_sensors.active_sensors_packed = 255;
     irradiance_sensors.sample_frequency = 10;
     temperature_sensors.sample_frequency = 2;
+    temperature_sensors.health_check_period = RTD_HEALTH_CHECK_PERIOD;
+    temperature_sensors.format = FORMAT_FLOAT;
+    temperature_sensors.next_fault_check = NUM_TEMP_SENSORS - 1;
+    irradiance_sensors.format = FORMAT_FLOAT;
 
     for (uint8_t idx = 0; idx < NUM_TEMP_SENSORS; ++idx) {
-        temperature_sensors.sensors[idx]->configure( true, true, false, false, MAX31865_FAULT_DETECTION_NONE,
-                true, true, 0x0000, 0x7fff );
+        temperature_sensors.sensors[idx]->set_standard(rtd_standards[idx]);
+        // Vbias and conversions follow the rounds in one-shot mode
+        temperature_sensors.sensors[idx]->configure( !RTD_ONE_SHOT, !RTD_ONE_SHOT, false, false,
+                MAX31865_FAULT_DETECTION_NONE, true, true, 0x0000, 0x7fff );
+    }
+    for (uint8_t idx = 0; idx < NUM_IRRAD_SENSORS; ++idx) {
+        irradiance_sensors.sensors[idx]->setAutoRange(true);
     }
+    build_schedule(current_rates());
+
+    schedule.set_background(event_process_can_message, can_rx.ready());
 
     while (1) {
         event_process_can_message();
-        if (current_state == STATE_RUN) cycle();
+        if (current_state == STATE_RUN) {
+            schedule.run_cycle();
+        } else if (sample_log.dumping()) {
+            // Keep a dump going between commands
+            sample_log.pump();
+            can_rx.ready()->try_acquire_for(LOG_DUMP_PERIOD);
+        } else {
+            // Nothing to do until a command arrives
+            can_rx.ready()->acquire();
+        }
     }
 
 }
@@ -158,79 +471,323 @@ void event_heartbeat(void) {
     led_heartbeat = !led_heartbeat;
     static char counter = 0;
     if (debug) printf("Heartbeat, State: %d\n", current_state);
-    CANMessage message(CAN_HEARTBEAT, &counter, 1);
+    // Counter as before, then whole seconds on the common time base, which
+    // do not wrap every 256 s
+    struct __attribute__((packed)) data {
+        char counter;
+        uint32_t seconds;
+    } data = {
+        .counter = counter,
+        .seconds = (uint32_t)(time_sync.now_us() / 1000000)
+    };
     ++counter;
-    can.write(message);
+    can_tx.write(CANMessage(CAN_HEARTBEAT, (uint8_t*)&data, 5), CanTxQueue::PRIORITY_URGENT);
 }
 
-void cycle() {
-                                                    // Time 0
-    event_heartbeat();                              // Heartbeat
-    measure_RTD(temperature_sensors.sensors[0], 0); // RTD0
-    event_measure_irradiance_sensors();             // Irrad
-    osDelay(62);                                    // Time 62
-    measure_RTD(temperature_sensors.sensors[1], 1); // RTD1
-    osDelay(38);                                    // Time 100
-    event_measure_irradiance_sensors();             // Irrad
-    osDelay(25);                                    // Time 125
-    measure_RTD(temperature_sensors.sensors[2], 2); // RTD2
-    osDelay(62);                                    // Time 187
-    measure_RTD(temperature_sensors.sensors[3], 3); // RTD3
-    osDelay(13);                                    // Time 200
-    event_measure_irradiance_sensors();             // Irrad
-    osDelay(50);                                    // Time 250
-    // measure_RTD(temperature_sensors.sensors[4], 4); // RTD4
-    osDelay(50);                                    // Time 300
-    event_measure_irradiance_sensors();             // Irrad
-    osDelay(12);                                    // Time 312
-    measure_RTD(temperature_sensors.sensors[5], 5); // RTD5
-    osDelay(63);                                    // Time 375
-    measure_RTD(temperature_sensors.sensors[6], 6); // RTD6
-    osDelay(25);                                    // Time 400
-    event_measure_irradiance_sensors();             // Irrad
-    osDelay(37);                                    // Time 437
-    // measure_RTD(temperature_sensors.sensors[7], 7); // RTD7
-    osDelay(63);                                    // Time 500
-    measure_RTD(temperature_sensors.sensors[0], 0); // RTD0
-    event_measure_irradiance_sensors();             // Irrad
-    osDelay(62);                                    // Time 562
-    measure_RTD(temperature_sensors.sensors[1], 1); // RTD1
-    osDelay(38);                                    // Time 600
-    event_measure_irradiance_sensors();             // Irrad
-    osDelay(25);                                    // Time 625
-    measure_RTD(temperature_sensors.sensors[2], 2); // RTD2
-    osDelay(62);                                    // Time 687
-    measure_RTD(temperature_sensors.sensors[3], 3); // RTD3
-    osDelay(13);                                    // Time 700
-    event_measure_irradiance_sensors();             // Irrad
-    osDelay(50);                                    // Time 750
-    // measure_RTD(temperature_sensors.sensors[4], 4); // RTD4
-    osDelay(50);                                    // Time 800
-    event_measure_irradiance_sensors();             // Irrad
-    osDelay(12);                                    // Time 812
-    measure_RTD(temperature_sensors.sensors[5], 5); // RTD5
-    osDelay(63);                                    // Time 875
-    measure_RTD(temperature_sensors.sensors[6], 6); // RTD6
-    osDelay(25);                                    // Time 900
-    event_measure_irradiance_sensors();             // Irrad
-    osDelay(37);                                    // Time 937
-    // measure_RTD(temperature_sensors.sensors[7], 7); // RTD7
-    osDelay(63);                                    // Time 1000
+ScheduleRates current_rates(void) {
+    ScheduleRates rates = {
+        .rtd_active = temperature_sensors.active_sensors_packed,
+        .rtd_frequency = temperature_sensors.sample_frequency,
+        .rtd_decimation = rtd_filter.decimation(),
+        .irrad_active = irradiance_sensors.active_sensors_packed,
+        .irrad_frequency = irradiance_sensors.sample_frequency,
+        .irrad_decimation = irrad_filter.decimation()
+    };
+    return rates;
+}
+
+bool build_schedule(const ScheduleRates& rates) {
+    // A TSL2591 has one result per integration; sampling it faster reads
+    // nothing new on every other call, and the reported rate drops
+    uint32_t integration_ms = 0;
+    for (uint8_t idx = 0; idx < NUM_IRRAD_SENSORS; ++idx) {
+        if (!(rates.irrad_active >> idx & 0x1)) continue;
+        uint32_t ms = (irradiance_sensors.sensors[idx]->getTime() + 1) * 100;
+        if (ms > integration_ms) integration_ms = ms;
+    }
+    if (integration_ms > 0 && (uint32_t)rates.irrad_frequency * rates.irrad_decimation * integration_ms > 1000) {
+        uint8_t fault[2] = {FAULT_IRRAD_RATE, (uint8_t)(1000 / integration_ms)};
+        can_tx.write(CANMessage(CAN_BB_FAULT, fault, 2), CanTxQueue::PRIORITY_URGENT);
+        return false;
+    }
+
+    schedule.clear();
+    schedule.add_task(task_heartbeat, 0, 1, SCHED_HEARTBEAT_US, PRIORITY_HEARTBEAT);
+    if (time_sync.master()) {
+        schedule.add_task(task_time_sync, 0, 1, SCHED_TIME_SYNC_US, PRIORITY_TIME_SYNC);
+    }
+    schedule.add_task(task_report_timing, 0, 1, SCHED_DIAG_US, PRIORITY_DIAG);
+    schedule.add_task(task_log_dump, 0, LOG_DUMP_HZ, SCHED_LOG_DUMP_US, PRIORITY_LOG_DUMP);
+
+    uint8_t active_rtds = 0;
+    for (uint8_t idx = 0; idx < NUM_TEMP_SENSORS; ++idx) {
+        if (rates.rtd_active >> idx & 0x1) ++active_rtds;
+    }
+    uint16_t rtd_rate = rates.rtd_frequency * rates.rtd_decimation;
+    uint32_t rtd_period = rtd_rate > 0 ? CYCLE_PERIOD_US / rtd_rate : CYCLE_PERIOD_US;
+    uint8_t active_irrads = 0;
+    for (uint8_t idx = 0; idx < NUM_IRRAD_SENSORS; ++idx) {
+        if (rates.irrad_active >> idx & 0x1) ++active_irrads;
+    }
+    CycleSchedule::build_result result = CycleSchedule::BUILD_OK;
+    uint32_t reads = 0;     // Into the period
+#if RTD_ONE_SHOT
+    // One round of every active RTD per period: Vbias on, conversions
+    // started once it settled, Vbias off once they are done, then the reads.
+    // Each step but the reads is due within one job of another task, which
+    // may be running when it is released, so the round takes a known time.
+    // The round starts behind the irradiance job released with it: a TSL2591
+    // read that moves about lands either side of the end of an integration.
+    // The build finds out whether a later irradiance job gets in the way.
+    if (active_rtds > 0) {
+        uint32_t blocking = SCHED_IRRAD_US * active_irrads;
+        if (blocking < SCHED_LOG_DUMP_US) blocking = SCHED_LOG_DUMP_US;
+        uint32_t bias = SCHED_IRRAD_US * active_irrads;
+        uint32_t window = blocking + SCHED_RTD_BIAS_US * active_rtds;
+        uint32_t bias_window = SCHED_LOG_DUMP_US + SCHED_RTD_BIAS_US * active_rtds;
+        uint32_t convert = bias + bias_window + RTD_BIAS_SETTLE_US;
+        uint32_t finish = convert + window + RTD_CONVERSION_US;
+        uint32_t finish_us = SCHED_RTD_BIAS_US * active_rtds + SCHED_RTD_FAULT_US;
+        reads = finish + blocking + finish_us;
+        if (rtd_period < reads + RTD_READ_GAP_US * (active_rtds - 1) + SCHED_RTD_US) {
+            result = CycleSchedule::BUILD_DEADLINE_MISSED;
+        }
+        schedule.add_task(task_rtd_bias, 0, rtd_rate, SCHED_RTD_BIAS_US * active_rtds, PRIORITY_RTD, bias,
+                          bias_window);
+        schedule.add_task(task_rtd_convert, 0, rtd_rate, SCHED_RTD_BIAS_US * active_rtds, PRIORITY_RTD,
+                          convert, window);
+        schedule.add_task(task_rtd_finish, 0, rtd_rate, finish_us, PRIORITY_RTD, finish, reads - finish);
+    }
+#endif
+    uint8_t nth = 0;
+    for (uint8_t idx = 0; idx < NUM_TEMP_SENSORS; ++idx) {
+        if (!(rates.rtd_active >> idx & 0x1)) continue;
+#if RTD_ONE_SHOT
+        // Read before the next round converts
+        uint32_t phase = reads + RTD_READ_GAP_US * nth++;
+        schedule.add_task(task_measure_rtd, idx, rtd_rate, SCHED_RTD_US, PRIORITY_RTD, phase, rtd_period - phase);
+#else
+        // Spread evenly over their period
+        schedule.add_task(task_measure_rtd, idx, rtd_rate, SCHED_RTD_US, PRIORITY_RTD,
+                          rtd_period * nth++ / active_rtds);
+#endif
+    }
+#if !RTD_ONE_SHOT
+    if (active_rtds > 0) {
+        schedule.add_task(task_rtd_fault_check, 0, RTD_FAULT_CHECK_HZ, SCHED_RTD_FAULT_US, PRIORITY_RTD_FAULT);
+    }
+#endif
+
+    if (active_irrads > 0) {
+        schedule.add_task(task_measure_irradiance, 0,
+                          rates.irrad_frequency * rates.irrad_decimation,
+                          SCHED_IRRAD_US * active_irrads, PRIORITY_IRRAD);
+    }
+
+    if (result == CycleSchedule::BUILD_OK) result = schedule.build();
+    if (debug) printf("Schedule: %d slots, load %lu ppm, result %d\n", schedule.slots(),
+                      (unsigned long)schedule.load_ppm(), result);
+    if (result != CycleSchedule::BUILD_OK) {
+        // Report, but keep sampling on the previous layout
+        uint8_t fault[2] = {FAULT_SCHEDULE, (uint8_t)result};
+        can_tx.write(CANMessage(CAN_BB_FAULT, fault, 2), CanTxQueue::PRIORITY_URGENT);
+        return false;
+    }
+    return true;
+}
+
+void task_heartbeat(uint8_t) {
+    event_heartbeat();
+}
+
+void task_time_sync(uint8_t) {
+    time_sync.send_sync();
+}
+
+void task_measure_rtd(uint8_t idx) {
+    measure_RTD(temperature_sensors.sensors[idx], idx);
+}
+
+void task_rtd_bias(uint8_t) {
+    uint8_t round = 0;
+    for (uint8_t idx = 0; idx < NUM_TEMP_SENSORS; ++idx) {
+        if (!(temperature_sensors.active_sensors_packed >> idx & 0x1)) continue;
+        if (temperature_sensors.faults[idx] & RTD_QUARANTINED) continue;
+        temperature_sensors.sensors[idx]->bias(true);
+        round |= 1 << idx;
+    }
+    temperature_sensors.converting = round;
+    temperature_sensors.bias_us = time_sync.local_us();
+}
+
+void task_rtd_convert(uint8_t) {
+    // Released RTD_BIAS_SETTLE_US after the bias is due; a guard all the same
+    uint64_t settled = time_sync.local_us() - temperature_sensors.bias_us;
+    if (settled < RTD_BIAS_SETTLE_US) wait_us(RTD_BIAS_SETTLE_US - settled);
+    for (uint8_t idx = 0; idx < NUM_TEMP_SENSORS; ++idx) {
+        if (temperature_sensors.converting >> idx & 0x1) temperature_sensors.sensors[idx]->start_conversion();
+    }
+}
+
+void task_rtd_finish(uint8_t) {
+    uint8_t converted = 0;
+    for (uint8_t idx = 0; idx < NUM_TEMP_SENSORS; ++idx) {
+        if (!(temperature_sensors.converting >> idx & 0x1)) continue;
+        uint8_t status = temperature_sensors.sensors[idx]->finish_conversion();
+        if (status != 0) {
+            rtd_fault(idx, status);
+        } else {
+            converted |= 1 << idx;
+        }
+    }
+    temperature_sensors.converting = 0;
+    temperature_sensors.converted = converted;
+    temperature_sensors.converted_us = time_sync.local_us();
+    // Once a second, with every chip idle
+    uint16_t rounds = temperature_sensors.sample_frequency * rtd_filter.decimation() / RTD_FAULT_CHECK_HZ;
+    if (++temperature_sensors.rounds >= rounds) {
+        temperature_sensors.rounds = 0;
+        task_rtd_fault_check(0);
+    }
+}
+
+void stop_rtds(void) {
+    for (uint8_t idx = 0; idx < NUM_TEMP_SENSORS; ++idx) {
+        if (temperature_sensors.converting >> idx & 0x1) temperature_sensors.sensors[idx]->bias(false);
+    }
+    temperature_sensors.converting = 0;
+    temperature_sensors.converted = 0;
+}
+
+void task_rtd_fault_check(uint8_t) {
+    // First read back the registers of one RTD that read zero since, off the
+    // sample slots; only those the chip lost are written again
+    for (uint8_t i = 0; i < NUM_TEMP_SENSORS; ++i) {
+        if ((temperature_sensors.active_sensors_packed >> i & 0x1) && temperature_sensors.sensors[i]->verify_pending()) {
+            temperature_sensors.sensors[i]->verify();
+            break;
+        }
+    }
+
+    // Next active RTD after the last one checked, quarantined or not
+    uint8_t& idx = temperature_sensors.next_fault_check;
+    for (uint8_t n = 0; n < NUM_TEMP_SENSORS; ++n) {
+        idx = (idx + 1) % NUM_TEMP_SENSORS;
+        if (temperature_sensors.active_sensors_packed >> idx & 0x1) {
+            rtd_fault(idx, temperature_sensors.sensors[idx]->detect_faults());
+            return;
+        }
+    }
+}
+
+void task_measure_irradiance(uint8_t) {
+    event_measure_irradiance_sensors();
+}
+
+void task_log_dump(uint8_t) {
+    sample_log.pump();
+}
+
+static uint16_t saturate_u16(uint32_t value) {
+    return value > 0xFFFF ? 0xFFFF : value;
+}
+
+static int16_t saturate_i16(int32_t value) {
+    return value > 0x7FFF ? 0x7FFF : (value < -0x8000 ? -0x8000 : value);
+}
+
+void task_report_timing(uint8_t) {
+    /**
+     * @brief Every SCHED_DIAG_CYCLES cycles, report how well the cycle kept
+     * time since the last report, then start over. Values saturate.
+     * - [0..1] int16 mean cycle period minus 1 s, us (drift per cycle)
+     * - [2..3] uint16 longest minus shortest cycle period, us (jitter)
+     * - [4..5] uint16 latest slot start behind its tick, us
+     * - [6..7] uint16 mean slot start behind its tick, us
+     */
+    if (schedule.timing().cycles < SCHED_DIAG_CYCLES) return;
+    struct __attribute__((packed)) data {
+        int16_t period_error_us;
+        uint16_t period_jitter_us;
+        uint16_t late_max_us;
+        uint16_t late_mean_us;
+    } data = {
+        .period_error_us = saturate_i16(schedule.period_error_us()),
+        .period_jitter_us = saturate_u16(schedule.period_jitter_us()),
+        .late_max_us = saturate_u16(schedule.timing().late_max_us),
+        .late_mean_us = saturate_u16(schedule.mean_late_us())
+    };
+    if (debug) printf("Cycle: drift %d us, jitter %u us, late max %u us\n",
+                      data.period_error_us, data.period_jitter_us, data.late_max_us);
+    can_tx.write(CANMessage(CAN_SCHED_DIAG, (uint8_t*)&data, 8), CanTxQueue::PRIORITY_BULK);
+    schedule.reset_timing();
 }
 
 void measure_RTD(MAX31865_RTD* sensor, uint8_t idx) {
-    float tempbuffer;
-    float temperature;
-    if (temperature_sensors.active_sensors_packed >> idx & 0x1) {
-        sensor->read_all();
-        tempbuffer = sensor->temperature();
-        if(tempbuffer > -300.0 && tempbuffer < 150000.0){
-            temperature = tempbuffer;
+    float temperature = 0.0f;
+    int32_t centi = INT32_MIN;
+    uint64_t taken_us = 0;
+    bool ready = false;
+    bool sampled = (temperature_sensors.active_sensors_packed >> idx & 0x1)
+        && !(temperature_sensors.faults[idx] & RTD_QUARANTINED);
+#if RTD_ONE_SHOT
+    // Only RTDs that converted this round, once
+    sampled = sampled && (temperature_sensors.converted >> idx & 0x1);
+    temperature_sensors.converted &= ~(1 << idx);
+#endif
+    if (sampled) {
+        // Full register dump on the health check cadence, resistance only
+        // otherwise. A fault flagged in the resistance registers gets a dump
+        // either way.
+        uint8_t& samples = temperature_sensors.samples_since_check[idx];
+        uint8_t status;
+        if (samples == 0) {
+            status = sensor->read_all();
+        } else {
+            status = sensor->read_resistance();
+        }
+#if RTD_ONE_SHOT
+        taken_us = temperature_sensors.converted_us;
+#else
+        taken_us = time_sync.local_us();
+#endif
+        if (++samples >= temperature_sensors.health_check_period) samples = 0;
+        if (status != 0) rtd_fault(idx, status);
+        sampled = status == 0;
+    }
+    if (sampled) {
+        // Table lookup in fixed point, see MAX31865_CVDTable.h.
+        centi = sensor->temperature_centi();
+        // Spike rejection and smoothing; while decimating, most samples
+        // only feed the filter.
+        ready = rtd_filter.add(idx, centi, &centi);
+        if (ready) {
+            // Nothing to log or report outside this range
+            temperature = centi / 100.0f;
+            ready = temperature > -300.0 && temperature < 150000.0;
+        }
+        if (ready) {
+            if (debug) printf("Sensor %d: %f C\n", idx, temperature);
+            sample_log.add(idx, centi, taken_us);
         }
-        if (debug) printf("Sensor %d: %f C\n", idx, temperature);
     }
 
-    struct data {
+    if (temperature_sensors.format == FORMAT_LOG) return;
+    if (temperature_sensors.format == FORMAT_PACKED) {
+        // A reading that does not fit is left out of the round, and so is
+        // one within the deadband
+        if (ready && centi >= INT16_MIN && centi <= INT16_MAX && rtd_reporter.due(idx, centi, taken_us)) {
+            rtd_packer.add(idx, centi, taken_us);
+            rtd_reporter.reported(idx, centi, taken_us);
+        }
+        // Send the rest of the round after its last active RTD
+        uint8_t active = temperature_sensors.active_sensors_packed & ((1 << NUM_TEMP_SENSORS) - 1);
+        if (active >> (idx + 1) == 0) rtd_packer.next_round();
+        return;
+    }
+    if (!ready || !rtd_reporter.due(idx, centi, taken_us)) return;
+
+    struct __attribute__((packed)) data {
         uint8_t idx;
         float value;
     } data = {
@@ -238,71 +795,160 @@ void measure_RTD(MAX31865_RTD* sensor, uint8_t idx) {
         .value = temperature
     };
 
-    if (can.write(CANMessage(CAN_RTD_MEAS, (uint8_t*) &data, 5))) {
-        #ifdef __LOOPBACK__
+    if (can_tx.write(CANMessage(CAN_RTD_MEAS, (uint8_t*) &data, 5))) {
+        can_tx.write(time_sync.sample_time(CAN_RTD_MEAS, idx, taken_us));
+        rtd_reporter.reported(idx, centi, taken_us);
+        // The loopback frame comes back through can_rx and is handled
+        // between slots like any other command
+        #if __LOOPBACK__
             printf("Temperature message sent by %i\n", idx);
-            event_process_can_message();
         #endif
     }
 }
 
+static void report_rtd_faults(void) {
+    uint8_t data[1 + NUM_TEMP_SENSORS] = {FAULT_RTD};
+    memcpy(&data[1], temperature_sensors.faults, NUM_TEMP_SENSORS);
+    can_tx.write(CANMessage(CAN_BB_FAULT, data, sizeof(data)), CanTxQueue::PRIORITY_URGENT);
+}
+
+void rtd_fault(uint8_t idx, uint8_t status) {
+    uint8_t fault = status & ~RTD_QUARANTINED;
+    if (status != 0 || (temperature_sensors.faults[idx] & RTD_QUARANTINED)) fault |= RTD_QUARANTINED;
+    if (fault == temperature_sensors.faults[idx]) return;
+    temperature_sensors.faults[idx] = fault;
+    if (debug) printf("RTD %d fault 0x%02x\n", idx, fault);
+    report_rtd_faults();
+}
+
+void release_rtds(void) {
+    bool released = false;
+    for (uint8_t idx = 0; idx < NUM_TEMP_SENSORS; ++idx) {
+        if (!(temperature_sensors.faults[idx] & RTD_QUARANTINED)) continue;
+        // Back on the next sample, from a fresh filter and a full register
+        // dump. If the fault is still there, that read or the next fault
+        // check puts it back in quarantine.
+        temperature_sensors.faults[idx] = 0;
+        temperature_sensors.samples_since_check[idx] = 0;
+        rtd_filter.reset(idx);
+        rtd_reporter.reset(idx);
+        released = true;
+    }
+    if (released) report_rtd_faults();
+}
+
 void event_measure_irradiance_sensors(void) {
     /**
-     * @brief For every active sensor in active_sensors_packed, perform the
-     * measurement and load into a buffer.
+     * @brief For every active sensor in active_sensors_packed, collect the
+     * newest integration if one has finished since the last call. Sensors
+     * stream back to back, so there is no power-on or warm-up per sample, and
+     * the rest of the cycle runs while they integrate. Behind the mux every
+     * sensor integrates at once and only the harvest goes channel by channel,
+     * so a round of all of them takes one integration time, not eight.
      * 
-     * Then convert the value into a calibrated W/m^2 and post on CAN.
+     * Then convert the value into a calibrated W/m^2, filter the round of
+     * every sensor in one pass and post what the filters output on CAN.
      */
      if (debug) printf("Measure Irrad\n");
+    int32_t centi[FILTER_CHANNELS];
+    uint64_t taken_us[NUM_IRRAD_SENSORS] = {0};
+    uint8_t round = 0;
     for (uint8_t idx = 0; idx < NUM_IRRAD_SENSORS; ++idx) {
         // Sensor is active if the bit associated with the idx is 1
         if (irradiance_sensors.active_sensors_packed >> idx & 0x1) {
-            // TODO: Measure sensor DONE
-            irrad.getALS();
-            irrad.calcLux();
-            uint16_t ch0counts = irrad.full;
-            uint16_t ch1counts = irrad.ir;
+            TSL2591* sensor = irradiance_sensors.sensors[idx];
+            if (!sensor->continuous()) {
+                sensor->startContinuousALS();
+                continue;
+            }
+            // Still integrating, pick it up on the next call.
+            if (!sensor->readALS()) continue;
+            taken_us[idx] = time_sync.local_us();
+            // A clipped reading only bounds the light from below; auto range
+            // has already stepped down, so wait for the next one.
+            if (sensor->saturated) continue;
+            sensor->calcLux();
 
             // This particular metric comes from Re, Irradiance responsivity
-            // from Figure TSL2591 – 9. 
-            double ch0irradiance = (double) ch0counts / 6024; // uW/cm^2
-            double ch1irradiance = (double) ch1counts / 1003; // uW/cm^2
+            // from Figure TSL2591 – 9, at 1x gain and 100 ms. Counts are
+            // normalized per (gain x ms) since auto range moves both.
+            double ch0irradiance = sensor->fullRate * 100 / 6024; // uW/cm^2
+            double ch1irradiance = sensor->irRate * 100 / 1003; // uW/cm^2
             double avgIrradiance = (ch0irradiance + ch1irradiance) / 2; // uW/cm^2
             avgIrradiance *= 1000.0; // 1000 uW/cm^2
             avgIrradiance /= 100.0;  // 1000 W/m^2
-            float irradiance = avgIrradiance;
-
-            // TODO: Preprocess data and filter DONE
-            struct data {
-                uint8_t idx;
-                float value;
-            } data = {
-                .idx = 0,
-                .value = irradiance
-            };
+            centi[idx] = (int32_t)(avgIrradiance * 100.0 + 0.5);
+            round |= 1 << idx;
             if (debug) printf("\tCH0: %.3f w/m^2\tCH1: %.3f w/m^2\n", ch0irradiance, ch1irradiance);
-            // Output on CAN
-            if (can.write(CANMessage(CAN_IRR_MEAS, (uint8_t*)&data, 5))) {
-                #ifdef __LOOPBACK__
-                    printf("Irradiance message sent by %i\n", idx);
-                    event_process_can_message();
-                #endif
+        }
+    }
+
+    // Spike rejection and smoothing; while decimating, most rounds only
+    // feed the filters.
+    int32_t filtered[FILTER_CHANNELS];
+    uint8_t ready = irrad_filter.add_round(centi, round, filtered);
+    for (uint8_t idx = 0; idx < NUM_IRRAD_SENSORS; ++idx) {
+        if (!(ready >> idx & 0x1)) continue;
+        float irradiance = filtered[idx] / 100.0f;
+        int32_t deci = (filtered[idx] + 5) / 10;
+        sample_log.add(SAMPLE_LOG_IRRAD | idx, deci, taken_us[idx]);
+
+        if (irradiance_sensors.format == FORMAT_LOG) continue;
+        if (!irrad_reporter.due(idx, filtered[idx], taken_us[idx])) continue;
+        if (irradiance_sensors.format == FORMAT_PACKED) {
+            if (deci <= INT16_MAX) {
+                irrad_packer.add(idx, deci, taken_us[idx]);
+                irrad_reporter.reported(idx, filtered[idx], taken_us[idx]);
             }
+            continue;
+        }
+
+        struct __attribute__((packed)) data {
+            uint8_t idx;
+            float value;
+        } data = {
+            .idx = idx,
+            .value = irradiance
+        };
+        // Output on CAN
+        if (can_tx.write(CANMessage(CAN_IRR_MEAS, (uint8_t*)&data, 5))) {
+            can_tx.write(time_sync.sample_time(CAN_IRR_MEAS, idx, taken_us[idx]));
+            irrad_reporter.reported(idx, filtered[idx], taken_us[idx]);
+            #if __LOOPBACK__
+                printf("Irradiance message sent by %i\n", idx);
+            #endif
         }
     }
+    // Whatever is left of this round
+    irrad_packer.next_round();
 }
 
-void event_process_can_message(void) {
-    // Read message
-    if (debug) {
-        printf("CAN Receive\n");
+void stop_irradiance_sensors(void) {
+    for (uint8_t idx = 0; idx < NUM_IRRAD_SENSORS; ++idx) {
+        bool active = current_state == STATE_RUN
+            && (irradiance_sensors.active_sensors_packed >> idx & 0x1);
+        if (!active && irradiance_sensors.sensors[idx]->busy()) {
+            irradiance_sensors.sensors[idx]->stopALS();
+        }
     }
+}
+
+void event_process_can_message(void) {
     CANMessage message;
-    if (can.read(message, 0)) {
-        #ifdef __LOOPBACK__
+    uint64_t stamp;
+    while (can_rx.read(message, &stamp)) {
+        if (time_sync.handle(message, stamp)) continue;
+        if (debug) {
+            printf("CAN Receive\n");
+        }
+        #if __LOOPBACK__
             printf("Message Recieved: ID %i, %d\n", message.id, message.data[0]);
         #endif
+        event_handle_can_message(message);
     }
+}
+
+void event_handle_can_message(const CANMessage& message) {
     uint32_t can_id = message.id;
     switch (can_id) {
         case CAN_SET_MODE:
@@ -318,21 +964,108 @@ void event_process_can_message(void) {
             // TODO: ack fault and exit error state. DONE
             if (message.data[0] == 0x01) {
                 ack_fault = true;
+                release_rtds();
             } else {
                 ack_fault = false;
             }
             event_update_state_machine();
             break;
-        case CAN_RTD_CONF:
-            // TODO: Adjust ticker period, active sensors. DONE
-            temperature_sensors.active_sensors_packed = message.data[0];
-            temperature_sensors.sample_frequency = message.data[1]*8 + message.data[2];
+        case CAN_RTD_CONF: {
+            // Retime from the next cycle; sampling does not stop. A command
+            // whose rates do not fit is reported and none of it applied.
+            ScheduleRates rates = current_rates();
+            rates.rtd_active = message.data[0];
+            rates.rtd_frequency = message.data[1] << 8 | message.data[2];
+            uint8_t health_check_period = temperature_sensors.health_check_period;
+            if (message.len > 3 && message.data[3] > 0) {
+                health_check_period = message.data[3];
+            }
+            uint8_t format = temperature_sensors.format;
+            if (message.len > 4) {
+                format = message.data[4] <= FORMAT_LOG ? (uint8_t)message.data[4] : (uint8_t)FORMAT_FLOAT;
+            }
+            // Optional deadband (0.01 C, 0 off) and keep-alive (s, 0 for the
+            // default); every RTD reports its next sample.
+            ChangeReporter::config report = rtd_reporter.configuration();
+            if (message.len > 6) {
+                report.deadband = message.data[5] << 8 | message.data[6];
+                if (message.len > 7) report.max_silence_s = message.data[7];
+            }
+            if (!build_schedule(rates)) break;
+            temperature_sensors.active_sensors_packed = rates.rtd_active;
+            temperature_sensors.sample_frequency = rates.rtd_frequency;
+            temperature_sensors.health_check_period = health_check_period;
+            temperature_sensors.format = format;
+            if (message.len > 6) rtd_reporter.configure(report);
             break;
-        case CAN_IRR_CONF:
-            // TODO: Adjust ticker period, active sensors. DONE
-            irradiance_sensors.active_sensors_packed = message.data[0];
-            irradiance_sensors.sample_frequency = message.data[1]*8 + message.data[2];
+        }
+        case CAN_IRR_CONF: {
+            ScheduleRates rates = current_rates();
+            rates.irrad_active = message.data[0];
+            rates.irrad_frequency = message.data[1] << 8 | message.data[2];
+            uint8_t format = irradiance_sensors.format;
+            if (message.len > 3) {
+                format = message.data[3] <= FORMAT_LOG ? (uint8_t)message.data[3] : (uint8_t)FORMAT_FLOAT;
+            }
+            // Optional deadband (0.01 W/m^2) and keep-alive, as in RTD_CONF
+            ChangeReporter::config report = irrad_reporter.configuration();
+            if (message.len > 5) {
+                report.deadband = message.data[4] << 8 | message.data[5];
+                if (message.len > 6) report.max_silence_s = message.data[6];
+            }
+            if (!build_schedule(rates)) break;
+            irradiance_sensors.active_sensors_packed = rates.irrad_active;
+            irradiance_sensors.sample_frequency = rates.irrad_frequency;
+            irradiance_sensors.format = format;
+            if (message.len > 5) irrad_reporter.configure(report);
+            // Power down sensors that were just deactivated.
+            stop_irradiance_sensors();
             break;
+        }
+        case CAN_TX_STATS_REQ:
+            event_report_tx_stats(message.len > 0 && (message.data[0] & 0x01));
+            break;
+        case CAN_LOG_DUMP_REQ:
+            if (message.len >= 8) {
+                uint32_t from_ms;
+                uint32_t to_ms;
+                memcpy(&from_ms, &message.data[0], 4);
+                memcpy(&to_ms, &message.data[4], 4);
+                sample_log.start_dump(from_ms, to_ms);
+                // Get past the oldest records before the next sample
+                // overwrites them
+                sample_log.pump();
+            } else {
+                sample_log.cancel_dump();
+            }
+            break;
+        case CAN_FILTER_CONF: {
+            // [0] 0 RTDs, 1 irradiance, [1] median, [2] mode, [3] ema_shift,
+            // [4] decimation. Filter history restarts; decimation retimes the
+            // sampling from the next cycle at the same reported rate.
+            if (message.len < 5 || message.data[0] > 1) break;
+            ChannelFilter& filter = message.data[0] == 0 ? rtd_filter : irrad_filter;
+            ChannelFilter::config conf = {
+                .median = message.data[1],
+                .mode = message.data[2],
+                .ema_shift = message.data[3],
+                .decimation = message.data[4]
+            };
+            if (!ChannelFilter::valid(conf)) {
+                uint8_t fault[2] = {FAULT_FILTER, message.data[0]};
+                can_tx.write(CANMessage(CAN_BB_FAULT, fault, 2), CanTxQueue::PRIORITY_URGENT);
+                break;
+            }
+            // Histories only restart once the new decimation fits
+            ScheduleRates rates = current_rates();
+            if (message.data[0] == 0) {
+                rates.rtd_decimation = conf.decimation;
+            } else {
+                rates.irrad_decimation = conf.decimation;
+            }
+            if (build_schedule(rates)) filter.configure(conf);
+            break;
+        }
         default:
             // Ignore any other CAN messages.
             break;
@@ -363,6 +1096,9 @@ void event_update_state_machine(void) {
             // Turn off tracking LED
             // Turn off error LED
             // Disable measurement tasks
+            schedule.abort_cycle();
+            stop_irradiance_sensors();
+            stop_rtds();
             led_tracking = 0;
             led_error = 0;
             break;
@@ -377,19 +1113,30 @@ void event_update_state_machine(void) {
             // Turn on error LED
             // Turn off tracking LED
             // Disable measurement tasks
+            schedule.abort_cycle();
+            stop_irradiance_sensors();
+            stop_rtds();
             led_error = 1;
             led_tracking = 0;
             break;
     }
 }
 
-void event_process_error(void) {
-    // figure out what error
-    // output on CAN
-    uint16_t error = 0; // TODO: error class
-    can.write(CANMessage(CAN_BB_FAULT, (uint8_t*)&error, 2));
-
-    // update state machine
-    is_error = true;
-    event_update_state_machine();
+void event_report_tx_stats(bool clear) {
+    for (uint8_t prio = 0; prio < CanTxQueue::PRIORITY_COUNT; ++prio) {
+        const CanTxQueue::stats& stats = can_tx.statistics((CanTxQueue::priority)prio);
+        struct __attribute__((packed)) data {
+            uint8_t priority;
+            uint8_t high_water;
+            uint16_t dropped;
+            uint32_t sent;
+        } data = {
+            .priority = prio,
+            .high_water = stats.high_water,
+            .dropped = saturate_u16(stats.dropped),
+            .sent = stats.sent
+        };
+        can_tx.write(CANMessage(CAN_TX_STATS, (uint8_t*)&data, 8));
+    }
+    if (clear) can_tx.reset_stats();
 }
\ No newline at end of file
@@ -29,6 +29,7 @@
  */
 #include "mbed.h"
 #include "MAX31865_BitBangEnabled.h"  //RTD Sensor
+#include "MAX31865_Bus.h"
 
 #include "TSL2591.hpp"  
 #include <cstdio>
@@ -73,17 +74,28 @@ typedef struct IrradianceSensors {
     uint16_t sample_frequency;
 } IrradianceSensors;
 
-MAX31865_RTD rtd0(MAX31865_RTD::RTD_PT100, D12, D11, D13, A6);
-MAX31865_RTD rtd1(MAX31865_RTD::RTD_PT100, D12, D11, D13, A4);  
-MAX31865_RTD rtd2(MAX31865_RTD::RTD_PT100, D12, D11, D13, A3); 
-MAX31865_RTD rtd3(MAX31865_RTD::RTD_PT100, D12, D11, D13, A0); 
-MAX31865_RTD rtd4(MAX31865_RTD::RTD_PT100, D12, D11, D13, A7); 
-MAX31865_RTD rtd5(MAX31865_RTD::RTD_PT100, D12, D11, D13, A5); 
-MAX31865_RTD rtd6(MAX31865_RTD::RTD_PT100, D12, D11, D13, A2); 
-MAX31865_RTD rtd7(MAX31865_RTD::RTD_PT100, D12, D11, D13, A1); 
+// One bus for all RTDs, see MAX31865_Bus.h. A4 and A5 share SDA and SCL;
+// A7 is USBTX, refused, so rtd4 reads 0xFF and is skipped.
+static MAX31865_Bus rtd_spi(D12, D11, D13); // mosi, miso, sclk
+static MAX31865_BusTransport rtd_bus0(&rtd_spi, rtd_spi.add(A6));
+static MAX31865_BusTransport rtd_bus1(&rtd_spi, rtd_spi.add(A4, &i2c1));
+static MAX31865_BusTransport rtd_bus2(&rtd_spi, rtd_spi.add(A3));
+static MAX31865_BusTransport rtd_bus3(&rtd_spi, rtd_spi.add(A0));
+static MAX31865_BusTransport rtd_bus4(&rtd_spi, rtd_spi.add(A7));
+static MAX31865_BusTransport rtd_bus5(&rtd_spi, rtd_spi.add(A5, &i2c1));
+static MAX31865_BusTransport rtd_bus6(&rtd_spi, rtd_spi.add(A2));
+static MAX31865_BusTransport rtd_bus7(&rtd_spi, rtd_spi.add(A1));
+MAX31865_RTD rtd0(MAX31865_RTD::RTD_PT100, &rtd_bus0);
+MAX31865_RTD rtd1(MAX31865_RTD::RTD_PT100, &rtd_bus1);  
+MAX31865_RTD rtd2(MAX31865_RTD::RTD_PT100, &rtd_bus2); 
+MAX31865_RTD rtd3(MAX31865_RTD::RTD_PT100, &rtd_bus3); 
+MAX31865_RTD rtd4(MAX31865_RTD::RTD_PT100, &rtd_bus4); 
+MAX31865_RTD rtd5(MAX31865_RTD::RTD_PT100, &rtd_bus5); 
+MAX31865_RTD rtd6(MAX31865_RTD::RTD_PT100, &rtd_bus6); 
+MAX31865_RTD rtd7(MAX31865_RTD::RTD_PT100, &rtd_bus7); 
 typedef struct TemperatureSensors {
     uint8_t active_sensors_packed;
-    MAX31865_RTD sensors[8] = {rtd0, rtd1, rtd2, rtd3, rtd4, rtd5, rtd6, rtd7}; // TODO: fix this init
+    MAX31865_RTD* sensors[8] = {&rtd0, &rtd1, &rtd2, &rtd3, &rtd4, &rtd5, &rtd6, &rtd7};
     uint16_t raw_sensor_vals[NUM_TEMP_SENSORS];
     uint16_t sample_frequency;
     //TemperatureSensors();
@@ -159,8 +171,8 @@ int main() {
     irradiance_sensors.sample_frequency = 10;
     temperature_sensors.sample_frequency = 2;
 
-    for (MAX31865_RTD sensor : temperature_sensors.sensors) {
-        sensor.configure( true, true, false, false, MAX31865_FAULT_DETECTION_NONE,
+    for (MAX31865_RTD* sensor : temperature_sensors.sensors) {
+        sensor->configure( true, true, false, false, MAX31865_FAULT_DETECTION_NONE,
                    true, true, 0x0000, 0x7fff );
     }
 
@@ -245,9 +257,9 @@ void event_measure_temp_sensors(void) {
         if (temperature_sensors.active_sensors_packed >> idx & 0x1) {
             // TODO: Measure sensor
             
-            if (temperature_sensors.sensors[idx].status() == 0) {
-                temperature_sensors.sensors[idx].read_all();
-                float tempbuffer = temperature_sensors.sensors[idx].temperature();
+            if (temperature_sensors.sensors[idx]->status() == 0) {
+                temperature_sensors.sensors[idx]->read_all();
+                float tempbuffer = temperature_sensors.sensors[idx]->temperature();
                 if(tempbuffer > -10.0 && tempbuffer < 150000.0){
                     temperature = tempbuffer;
                 }
@@ -0,0 +1,54 @@
+/**
+ * @file can_rx_queue.cpp
+ * @brief Receive ring behind the three deep bxCAN FIFO.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#include "can_rx_queue.hpp"
+#include <cstring>
+
+CanRxQueue::CanRxQueue(IsrCAN* can, Callback<void()> notify): _can(can), _notify(notify), _head(0), _tail(0) {
+    memset(&_stats, 0, sizeof(_stats));
+    _can->attach(callback(this, &CanRxQueue::handler_rx), CAN::RxIrq);
+}
+
+bool CanRxQueue::read(CANMessage& msg, uint64_t* stamp) {
+    uint8_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail == _head.load(std::memory_order_acquire)) return false;
+    msg = _ring[tail % CAN_RX_DEPTH];
+    if (stamp) *stamp = _stamp[tail % CAN_RX_DEPTH];
+    // Hand the slot back to the interrupt only once it is copied out.
+    _tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+void CanRxQueue::reset_stats(void) {
+    CriticalSectionLock lock;
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+void CanRxQueue::handler_rx(void) {
+    // The interrupt follows the end of the frame that raised it.
+    uint64_t now = _clock ? _clock() : 0;
+    uint8_t head = _head.load(std::memory_order_relaxed);
+    bool was_empty = head == _tail.load(std::memory_order_acquire);
+    bool queued = false;
+    CANMessage msg;
+    // Empty the FIFO; each read releases one of its three slots.
+    while (_can->read(msg)) {
+        _stats.received++;
+        uint8_t waiting = head - _tail.load(std::memory_order_acquire);
+        if (waiting >= CAN_RX_DEPTH) {
+            _stats.dropped++;
+            continue;
+        }
+        _ring[head % CAN_RX_DEPTH] = msg;
+        _stamp[head % CAN_RX_DEPTH] = now;
+        head++;
+        _head.store(head, std::memory_order_release);
+        queued = true;
+        if (waiting + 1 > _stats.high_water) _stats.high_water = waiting + 1;
+    }
+    // A reader already draining picks the new frames up itself.
+    if (queued && was_empty && _notify) _notify();
+}
@@ -0,0 +1,89 @@
+/**
+ * @file can_rx_queue.hpp
+ * @brief Receive ring behind the three deep bxCAN FIFO.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note The RX interrupt empties the hardware FIFO into the ring and calls
+ * notify once the ring stops being empty. The interrupt only writes the head
+ * and the reader only writes the tail, so neither side masks interrupts. A
+ * full ring drops the new frame and counts it.
+ */
+#pragma once
+#include "mbed.h"
+#include "can_tx_queue.hpp"
+#include <atomic>
+#include <cstdint>
+
+/** Frames, a power of 2. */
+#define CAN_RX_DEPTH    (16)
+
+class CanRxQueue
+{
+    public:
+        /**
+         * @brief Counters since construction or the last reset_stats().
+         */
+        struct Stats {
+            uint32_t received;      // Frames taken from the controller.
+            uint32_t dropped;       // Frames lost because the ring was full.
+            uint8_t high_water;     // Most frames waiting at once.
+        };
+
+        /**
+         * @brief Construct a new queue and take over the RX interrupt of the
+         * controller.
+         *
+         * @param can Controller to receive on, read from interrupt context.
+         * @param notify Called from the RX interrupt when frames arrive in
+         * an empty ring, e.g. to post an event that drains it.
+         */
+        CanRxQueue(IsrCAN* can, Callback<void()> notify);
+
+        /**
+         * @brief Take the oldest frame. One reader only.
+         *
+         * @param msg Frame read.
+         * @param stamp If given, the clock set with set_clock() when the
+         * frame was taken from the controller.
+         * @return true If a frame was waiting.
+         * @return false If the ring is empty; not an error.
+         */
+        bool read(CANMessage& msg, uint64_t* stamp = nullptr);
+
+        /**
+         * @brief Stamp incoming frames with clock, read in the RX interrupt.
+         */
+        void set_clock(Callback<uint64_t()> clock) { _clock = clock; }
+
+        /**
+         * @brief Counters.
+         */
+        const Stats& stats(void) const { return _stats; }
+
+        /**
+         * @brief Zero every counter.
+         */
+        void reset_stats(void);
+
+    private:
+        /**
+         * @brief RX interrupt. Interrupt context.
+         */
+        void handler_rx(void);
+
+        IsrCAN*             _can;
+        Callback<void()>    _notify;
+        Callback<uint64_t()> _clock;
+
+        /**
+         * @brief Indices run free and wrap modulo CAN_RX_DEPTH when used. The
+         * interrupt owns _head, the reader owns _tail.
+         */
+        CANMessage              _ring[CAN_RX_DEPTH];
+        uint64_t                _stamp[CAN_RX_DEPTH];
+        std::atomic<uint8_t>    _head;
+        std::atomic<uint8_t>    _tail;
+
+        Stats       _stats;
+};
@@ -0,0 +1,51 @@
+/**
+ * @file can_tx_queue.cpp
+ * @brief Software transmit queue in front of the three bxCAN mailboxes.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#include "can_tx_queue.hpp"
+#include <cstring>
+
+CanTxQueue::CanTxQueue(IsrCAN* can): _can(can) {
+    memset(_head, 0, sizeof(_head));
+    memset(_tail, 0, sizeof(_tail));
+    memset(_stats, 0, sizeof(_stats));
+    _can->attach(callback(this, &CanTxQueue::handler_tx), CAN::TxIrq);
+}
+
+bool CanTxQueue::write(const CANMessage& msg, CanTxPriority_t priority) {
+    CriticalSectionLock lock;
+    uint8_t waiting = _head[priority] - _tail[priority];
+    if (waiting >= CAN_TX_DEPTH) {
+        _stats[priority].dropped++;
+        return false;
+    }
+    _ring[priority][_head[priority] % CAN_TX_DEPTH] = msg;
+    _head[priority]++;
+    if (waiting + 1 > _stats[priority].high_water) _stats[priority].high_water = waiting + 1;
+    drain();
+    return true;
+}
+
+void CanTxQueue::reset_stats(void) {
+    CriticalSectionLock lock;
+    memset(_stats, 0, sizeof(_stats));
+}
+
+void CanTxQueue::drain(void) {
+    for (uint8_t priority = 0; priority < CAN_TX_PRIORITIES; priority++) {
+        while (_head[priority] != _tail[priority]) {
+            // Mailboxes full; the next TX complete picks up from here.
+            if (!_can->write(_ring[priority][_tail[priority] % CAN_TX_DEPTH])) return;
+            _tail[priority]++;
+            _stats[priority].sent++;
+        }
+    }
+}
+
+void CanTxQueue::handler_tx(void) {
+    // Another interrupt may queue a frame meanwhile.
+    CriticalSectionLock lock;
+    drain();
+}
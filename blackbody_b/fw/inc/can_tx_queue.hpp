@@ -0,0 +1,107 @@
+/**
+ * @file can_tx_queue.hpp
+ * @brief Software transmit queue in front of the three bxCAN mailboxes.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note Frames wait in a ring per priority and move to the controller from
+ * the TX complete interrupt as mailboxes free up, highest priority first. A
+ * full ring drops the new frame and counts it.
+ */
+#pragma once
+#include "mbed.h"
+#include <cstdint>
+
+/** Frames per priority, a power of 2. */
+#define CAN_TX_DEPTH    (16)
+
+/**
+ * @brief Transmit priority, drained in this order.
+ */
+typedef enum {
+    CAN_TX_URGENT   = 0,    // Heartbeat and faults.
+    CAN_TX_NORMAL   = 1,    // Measurements and replies.
+    CAN_TX_BULK     = 2,    // Anything that can wait.
+    CAN_TX_PRIORITIES,
+} CanTxPriority_t;
+
+/**
+ * @brief CAN that may be written from interrupt context. mbed guards write()
+ * with a mutex, which an ISR cannot take; CanTxQueue serializes every write
+ * itself.
+ */
+class IsrCAN : public CAN
+{
+    public:
+        IsrCAN(PinName rd, PinName td) : CAN(rd, td) {}
+
+    protected:
+        void lock(void) override {}
+        void unlock(void) override {}
+};
+
+class CanTxQueue
+{
+    public:
+        /**
+         * @brief Counters since construction or the last reset_stats().
+         */
+        struct Stats {
+            uint32_t sent;          // Frames handed to the controller.
+            uint32_t dropped;       // Frames refused because the ring was full.
+            uint8_t high_water;     // Most frames waiting at once.
+        };
+
+        /**
+         * @brief Construct a new queue and take over the TX complete
+         * interrupt of the controller.
+         *
+         * @param can Controller to transmit on.
+         */
+        CanTxQueue(IsrCAN* can);
+
+        /**
+         * @brief Queue a frame, and start it at once if a mailbox is free.
+         * Callable from thread or interrupt context.
+         *
+         * @param msg Frame to send.
+         * @param priority Ring to queue it on. Default CAN_TX_NORMAL.
+         * @return true If queued.
+         * @return false If the ring was full and the frame was dropped.
+         */
+        bool write(const CANMessage& msg, CanTxPriority_t priority=CAN_TX_NORMAL);
+
+        /**
+         * @brief Counters of one priority.
+         */
+        const Stats& stats(CanTxPriority_t priority) const { return _stats[priority]; }
+
+        /**
+         * @brief Zero every counter.
+         */
+        void reset_stats(void);
+
+    private:
+        /**
+         * @brief Fill free mailboxes from the rings, highest priority first.
+         * Interrupts must be masked.
+         */
+        void drain(void);
+
+        /**
+         * @brief TX complete. Interrupt context.
+         */
+        void handler_tx(void);
+
+        IsrCAN*     _can;
+
+        /**
+         * @brief One ring per priority. Indices run free and wrap modulo
+         * CAN_TX_DEPTH when used.
+         */
+        CANMessage  _ring[CAN_TX_PRIORITIES][CAN_TX_DEPTH];
+        uint8_t     _head[CAN_TX_PRIORITIES];
+        uint8_t     _tail[CAN_TX_PRIORITIES];
+
+        Stats       _stats[CAN_TX_PRIORITIES];
+};
@@ -0,0 +1,98 @@
+/**
+ * @file time_sync.cpp
+ * @brief Follows the bus time master.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#include "time_sync.hpp"
+
+TimeSync::TimeSync(void) {
+    reset();
+    _clock.start();
+}
+
+uint64_t TimeSync::local_us(void) {
+    return _clock.elapsed_time().count();
+}
+
+bool TimeSync::handle(const CANMessage& msg, uint64_t rx_local_us) {
+    if (msg.id == CAN_TIME_SYNC && msg.len >= 1) {
+        _sync_sequence = msg.data[0];
+        _sync_local_us = rx_local_us;
+        _have_sync = true;
+        return true;
+    }
+    if (msg.id == CAN_TIME_FUP && msg.len >= 7) {
+        if (_have_sync && msg.data[0] == _sync_sequence) {
+            uint64_t master_us = 0;
+            for (uint8_t i = 0; i < 6; i++) master_us |= (uint64_t)msg.data[1 + i] << (8 * i);
+            sample(_sync_local_us, master_us);
+        }
+        _have_sync = false;
+        return true;
+    }
+    return false;
+}
+
+uint64_t TimeSync::to_master(uint64_t local_us) const {
+    if (_accepted == 0) return local_us;
+    return to_master_ns(local_us) / 1000;
+}
+
+uint64_t TimeSync::to_master_ns(uint64_t local_us) const {
+    int64_t elapsed = (int64_t)(local_us - _ref_local_us);
+    return _ref_master_ns + elapsed * 1000 + elapsed * _drift_ppb / 1000000;
+}
+
+CANMessage TimeSync::sample_time(uint32_t paired_id, uint8_t key, uint64_t sample_local_us) const {
+    uint64_t time = to_master(sample_local_us);
+    uint8_t data[8];
+    data[0] = ((paired_id - 0x600) & 0x7F) | (locked() ? 0x80 : 0x00);
+    data[1] = key;
+    for (uint8_t i = 0; i < 6; i++) data[2 + i] = time >> (8 * i);
+    return CANMessage(CAN_SAMPLE_TIME, data, 8);
+}
+
+void TimeSync::sample(uint64_t local_us, uint64_t master_us) {
+    if (_accepted == 0) {
+        _ref_local_us = local_us;
+        _ref_master_ns = master_us * 1000;
+        _accepted = 1;
+        return;
+    }
+    int64_t predicted = (int64_t)to_master_ns(local_us);
+    int64_t residual = (int64_t)(master_us * 1000) - predicted;
+    if (residual > TIME_SYNC_RESET_US * 1000LL || residual < -TIME_SYNC_RESET_US * 1000LL || _rejected_in_row >= 8) {
+        // A new master, or lost track: start from this sample.
+        reset();
+        _ref_local_us = local_us;
+        _ref_master_ns = master_us * 1000;
+        _accepted = 1;
+        return;
+    }
+    if (locked() && residual < -TIME_SYNC_REJECT_US * 1000LL) {
+        _rejected_in_row++;
+        return;
+    }
+    _rejected_in_row = 0;
+    int64_t elapsed = (int64_t)(local_us - _ref_local_us);
+    if (elapsed <= 0) return;
+    // Rate outright from the second sample, then phase gain 1/2 and
+    // frequency gain 1/4. Phase in ns, so halving stays exact.
+    bool first = _accepted == 1;
+    _drift_ppb += (int32_t)(residual * 1000000 / elapsed / (first ? 1 : 4));
+    _ref_master_ns = predicted + (first ? residual : residual / 2);
+    _ref_local_us = local_us;
+    _accepted++;
+}
+
+void TimeSync::reset(void) {
+    _have_sync = false;
+    _sync_sequence = 0;
+    _sync_local_us = 0;
+    _ref_local_us = 0;
+    _ref_master_ns = 0;
+    _drift_ppb = 0;
+    _accepted = 0;
+    _rejected_in_row = 0;
+}
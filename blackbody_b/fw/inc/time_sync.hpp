@@ -0,0 +1,104 @@
+/**
+ * @file time_sync.hpp
+ * @brief Follows the bus time master, so that samples can be stamped on the
+ * same clock as the other boards.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note The master sends CAN_TIME_SYNC ([0] sequence), then CAN_TIME_FUP ([0]
+ * sequence, [1..6] 48 bit little endian master time in us, taken as
+ * CAN_TIME_SYNC left). The follow-up time minus the local time CAN_TIME_SYNC
+ * arrived is one offset sample; a phase and frequency loop tracks offset and
+ * drift from them. Samples over TIME_SYNC_REJECT_US early against the
+ * estimate were stamped late by the master and are dropped. Blackbody B is
+ * never the master.
+ *
+ * @note CAN_SAMPLE_TIME follows a measurement frame: [0] bits 6:0 its
+ * identifier minus 0x600, bit 7 set if on the master's clock (clear: board
+ * uptime), [1] its key (0 on Blackbody B), [2..7] 48 bit little endian time
+ * of the sample, us.
+ */
+#pragma once
+#include "mbed.h"
+#include <cstdint>
+
+#define CAN_TIME_SYNC       0x62D
+#define CAN_TIME_FUP        0x62E
+#define CAN_SAMPLE_TIME     0x62F
+
+/** Early stamps beyond this are dropped, us. */
+#define TIME_SYNC_REJECT_US     (200)
+
+/** Start over past this, e.g. a new master, us. */
+#define TIME_SYNC_RESET_US      (1000000)
+
+/** Accepted samples before the estimate counts as locked. */
+#define TIME_SYNC_LOCK_SAMPLES  (4)
+
+class TimeSync
+{
+    public:
+        TimeSync();
+
+        /**
+         * @brief Take CAN_TIME_SYNC and CAN_TIME_FUP.
+         *
+         * @param msg Frame received.
+         * @param rx_local_us Local time it arrived, from the RX interrupt.
+         * @return true If msg was a time sync frame.
+         */
+        bool handle(const CANMessage& msg, uint64_t rx_local_us);
+
+        /**
+         * @brief Free running board clock, us since power on. Interrupt
+         * safe.
+         */
+        uint64_t local_us(void);
+
+        /**
+         * @brief Master time for a local time, or the local time itself
+         * until the first sample.
+         */
+        uint64_t to_master(uint64_t local_us) const;
+
+        /**
+         * @brief Now on the common time base.
+         */
+        uint64_t now_us(void) { return to_master(local_us()); }
+
+        bool locked(void) const { return _accepted >= TIME_SYNC_LOCK_SAMPLES; }
+
+        /**
+         * @brief Rate of the master's clock against ours, minus 1.
+         */
+        int32_t drift_ppb(void) const { return _drift_ppb; }
+
+        /**
+         * @brief CAN_SAMPLE_TIME for a measurement frame.
+         *
+         * @param paired_id Identifier of the measurement frame.
+         * @param key Sensor index.
+         * @param sample_local_us Local time the sample was taken.
+         */
+        CANMessage sample_time(uint32_t paired_id, uint8_t key, uint64_t sample_local_us) const;
+
+    private:
+        void sample(uint64_t local_us, uint64_t master_us);
+        uint64_t to_master_ns(uint64_t local_us) const;
+        void reset(void);
+
+        Timer _clock;
+
+        // Last CAN_TIME_SYNC seen.
+        uint8_t _sync_sequence;
+        uint64_t _sync_local_us;
+        bool _have_sync;
+
+        // Master time _ref_master_ns at local time _ref_local_us, and the
+        // master's rate from there on.
+        uint64_t _ref_local_us;
+        uint64_t _ref_master_ns;
+        int32_t _drift_ppb;
+        uint32_t _accepted;
+        uint8_t _rejected_in_row;
+};
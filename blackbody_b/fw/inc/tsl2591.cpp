@@ -12,6 +12,7 @@
 #define TSL2591_ID          (0x50)
 
 #define TSL2591_CMD_BIT     (0xA0)
+#define TSL2591_CMD_CLR_INT (0xE7)  // Special function: clear ALS and no persist interrupts.
 
 #define TSL2591_EN_NPIEN    (0x80)
 #define TSL2591_EN_SAI      (0x40)
@@ -20,11 +21,31 @@
 #define TSL2591_EN_PON      (0x01)
 #define TSL2591_EN_POFF     (0x00)
 
+#define TSL2591_STATUS_AVALID   (0x01)
+#define TSL2591_STATUS_AINT     (0x10)
+
+#define TSL2591_PERSIST_EVERY   (0x00)  // Every ALS cycle generates an interrupt.
+
+/** Time INT may lag the nominal integration time before the timeout fires. */
+#define TSL2591_INT_MARGIN  (100ms)
+
 #define TSL2591_LUX_DF      (408.0F)
 #define TSL2591_LUX_COEFB   (1.64F)  // CH0 coefficient 
 #define TSL2591_LUX_COEFC   (0.59F)  // CH1 coefficient A
 #define TSL2591_LUX_COEFD   (0.86F)  // CH2 coefficient B
 
+static const float TSL2591_GAIN_SCALE[] = { 1.0F, 25.0F, 428.0F, 9876.0F };
+
+/** Full scale counts; 100 ms integrations stop at 37888. */
+static uint16_t max_counts(uint8_t integ) {
+    return integ == TSL2591_INT_TIME_100MS ? 37888 : 65535;
+}
+
+/** Gain x integration time in ms. */
+static float sensitivity(uint8_t gain_index, uint8_t integ) {
+    return TSL2591_GAIN_SCALE[gain_index] * (integ + 1) * 100;
+}
+
 enum {
     TSL2591_REG_ENABLE          = 0x00,
     TSL2591_REG_CONTROL         = 0x01,
@@ -44,20 +65,24 @@ enum {
     TSL2591_REG_CHAN0_H         = 0x15,
     TSL2591_REG_CHAN1_L         = 0x16,
     TSL2591_REG_CHAN1_H         = 0x17,
-} TSL2591_registers;
+};
 
 TSL2591::TSL2591(I2C* tsl2591_i2c, InterruptIn* tsl2591_int, uint8_t addr, TSL2591Gain_t gain, TSL2591IntegrationTime_t integ):
- _i2c(tsl2591_i2c), _int(tsl2591_int), _addr(addr << 1)
+ TSL2591(new TSL2591I2CBus(tsl2591_i2c, addr), tsl2591_int, gain, integ)
+{
+}
+
+TSL2591::TSL2591(TSL2591Bus* tsl2591_bus, InterruptIn* tsl2591_int, TSL2591Gain_t gain, TSL2591IntegrationTime_t integ):
+ _bus(tsl2591_bus), _int(tsl2591_int), _busy(false), _signalled(false), _continuous(false),
+ _auto_range(false), _saturated(false), _scale(100.0F)
 {
     _gain = gain;
     _integ = integ;
 }
 
 bool TSL2591::setup(void) {
-    char write[] = { (TSL2591_CMD_BIT|TSL2591_REG_ID) };
-    if(_i2c->write(_addr, write, 1, 0) == 0) {
-        char read[1];
-        _i2c->read(_addr, read, 1, 0);
+    char read[1];
+    if(_bus->read(TSL2591_CMD_BIT|TSL2591_REG_ID, read, 1) == 0) {
         if(read[0] == TSL2591_ID) {
             set_gain(_gain);
             set_integration_time(_integ);
@@ -69,51 +94,217 @@ bool TSL2591::setup(void) {
 }
 
 void TSL2591::set_gain(TSL2591Gain_t gain) {
-    enable();
     _gain = gain;
-    char write[] = {(TSL2591_CMD_BIT|TSL2591_REG_CONTROL), static_cast<char>((_integ|_gain))};
-    _i2c->write(_addr, write, 2, 0);
-    disable();
+    write_control();
 }
 
 void TSL2591::set_integration_time(TSL2591IntegrationTime_t integ) {
-    enable();
     _integ = integ;
-    char write[] = {(TSL2591_CMD_BIT|TSL2591_REG_CONTROL), static_cast<char>((_integ|_gain))};
-    _i2c->write(_addr, write, 2, 0);
-    disable();
+    write_control();
 }
 
 void TSL2591::sample(uint16_t* ch0_counts, uint16_t* ch1_counts) {
+    if (_continuous) {
+        // Already integrating; wait for the next result instead of power
+        // cycling.
+        while (!read(ch0_counts, ch1_counts)) {
+            ThisThread::sleep_for(10ms);
+        }
+        return;
+    }
+
     enable();
     for(uint8_t t=0; t<=_integ+1; t++) {
         ThisThread::sleep_for(100ms);
     }
 
-    // Channel 1
-    char write1[] = {(TSL2591_CMD_BIT|TSL2591_REG_CHAN1_L)};
-    _i2c->write(_addr, write1, 1, 0);
-    char read1[2];
-    _i2c->read(_addr, read1, 2, 0);
+    read_channels(ch0_counts, ch1_counts);
+
+    disable();
+}
+
+void TSL2591::start(Callback<void()> ready) {
+    if (_continuous) return;
+    _ready = ready;
+    _signalled = false;
+    _busy = true;
 
-    // Channel 0
-    char write2[] = {(TSL2591_CMD_BIT|TSL2591_REG_CHAN0_L)};
-    _i2c->write(_addr, write2, 1, 0);
-    char read2[2];
-    _i2c->read(_addr, read2, 2, 0);
+    // A stale interrupt would pull INT low as soon as AIEN is set.
+    clear_interrupt();
+    enable();
+
+    if (_int) _int->fall(callback(this, &TSL2591::handler_ready));
+    arm_timeout();
+}
+
+void TSL2591::start_continuous(Callback<void()> ready) {
+    if (_busy) stop();
+    _ready = ready;
+    _signalled = false;
+    _busy = true;
+    _continuous = true;
+
+    // Interrupt at the end of every integration, not just on a threshold.
+    char write[] = {(TSL2591_CMD_BIT|TSL2591_REG_PERSIST), TSL2591_PERSIST_EVERY};
+    _bus->write(write, 2);
+    clear_interrupt();
+    enable();
+
+    if (_int) _int->fall(callback(this, &TSL2591::handler_ready));
+    arm_timeout();
+}
 
+void TSL2591::stop(void) {
+    _timeout.detach();
+    if (_int) _int->fall(nullptr);
     disable();
+    clear_interrupt();
+    _busy = false;
+    _continuous = false;
+    _signalled = false;
+}
+
+bool TSL2591::read(uint16_t* ch0_counts, uint16_t* ch1_counts) {
+    if (!_busy) return false;
+
+    // STATUS and both channels in one burst.
+    char read[5];
+    _bus->read(TSL2591_CMD_BIT|TSL2591_REG_STATUS, read, 5);
+    uint8_t status = read[0];
+    if (!(status & TSL2591_STATUS_AVALID)) return false;
+
+    if (_continuous) {
+        // AVALID stays set while streaming; AINT marks a result we have not
+        // read yet.
+        if (!(status & TSL2591_STATUS_AINT)) return false;
+        parse_channels(&read[1], ch0_counts, ch1_counts);
+        clear_interrupt();
+        _signalled = false;
+        arm_timeout();
+        return true;
+    }
+
+    _timeout.detach();
+    parse_channels(&read[1], ch0_counts, ch1_counts);
+    clear_interrupt();
+    disable();
+    _busy = false;
+    return true;
+}
+
+bool TSL2591::read(float* ch0_rate, float* ch1_rate) {
+    uint16_t ch0_counts;
+    uint16_t ch1_counts;
+    if (!read(&ch0_counts, &ch1_counts)) return false;
+    *ch0_rate = ch0_counts / _scale;
+    *ch1_rate = ch1_counts / _scale;
+    return true;
+}
+
+void TSL2591::auto_range(uint16_t ch0_counts, uint16_t ch1_counts) {
+    uint8_t gain = _gain >> 4;
+    uint8_t integ = _integ;
+    if (_saturated) {
+        // Only a lower bound on the light; step one gain down, then to 100 ms.
+        if (gain > 0) gain--;
+        else integ = TSL2591_INT_TIME_100MS;
+    } else {
+        uint16_t peak = ch0_counts > ch1_counts ? ch0_counts : ch1_counts;
+        float current = sensitivity(gain, integ);
+        float rate = peak / current;
+        bool found = false;
+        for (uint8_t t = TSL2591_INT_TIME_100MS; t <= TSL2591_INT_TIME_600MS && !found; t++) {
+            // Highest gain that fits at this integration time.
+            for (int8_t g = 3; g >= 0; g--) {
+                float candidate = sensitivity(g, t);
+                float predicted = rate * candidate;
+                // Leave the current setting only with some margin.
+                float headroom = TSL2591_AUTO_HEADROOM * max_counts(t);
+                if (candidate > current) headroom /= TSL2591_AUTO_HYSTERESIS;
+                if (predicted > headroom) continue;
+                float needed = TSL2591_AUTO_MIN_COUNTS;
+                if (t < integ) needed *= TSL2591_AUTO_HYSTERESIS;
+                if (predicted >= needed || t == TSL2591_INT_TIME_600MS) {
+                    gain = g;
+                    integ = t;
+                    found = true;
+                }
+                break;
+            }
+        }
+    }
+    if (gain != (_gain >> 4) || integ != _integ) {
+        _gain = (TSL2591Gain_t)(gain << 4);
+        _integ = (TSL2591IntegrationTime_t)integ;
+        write_control();
+    }
+}
+
+std::chrono::milliseconds TSL2591::integration_time(void) const {
+    return std::chrono::milliseconds((_integ + 1) * 100);
+}
+
+void TSL2591::read_channels(uint16_t* ch0_counts, uint16_t* ch1_counts) {
+    // C0DATAL through C1DATAH in one burst.
+    char read[4];
+    _bus->read(TSL2591_CMD_BIT|TSL2591_REG_CHAN0_L, read, 4);
+    parse_channels(read, ch0_counts, ch1_counts);
+}
+
+void TSL2591::parse_channels(const char* data, uint16_t* ch0_counts, uint16_t* ch1_counts) {
+    const uint8_t* d = reinterpret_cast<const uint8_t*>(data);
+    *ch0_counts = (uint16_t)(d[1] << 8 | d[0]);
+    *ch1_counts = (uint16_t)(d[3] << 8 | d[2]);
+
+    // Remember what the result was taken with before auto range moves it.
+    uint16_t full_scale = max_counts(_integ);
+    _saturated = *ch0_counts >= full_scale || *ch1_counts >= full_scale;
+    _scale = sensitivity(_gain >> 4, _integ);
+    if (_auto_range) auto_range(*ch0_counts, *ch1_counts);
+}
+
+void TSL2591::write_control(void) {
+    char write[] = {(TSL2591_CMD_BIT|TSL2591_REG_CONTROL), static_cast<char>((_integ|_gain))};
+    if (!_continuous) {
+        _bus->write(write, 2);
+        return;
+    }
+    // A CONTROL write is not documented to restart the integration in
+    // flight, whose result could then mix both settings. Clear AEN around
+    // it so a clean one starts, and drop any result from the old setting.
+    char pause[] = {(TSL2591_CMD_BIT|TSL2591_REG_ENABLE), (TSL2591_EN_PON|TSL2591_EN_AIEN|TSL2591_EN_NPIEN)};
+    _bus->write(pause, 2);
+    _bus->write(write, 2);
+    clear_interrupt();
+    enable();
+    _signalled = false;
+    arm_timeout();
+}
+
+void TSL2591::arm_timeout(void) {
+    // INT is level triggered; if a result lands before the last one is
+    // cleared there is no new edge, so a timeout catches it.
+    std::chrono::milliseconds margin = _int ? TSL2591_INT_MARGIN : 0ms;
+    _timeout.attach(callback(this, &TSL2591::handler_ready), integration_time() + margin);
+}
+
+void TSL2591::clear_interrupt(void) {
+    char write[] = {(TSL2591_CMD_CLR_INT)};
+    _bus->write(write, 1);
+}
 
-    *ch1_counts = (*(uint16_t*)read1);
-    *ch0_counts = (*(uint16_t*)read2);
+void TSL2591::handler_ready(void) {
+    if (!_busy || _signalled) return;
+    _signalled = true;
+    if (_ready) _ready();
 }
 
 void TSL2591::enable(void) {
     char write[] = {(TSL2591_CMD_BIT|TSL2591_REG_ENABLE), (TSL2591_EN_PON|TSL2591_EN_AEN|TSL2591_EN_AIEN|TSL2591_EN_NPIEN)};
-    _i2c->write(_addr, write, 2, 0);
+    _bus->write(write, 2);
 }
 
 void TSL2591::disable(void) {
     char write[] = {(TSL2591_CMD_BIT|TSL2591_REG_ENABLE), (TSL2591_EN_POFF)};
-    _i2c->write(_addr, write, 2, 0);
+    _bus->write(write, 2);
 }
@@ -10,11 +10,22 @@
 #pragma once
 #include "mbed.h"
 #include <cstdint>
+#include "tsl2591_bus.hpp"
 
 #define TSL2591_ADDR        (0x29)
 
+/** Auto range precision target: at least this many counts, 0.1 % of a reading. */
+#define TSL2591_AUTO_MIN_COUNTS     (1000)
+
+/** Auto range keeps the next reading under this fraction of full scale. */
+#define TSL2591_AUTO_HEADROOM       (0.75F)
+
+/** Auto range margin before leaving the current setting. */
+#define TSL2591_AUTO_HYSTERESIS     (1.25F)
+
 /**
- * @brief Gain scaling relative to 1x gain.
+ * @brief Gain scaling relative to 1x gain, as the CONTROL AGAIN field (bits
+ * 5:4).
  * - LOW:   1x
  * - MED:   25x
  * - HIGH:  428x
@@ -22,9 +33,9 @@
  */
 typedef enum {
     TSL2591_GAIN_LOW    = 0x00,
-    TSL2591_GAIN_MED    = 0x01,
-    TSL2591_GAIN_HIGH   = 0x02,
-    TSL2591_GAIN_MAX    = 0x03,
+    TSL2591_GAIN_MED    = 0x10,
+    TSL2591_GAIN_HIGH   = 0x20,
+    TSL2591_GAIN_MAX    = 0x30,
 } TSL2591Gain_t;
 
 /**
@@ -58,6 +69,17 @@ class TSL2591
          */
         TSL2591(I2C* tsl2591_i2c, InterruptIn* tsl2591_int, uint8_t addr=TSL2591_ADDR, TSL2591Gain_t gain=TSL2591_GAIN_LOW, TSL2591IntegrationTime_t integ=TSL2591_INT_TIME_100MS);
 
+        /**
+         * @brief Construct a new TSL2591 object on an existing bus, e.g. a
+         * mux channel. The bus must outlive the object.
+         * 
+         * @param tsl2591_bus Transaction layer tied to the sensor.
+         * @param tsl2591_int Interrupt pin tied to the sensor, or nullptr.
+         * @param gain Gain of the sensor. Default TSL2591_GAIN_LOW.
+         * @param integ Integration time of the sensor. Default TSL2591_INT_TIME_100MS.
+         */
+        TSL2591(TSL2591Bus* tsl2591_bus, InterruptIn* tsl2591_int, TSL2591Gain_t gain=TSL2591_GAIN_LOW, TSL2591IntegrationTime_t integ=TSL2591_INT_TIME_100MS);
+
         /**
          * @brief Sets up the sensor.
          * 
@@ -79,6 +101,22 @@ class TSL2591
          * @param integ TSL2591Gain_t integration time.
          */
         void set_integration_time(TSL2591IntegrationTime_t integ);
+
+        /**
+         * @brief Step gain and integration time after every reading: the
+         * shortest integration that still collects TSL2591_AUTO_MIN_COUNTS,
+         * at the highest gain that stays under TSL2591_AUTO_HEADROOM of full
+         * scale. Bright light gets short integrations and so a higher
+         * sample rate.
+         * 
+         * @param enable Enable auto ranging.
+         */
+        void set_auto_range(bool enable) { _auto_range = enable; }
+
+        /**
+         * @brief Gain of the sensor.
+         */
+        TSL2591Gain_t gain(void) const { return _gain; }
         
         /**
          * @brief Sample the sensor and parse the results.
@@ -87,6 +125,78 @@ class TSL2591
          * @param ch1_counts Raw counts for channel 1.
          */
         void sample(uint16_t* ch0_counts, uint16_t* ch1_counts);
+
+        /**
+         * @brief Start an integration and return immediately. ready is called
+         * from interrupt context once the result can be read: on the falling
+         * edge of INT, or after the integration time if there is no INT pin.
+         * Do not use I2C from ready; defer to a thread (e.g. with
+         * EventQueue::call) and call read() from there.
+         *
+         * @param ready Called when the integration completes.
+         */
+        void start(Callback<void()> ready);
+
+        /**
+         * @brief Keep the ALS powered and integrating back to back, so a new
+         * result is ready every integration time with no power-on or warm-up
+         * in between. ready is called from interrupt context as each result
+         * becomes valid; harvest it with read(). Runs until stop().
+         *
+         * @param ready Called when each integration completes.
+         */
+        void start_continuous(Callback<void()> ready);
+
+        /**
+         * @brief Stop any integration in flight, including continuous mode,
+         * and power the sensor down.
+         */
+        void stop(void);
+
+        /**
+         * @brief Read the result of an integration started with start(), then
+         * power the sensor down. In continuous mode, read the newest result
+         * and leave the sensor running.
+         *
+         * @param ch0_counts Raw counts for channel 0.
+         * @param ch1_counts Raw counts for channel 1.
+         * @return true If the result was read.
+         * @return false If no integration is in flight, or no new result is
+         * valid yet; call again later.
+         */
+        bool read(uint16_t* ch0_counts, uint16_t* ch1_counts);
+
+        /**
+         * @brief As read(uint16_t*, uint16_t*), normalized to counts per
+         * (gain x ms) at the gain and integration time the result was taken
+         * with, so that results compare across auto range steps.
+         *
+         * @param ch0_rate Channel 0 counts per (gain x ms).
+         * @param ch1_rate Channel 1 counts per (gain x ms).
+         */
+        bool read(float* ch0_rate, float* ch1_rate);
+
+        /**
+         * @brief Whether a channel of the last result read was at full
+         * scale. The counts then only bound the light from below.
+         */
+        bool saturated(void) const { return _saturated; }
+
+        /**
+         * @brief Whether an integration started with start() has not been
+         * read yet.
+         */
+        bool busy(void) const { return _busy; }
+
+        /**
+         * @brief Whether the sensor is streaming after start_continuous().
+         */
+        bool continuous(void) const { return _continuous; }
+
+        /**
+         * @brief Time between results in continuous mode.
+         */
+        std::chrono::milliseconds integration_time(void) const;
     
     private:
         /**
@@ -100,15 +210,46 @@ class TSL2591
         void disable(void);
 
         /**
-         * @brief Reference to I2C object.
+         * @brief Clear the ALS and no persist interrupts, releasing INT.
          */
-        I2C*                        _i2c;
-        
+        void clear_interrupt(void);
+
+        /**
+         * @brief Pick the next gain and integration time from the last
+         * result. See set_auto_range().
+         */
+        void auto_range(uint16_t ch0_counts, uint16_t ch1_counts);
+
+        /**
+         * @brief Write the gain and integration time to CONTROL.
+         */
+        void write_control(void);
+
+        /**
+         * @brief (Re)start the timeout for the integration in flight.
+         */
+        void arm_timeout(void);
+
         /**
-         * @brief I2C address of sensor (typically TSL2591_ADDR unless board has
-         * I2C mux support). 
+         * @brief Read both channels.
          */
-        uint8_t                     _addr;
+        void read_channels(uint16_t* ch0_counts, uint16_t* ch1_counts);
+
+        /**
+         * @brief Unpack C0DATAL, C0DATAH, C1DATAL, C1DATAH, note the scale
+         * and saturation of the result, then auto range if enabled.
+         */
+        void parse_channels(const char* data, uint16_t* ch0_counts, uint16_t* ch1_counts);
+
+        /**
+         * @brief INT falling edge or integration timeout. Interrupt context.
+         */
+        void handler_ready(void);
+
+        /**
+         * @brief Transaction layer to the sensor.
+         */
+        TSL2591Bus*                 _bus;
 
         /**
          * @brief Reference to pin used for interrupt.
@@ -124,4 +265,45 @@ class TSL2591
          * @brief Integration time of sensor.
          */
         TSL2591IntegrationTime_t    _integ;
+
+        /**
+         * @brief Signals the end of an integration when there is no INT pin,
+         * and backs INT up if it never fires.
+         */
+        Timeout                     _timeout;
+
+        /**
+         * @brief Callback given to start().
+         */
+        Callback<void()>            _ready;
+
+        /**
+         * @brief Integration in flight, not yet read.
+         */
+        volatile bool               _busy;
+
+        /**
+         * @brief _ready has been called for the integration in flight.
+         */
+        volatile bool               _signalled;
+
+        /**
+         * @brief Streaming after start_continuous().
+         */
+        bool                        _continuous;
+
+        /**
+         * @brief Step gain and integration time after every reading.
+         */
+        bool                        _auto_range;
+
+        /**
+         * @brief Last result read was at full scale.
+         */
+        bool                        _saturated;
+
+        /**
+         * @brief Gain x ms of the last result read.
+         */
+        float                       _scale;
 };
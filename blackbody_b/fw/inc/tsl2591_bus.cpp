@@ -0,0 +1,42 @@
+/**
+ * @file tsl2591_bus.cpp
+ * @brief I2C transaction layer for the TSL2591 driver.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#include "tsl2591_bus.hpp"
+
+TSL2591I2CBus::TSL2591I2CBus(I2C* i2c, uint8_t addr, int frequency):
+ _i2c(i2c), _addr(addr << 1), _done(0), _event(0)
+{
+    _i2c->frequency(frequency);
+}
+
+int TSL2591I2CBus::write(const char* data, int length) {
+    return _i2c->write(_addr, data, length);
+}
+
+int TSL2591I2CBus::read(uint8_t command, char* data, int length) {
+    char cmd = (char)command;
+#if DEVICE_I2C_ASYNCH
+    // Write, repeated start, read, in the background.
+    _i2c->lock();
+    int result = _i2c->transfer(_addr, &cmd, 1, data, length,
+                                callback(this, &TSL2591I2CBus::handler_complete),
+                                I2C_EVENT_ALL);
+    if (result == 0) {
+        _done.acquire();
+        result = _event == I2C_EVENT_TRANSFER_COMPLETE ? 0 : -1;
+    }
+    _i2c->unlock();
+    return result;
+#else
+    if (_i2c->write(_addr, &cmd, 1, true) != 0) return -1;
+    return _i2c->read(_addr, data, length);
+#endif
+}
+
+void TSL2591I2CBus::handler_complete(int event) {
+    _event = event;
+    _done.release();
+}
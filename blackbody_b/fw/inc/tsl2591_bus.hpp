@@ -0,0 +1,90 @@
+/**
+ * @file tsl2591_bus.hpp
+ * @brief I2C transaction layer for the TSL2591 driver.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note The TSL2591 is specified up to 400 kHz (fast mode). The L432KC also
+ * supports 1 MHz fast mode plus, but only use it on a bus without a TSL2591.
+ */
+#pragma once
+#include "mbed.h"
+#include <cstdint>
+
+#define TSL2591_I2C_FREQUENCY   (400000) /* Hz */
+
+/**
+ * @brief One register transaction per call, so that the driver does not need
+ * to know whether the sensor sits directly on an mbed I2C bus, behind a mux,
+ * or on a host mock.
+ */
+class TSL2591Bus
+{
+    public:
+        virtual ~TSL2591Bus() {}
+
+        /**
+         * @brief Write length bytes in one transaction. data[0] is the command
+         * byte (register address or special function).
+         *
+         * @return 0 on success, nonzero if the sensor did not acknowledge.
+         */
+        virtual int write(const char* data, int length) = 0;
+
+        /**
+         * @brief Write the command byte, then read length bytes after a
+         * repeated start, in one transaction. Registers auto-increment, so
+         * consecutive registers come back in a single burst.
+         *
+         * @return 0 on success, nonzero if the sensor did not acknowledge.
+         */
+        virtual int read(uint8_t command, char* data, int length) = 0;
+};
+
+/**
+ * @brief TSL2591Bus on an mbed I2C bus. Reads run in the background with
+ * I2C::transfer where the target supports it, and the calling thread sleeps
+ * until they finish.
+ */
+class TSL2591I2CBus : public TSL2591Bus
+{
+    public:
+        /**
+         * @brief Construct a new I2C bus.
+         *
+         * @param i2c I2C instance peripheral tied to the sensor.
+         * @param addr 7-bit address of the sensor.
+         * @param frequency SCL frequency in Hz, applied to the whole bus.
+         * Default TSL2591_I2C_FREQUENCY.
+         */
+        TSL2591I2CBus(I2C* i2c, uint8_t addr, int frequency=TSL2591_I2C_FREQUENCY);
+
+        int write(const char* data, int length) override;
+        int read(uint8_t command, char* data, int length) override;
+
+    private:
+        /**
+         * @brief Transfer completion callback. Interrupt context.
+         */
+        void handler_complete(int event);
+
+        /**
+         * @brief Reference to I2C object.
+         */
+        I2C*            _i2c;
+
+        /**
+         * @brief 8-bit (shifted) address of the sensor.
+         */
+        int             _addr;
+
+        /**
+         * @brief Released by handler_complete when the transfer has finished.
+         */
+        Semaphore       _done;
+
+        /**
+         * @brief Event that ended the last transfer.
+         */
+        volatile int    _event;
+};
@@ -31,6 +31,9 @@
  */
 #include "mbed.h"
 #include "inc/tsl2591.hpp"
+#include "inc/can_tx_queue.hpp"
+#include "inc/can_rx_queue.hpp"
+#include "inc/time_sync.hpp"
 
 #define CAN_HEARTBEAT   0x620
 #define CAN_SET_MODE    0x621
@@ -40,6 +43,12 @@
 #define CAN_IRR_CONF    0x625
 #define CAN_RTD_MEAS    0x626
 #define CAN_IRR_MEAS    0x627
+#define CAN_TX_STATS_REQ 0x629
+#define CAN_TX_STATS    0x62A
+
+// Acceptance filter: only 0x620 to 0x63F reach the RX FIFO.
+#define CAN_RX_FILTER_ID    0x620
+#define CAN_RX_FILTER_MASK  0x7E0
 
 enum State {
     STATE_STOP = 0,
@@ -57,14 +66,15 @@ static DigitalOut led_heartbeat(D1);
 static DigitalOut led_tracking(D0);
 static DigitalOut led_error(D3);
 
-static CAN can(D10, D2);
+static IsrCAN can(D10, D2);
+static CanTxQueue can_tx(&can);
+static TimeSync time_sync;
 
 static I2C i2c1(D4, D5);
 static InterruptIn sensor_int(D6);
 static TSL2591 irradiance_sensor(&i2c1, &sensor_int, TSL2591_ADDR);
 
 static Ticker ticker_heartbeat;
-static Ticker ticker_sample_irrad;
 static EventQueue queue(32 * EVENTS_EVENT_SIZE);
 
 static enum State current_state;
@@ -80,14 +90,14 @@ static Error_t sys_error;
 void handler_heartbeat(void);
 
 /**
- * @brief Interrupt triggered by an irradiance sensor ticker to call event
- * event_measure_irradiance_sensor.
+ * @brief Interrupt triggered each time the irradiance sensor finishes an
+ * integration, to call event event_read_irradiance_sensor.
  */
-void handler_measure_irradiance_sensor(void);
+void handler_irradiance_ready(void);
 
 /**
- * @brief Interrupt triggered by a CAN RX IRQ to call event
- * event_process_can_message.
+ * @brief Interrupt triggered when CAN frames arrive in an empty receive
+ * ring, to call event event_process_can_message.
  */
 void handler_can(void);
 
@@ -97,15 +107,24 @@ void handler_can(void);
 void event_heartbeat(void);
 
 /**
- * @brief Event to measure irradiance sensor and output the result over CAN.
+ * @brief Event to read the irradiance sensor and output results over CAN at
+ * up to sample_frequency.
  */
-void event_measure_irradiance_sensor(void);
+void event_read_irradiance_sensor(void);
 
 /**
- * @brief Event to process incoming CAN messages.
+ * @brief Event to process every CAN message waiting in the receive ring.
  */
 void event_process_can_message(void);
 
+/**
+ * @brief Event to reply to CAN_TX_STATS_REQ with one CAN_TX_STATS frame per
+ * transmit priority.
+ *
+ * @param clear Zero the counters after reporting them.
+ */
+void event_report_tx_stats(bool clear);
+
 /**
  * @brief Event to update the state machine and manage any sensor tickers.
  */
@@ -116,7 +135,13 @@ void event_update_state_machine(void);
  */
 void event_process_error(void);
 
+// Needs handler_can, declared above.
+static CanRxQueue can_rx(&can, &handler_can);
+
 int main() {
+    // Before anything else, so the rest of the bus never fills the ring.
+    can.filter(CAN_RX_FILTER_ID, CAN_RX_FILTER_MASK, CANStandard, 0);
+    can_rx.set_clock(callback(&time_sync, &TimeSync::local_us));
     ThisThread::sleep_for(3000ms);
     
     led_heartbeat = 0;
@@ -125,7 +150,7 @@ int main() {
     current_state = STATE_STOP;
     is_error = false;
     set_mode = false;
-    sample_frequency = 1;
+    sample_frequency = 10;
     sys_error = ERROR_NONE;
 
     if (!irradiance_sensor.setup()) {
@@ -133,15 +158,16 @@ int main() {
         sys_error = ERROR_IRRAD_SETUP;
         queue.call(&event_process_error);
     }
+    irradiance_sensor.set_auto_range(true);
 
     // Force start
     set_mode = true;
     queue.call(&event_update_state_machine);
 
     ticker_heartbeat.attach(&handler_heartbeat, 1000ms);
-    can.attach(&handler_can, CAN::RxIrq);
 
     queue.dispatch_forever();
+    return 0;
 }
 
 void handler_heartbeat(void) { 
@@ -149,8 +175,8 @@ void handler_heartbeat(void) {
     queue.call(&event_heartbeat);
 }
 
-void handler_measure_irradiance_sensor(void) {
-    queue.call(&event_measure_irradiance_sensor);
+void handler_irradiance_ready(void) {
+    queue.call(&event_read_irradiance_sensor);
 }
 
 void handler_can(void) {
@@ -159,9 +185,14 @@ void handler_can(void) {
 
 void event_heartbeat(void) {
     static char counter = 0;
-    CANMessage message(CAN_HEARTBEAT, &counter, 1);
+    // Counter, then whole seconds on the common time base.
+    uint8_t data[5];
+    data[0] = counter;
+    uint32_t seconds = time_sync.now_us() / 1000000;
+    memcpy(&data[1], &seconds, 4);
+    CANMessage message(CAN_HEARTBEAT, data, 5);
     ++counter;
-    can.write(message);
+    can_tx.write(message, CAN_TX_URGENT);
 
     printf(
         "Cycle %i:\tSTATE=%i,\tIS_ERROR=%i,\tSET_MODE=%i\n", 
@@ -172,28 +203,53 @@ void event_heartbeat(void) {
     );
 }
 
-void event_measure_irradiance_sensor(void) {
-    printf("\tSampling irradiance sensor.\n");
-    // Measure sensor
-    uint16_t ch0_raw;
-    uint16_t ch1_raw;
-    irradiance_sensor.sample(&ch0_raw, &ch1_raw);
+void event_read_irradiance_sensor(void) {
+    // Measure sensor, in counts per (gain x ms) since auto range moves both.
+    float ch0_rate;
+    float ch1_rate;
+    bool valid = irradiance_sensor.read(&ch0_rate, &ch1_rate);
+    uint64_t taken_us = time_sync.local_us();
+    if (!valid) {
+        // Signalled before the result was valid, e.g. by the INT timeout;
+        // try again shortly.
+        if (irradiance_sensor.busy()) queue.call_in(10ms, &event_read_irradiance_sensor);
+        return;
+    }
+
+    // A clipped result only bounds the light from below; auto range has
+    // already stepped down, so wait for the next one.
+    if (irradiance_sensor.saturated()) return;
+
+    // The sensor streams at its own rate, which auto range changes; keep
+    // every Nth result.
+    uint16_t native_frequency = 1000ms / irradiance_sensor.integration_time();
+    uint16_t decimation = 1;
+    if (sample_frequency > 0 && sample_frequency < native_frequency) {
+        decimation = native_frequency / sample_frequency;
+    }
+    static uint16_t skipped = 0;
+    if (++skipped < decimation) return;
+    skipped = 0;
 
     // TODO: Perform calibration and filter function
-    float ch0_irradiance = ch0_raw / (264.1 * 100);
-    float ch1_irradiance = ch1_raw / (34.9 * 100);
+    // Responsivities are per count at 1x gain and 100 ms.
+    float ch0_irradiance = ch0_rate / 264.1;
+    float ch1_irradiance = ch1_rate / 34.9;
     
     // Output to screen
     printf("\tCH0: %.3f w/m^2\tCH1: %.3f w/m^2\n", ch0_irradiance, ch1_irradiance);
 
     // Output on CAN
-    can.write(CANMessage(CAN_IRR_MEAS, (uint8_t*)&ch0_irradiance, 4));
+    can_tx.write(CANMessage(CAN_IRR_MEAS, (uint8_t*)&ch0_irradiance, 4));
+    can_tx.write(time_sync.sample_time(CAN_IRR_MEAS, 0, taken_us));
 }
 
 void event_process_can_message(void) {
-    // Read message
+    // Running out of messages is the normal way out, not a fault.
     CANMessage msg;
-    if (can.read(msg)) {
+    uint64_t stamp;
+    while (can_rx.read(msg, &stamp)) {
+        if (time_sync.handle(msg, stamp)) continue;
         switch (msg.id) {
             case CAN_SET_MODE:
                 // TODO: verify mode is set properly.
@@ -212,16 +268,31 @@ void event_process_can_message(void) {
                 sample_frequency = (uint16_t) (msg.data[0]) << 8 | (uint16_t) (msg.data[1]);
                 printf("\tGot sample frequency=%i\n", sample_frequency);
                 break;
+            case CAN_TX_STATS_REQ:
+                event_report_tx_stats(msg.len > 0 && (msg.data[0] & 0x01));
+                break;
             default:
                 // Ignore any other CAN messages.
                 break;
         }
-    } else {
-        is_error = true;
-        queue.call(&event_process_error);
     }
 }
 
+void event_report_tx_stats(bool clear) {
+    // Priority, high-water mark, drops (saturating) and frames sent.
+    for (uint8_t priority = 0; priority < CAN_TX_PRIORITIES; priority++) {
+        const CanTxQueue::Stats& stats = can_tx.stats((CanTxPriority_t)priority);
+        uint8_t data[8];
+        uint16_t dropped = stats.dropped > 0xFFFF ? 0xFFFF : stats.dropped;
+        data[0] = priority;
+        data[1] = stats.high_water;
+        memcpy(&data[2], &dropped, 2);
+        memcpy(&data[4], &stats.sent, 4);
+        can_tx.write(CANMessage(CAN_TX_STATS, data, 8));
+    }
+    if (clear) can_tx.reset_stats();
+}
+
 void event_update_state_machine(void) {
     switch (current_state) {
         case STATE_STOP:
@@ -241,20 +312,21 @@ void event_update_state_machine(void) {
     
     switch (current_state) {
         case STATE_STOP:
-            ticker_sample_irrad.detach();
+            irradiance_sensor.stop();
             led_tracking = 0;
             led_error = 0;
             break;
         case STATE_RUN:
-            ticker_sample_irrad.attach(
-                handler_measure_irradiance_sensor, 
-                (1000ms / sample_frequency)
-            );
+            // Stream results every integration time instead of powering the
+            // sensor up for each sample.
+            if (!irradiance_sensor.continuous()) {
+                irradiance_sensor.start_continuous(&handler_irradiance_ready);
+            }
             led_tracking = 1;
             led_error = 0;
             break;
         case STATE_ERROR:
-            ticker_sample_irrad.detach();
+            irradiance_sensor.stop();
             led_error = 1;
             led_tracking = 0;
             break;
@@ -266,6 +338,6 @@ void event_process_error(void) {
     queue.call(&event_update_state_machine);
 
     uint16_t _error = sys_error;
-    can.write(CANMessage(CAN_BB_FAULT, (uint8_t*)&_error, 2));
+    can_tx.write(CANMessage(CAN_BB_FAULT, (uint8_t*)&_error, 2), CAN_TX_URGENT);
     printf("\tError: %i\n", _error);
 }
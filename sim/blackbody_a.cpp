@@ -0,0 +1,728 @@
+/**
+ * @file blackbody_a.cpp
+ * @brief Host simulation of the Blackbody A firmware
+ * (blackbody_a/fw/src/mainNoCan.cpp) with eight MAX31865s and a Blackbody C
+ * TSL2591 attached. Reports CAN output rates and the measured cycle period,
+ * and checks reported temperatures and irradiance against the simulated
+ * parts.
+ *
+ * Halfway through, RTD_CONF and IRR_CONF double the RTD rate, halve the
+ * irradiance rate and switch both to packed frames, and FILTER_CONF puts a
+ * median of 3 and a 2:1 boxcar on the RTDs and a median of 3 and a 2:1 EMA on
+ * the irradiance sensors. Three quarters in a rate that cannot fit and a
+ * filter that is not valid are sent, and an irradiance rate that, times the
+ * decimation, outruns the TSL2591 integration; the RTD rate comes with a
+ * switch to the log only, which must not be applied either. Samples are checked in either
+ * format. Checks each sensor's reported rate before and after, that no
+ * stream pauses across the change, and that both bad requests are reported
+ * and ignored.
+ *
+ * The cycle must hold 1 s on average with no drift, as seen both on the
+ * heartbeats and in the SCHED_DIAG reports. At the end the transmit queue
+ * statistics are requested; no frame may have been dropped, and the reply
+ * must start within a millisecond of the request.
+ *
+ * Other nodes keep the bus busy with identifiers outside 0x620 to 0x63F,
+ * which the acceptance filter must keep out of the RX FIFO, and a burst of
+ * commands twice as long as the FIFO must all arrive.
+ *
+ * A time master on the bus runs 40 ppm fast from a different epoch. Every
+ * measurement frame must be followed by its CAN_SAMPLE_TIME; once locked,
+ * those must give the sample's time on the master's clock, no later than the
+ * frame and no earlier than its sampling round, and the heartbeat must carry
+ * the master's seconds.
+ *
+ * Between the two, a 10 s stretch of samples is dumped back from the sample
+ * log. Every channel's samples in that stretch must come back, in range and
+ * on the sensor's reading at their time, without a live frame dropped.
+ *
+ * A quarter of the way in, the element of RTD2 goes open; a sixteenth later
+ * it is mended, and an eighth in CAN_ACK_FAULT is sent. The fault must be
+ * reported as FAULT_RTD with the channel quarantined, then as mended but
+ * still quarantined once a fault detection cycle finds it clean, then as
+ * released. RTD2 must send nothing in between; every other stream, and the
+ * board, carries on.
+ *
+ * For the last eighth, RTD_CONF and IRR_CONF add a deadband and a keep-alive
+ * at the same rates, and halfway through it the light on IRR0 drops to a
+ * third. Measurement frames must fall at least tenfold, no sensor may stay
+ * silent past its keep-alive, and the shade must be reported within half a
+ * second.
+ *
+ * RTDs are sampled with one-shot conversions. Vbias must be on for less than
+ * half the time on any chip, no conversion may start before Vbias settled,
+ * and none may be read before it is done. Every edge on the RTD bus must
+ * meet the MAX31865 interface timing.
+ *
+ * Built with IRRAD_MUX=1 (blackbody_a_mux), the firmware and the harness both
+ * put eight TSL2591s behind a TCA9548A instead.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note Usage: blackbody_a [-t seconds] [-v]
+ */
+#include "mbed.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "models/max31865_model.h"
+#include "models/spi_timing_probe.h"
+#include "models/tca9548a_model.h"
+#include "models/tsl2591_model.h"
+#include "report.h"
+
+#define CAN_HEARTBEAT   0x620
+#define CAN_SET_MODE    0x621
+#define CAN_BB_FAULT    0x622
+#define CAN_ACK_FAULT   0x623
+#define CAN_RTD_CONF    0x624
+#define CAN_IRR_CONF    0x625
+#define CAN_RTD_MEAS    0x626
+#define CAN_IRR_MEAS    0x627
+#define CAN_SCHED_DIAG  0x628
+#define CAN_TX_STATS_REQ 0x629
+#define CAN_TX_STATS    0x62A
+#define CAN_RTD_PACKED  0x62B
+#define CAN_IRR_PACKED  0x62C
+#define CAN_TIME_SYNC   0x62D
+#define CAN_TIME_FUP    0x62E
+#define CAN_SAMPLE_TIME 0x62F
+#define CAN_LOG_DUMP_REQ 0x638
+#define CAN_LOG_DUMP    0x639
+#define CAN_LOG_DUMP_END 0x63A
+#define CAN_FILTER_CONF 0x63B
+
+/* The time master, see TimeSync.h. */
+#define MASTER_EPOCH_US     5000000.0
+#define MASTER_PPM          40.0
+#define SYNC_PHASE          (613 * sim::MS)
+#define FUP_DELAY           (2 * sim::MS)
+#define LOCK_AFTER          (10 * sim::S)
+
+/* The sample log dump, see SampleLog.h: request at DUMP_AT, for DUMP_SPAN
+   ending DUMP_BACK before it. */
+#define DUMP_SPAN           (10 * sim::S)
+#define DUMP_BACK           (5 * sim::S)
+
+/* Traffic for other nodes, every FOREIGN_PERIOD. */
+#define CAN_FOREIGN_LOW     0x100
+#define CAN_FOREIGN_HIGH    0x7DF
+#define FOREIGN_PERIOD      (20 * sim::MS)
+
+/* Commands sent back to back, twice the RX FIFO. */
+#define COMMAND_BURST       (2 * sim::CAN_RX_FIFO_DEPTH)
+
+#ifndef IRRAD_MUX
+#define IRRAD_MUX 0
+#endif
+#if IRRAD_MUX
+#define NUM_IRRAD 8
+#else
+#define NUM_IRRAD 1
+#endif
+
+/* RTD_MEAS indices sampled, sensors[] in mainNoCan.cpp. */
+#define NUM_RTD 7
+
+/* Rates before and after the CONF frames. */
+#define RTD_HZ_BEFORE   2
+#define RTD_HZ_AFTER    4
+#define IRR_HZ_BEFORE   10
+#define IRR_HZ_AFTER    5
+
+/* Report-on-change for the last eighth: deadbands in 0.01 C and 0.01 W/m^2,
+   keep-alive in s. IRR0 is shaded to SHADE of its light halfway through, and
+   has SHADE_SETTLE to get there through its filter. */
+#define QUIET_RTD_DEADBAND  25
+#define QUIET_IRR_DEADBAND  50
+#define QUIET_SILENCE       10
+#define SHADE               (1.0 / 3.0)
+#define SHADE_SETTLE        (2 * sim::S)
+
+/* The open RTD: MAX31865 fault status the detection cycle finds (RTDIN-
+   below 0.85 Vbias, FORCE- open) and the code it converts, over the high
+   threshold. FAULT_RTD bytes, see rtd_fault(). */
+#define OPEN_IDX        2
+#define OPEN_STATUS     0x08
+#define OPEN_CODE       0x7FFF
+#define FAULT_RTD       0x20
+#define RTD_QUARANTINED 0x01
+
+/* Samples per reported one after FILTER_CONF. */
+#define RTD_DECIMATION  2
+#define IRR_DECIMATION  2
+
+/* One sample of one sensor, from a float or a packed frame. */
+struct Sample {
+    sim::ns_t t;
+    bool rtd;
+    int idx;
+    double value;
+    bool packed;
+};
+
+/* Every sample on the bus, see measure_RTD and SamplePacker.h. */
+static std::vector<Sample> samples(void) {
+    std::vector<Sample> out;
+    for (const sim::Frame& frame : sim::can_log()) {
+        bool rtd = frame.id == CAN_RTD_MEAS || frame.id == CAN_RTD_PACKED;
+        if (frame.id == CAN_RTD_MEAS || frame.id == CAN_IRR_MEAS) {
+            if (frame.len != 5) continue;
+            float value;
+            memcpy(&value, &frame.data[1], sizeof(value));
+            out.push_back({ frame.t, rtd, frame.data[0], value, false });
+        } else if (frame.id == CAN_RTD_PACKED || frame.id == CAN_IRR_PACKED) {
+            if (frame.len != 8) continue;
+            int bank = frame.data[7] >> 5;
+            int n = 0;
+            for (int bit = 0; bit < 8; ++bit) {
+                if (!(frame.data[0] >> bit & 1)) continue;
+                int16_t value = (int16_t)(frame.data[1 + 2 * n] | frame.data[2 + 2 * n] << 8);
+                out.push_back({ frame.t, rtd, 8 * bank + bit, value / (rtd ? 100.0 : 10.0), true });
+                ++n;
+            }
+        }
+    }
+    return out;
+}
+
+/* Samples of one sensor in [from, to): rate, and longest gap over the run. */
+struct Stream {
+    bool rtd;
+    int idx;
+};
+
+static double stream_hz(const std::vector<Sample>& all, Stream stream, sim::ns_t from, sim::ns_t to) {
+    uint32_t n = 0;
+    for (const Sample& sample : all) {
+        if (sample.rtd == stream.rtd && sample.idx == stream.idx && sample.t >= from && sample.t < to) ++n;
+    }
+    return n / ((double)(to - from) / sim::S);
+}
+
+static double stream_max_gap_ms(const std::vector<Sample>& all, Stream stream, sim::ns_t from, sim::ns_t to) {
+    bool seen = false;
+    sim::ns_t last = 0;
+    sim::ns_t gap = 0;
+    for (const Sample& sample : all) {
+        if (sample.rtd != stream.rtd || sample.idx != stream.idx || sample.t < from || sample.t >= to) continue;
+        if (seen && sample.t - last > gap) gap = sample.t - last;
+        last = sample.t;
+        seen = true;
+    }
+    return (double)gap / sim::MS;
+}
+
+/* Frames with an id in [from, to), per second. */
+static double frame_hz(uint32_t id, sim::ns_t from, sim::ns_t to) {
+    uint32_t frames = 0;
+    for (const sim::Frame& frame : sim::can_log()) {
+        if (frame.id == id && frame.t >= from && frame.t < to) ++frames;
+    }
+    return frames / ((double)(to - from) / sim::S);
+}
+
+/* Heartbeats, i.e. cycles, per second in [from, to). */
+static double cycle_hz(sim::ns_t from, sim::ns_t to) {
+    uint32_t frames = 0;
+    for (const sim::Frame& frame : sim::can_log()) {
+        if (frame.id == CAN_HEARTBEAT && frame.t >= from && frame.t < to) ++frames;
+    }
+    return frames / ((double)(to - from) / sim::S);
+}
+
+/* Rate within 5 % of hz samples per cycle. */
+static bool rate_ok(double measured, double hz, double cycles) {
+    return measured > hz * cycles * 0.95 && measured < hz * cycles * 1.05;
+}
+
+/* The master's clock at simulated time t, us. */
+static double master_us(sim::ns_t t) {
+    return MASTER_EPOCH_US + t / 1000.0 * (1.0 + MASTER_PPM * 1e-6);
+}
+
+/* Firmware main(), renamed at compile time. */
+int blackbody_main(void);
+
+/* Chip selects of RTD0 - RTD7, see the mainNoCan.cpp pinout. */
+static const PinName RTD_CS[8] = { A6, A4, A3, A0, A7, A5, A2, A1 };
+
+/* Channel each RTD_MEAS index is read from: sensors[] in mainNoCan.cpp skips
+   RTD4, so indices 4 to 6 are RTD5 to RTD7. */
+static const int RTD_OF_INDEX[8] = { 0, 1, 2, 3, 5, 6, 7, -1 };
+
+static double rtd_temperature(int idx, sim::ns_t t) {
+    return 20.0 + 5.0 * idx + 2.0 * sin(2.0 * M_PI * (double)t / (600.0 * sim::S));
+}
+
+/* Light on each TSL2591, counts per (gain x ms) for channel 0 and 1. */
+static double irrad_ch0(int idx) { return 50.0 + 10.0 * idx; }
+static double irrad_ch1(int idx) { return 8.0 + idx; }
+
+/* When IRR0 is shaded, see SHADE. */
+static sim::ns_t shade_at = INT64_MAX;
+
+/* W/m^2 the firmware reports for a sensor at t, see
+   event_measure_irradiance_sensors. */
+static double irradiance(int idx, sim::ns_t t) {
+    double ch0 = irrad_ch0(idx) * 100 / 6024;
+    double ch1 = irrad_ch1(idx) * 100 / 1003;
+    double shade = idx == 0 && t >= shade_at ? SHADE : 1.0;
+    return (ch0 + ch1) / 2 * 1000.0 / 100.0 * shade;
+}
+
+int main(int argc, char** argv) {
+    double seconds = 3600.0;
+    bool verbose = false;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-t") && i + 1 < argc) seconds = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-v")) verbose = true;
+    }
+
+    Max31865Model* rtds[8];
+    for (int idx = 0; idx < 8; ++idx) {
+        rtds[idx] = new Max31865Model(D12, D11, D13, RTD_CS[idx]);
+        rtds[idx]->set_temperature([idx](sim::ns_t t) { return rtd_temperature(idx, t); });
+    }
+    SpiTimingProbe rtd_probe(D12, D11, D13, std::vector<PinName>(RTD_CS, RTD_CS + 8));
+#if IRRAD_MUX
+    Tca9548aModel mux(I2C_SDA);
+    Tsl2591Model* irrad[NUM_IRRAD];
+    for (int idx = 0; idx < NUM_IRRAD; ++idx) {
+        irrad[idx] = new Tsl2591Model(NC);
+        mux.attach(idx, 0x29, irrad[idx]);
+    }
+#else
+    Tsl2591Model* irrad[NUM_IRRAD] = { new Tsl2591Model(I2C_SDA) };
+#endif
+    for (int idx = 0; idx < NUM_IRRAD; ++idx) {
+        irrad[idx]->set_light(irrad_ch0(idx), irrad_ch1(idx));
+        /* The cycle keeps exact time, so a sensor oscillator that did too
+           would sit at one phase to the reads forever. */
+        irrad[idx]->set_clock_error(1000 + 250 * idx);
+    }
+
+    sim::ns_t duration = (sim::ns_t)(seconds * sim::S);
+    sim::ns_t change = duration / 2;
+    /* Keep the health check period, switch to packed frames. */
+    const uint8_t rtd_conf[5] = { 0x7F, 0, RTD_HZ_AFTER, 0, 1 };
+    const uint8_t irr_conf[4] = { (uint8_t)((1 << NUM_IRRAD) - 1), 0, IRR_HZ_AFTER, 1 };
+    /* 1000 Hz, and log only: refused as a whole, so RTDs stay live. */
+    const uint8_t rtd_conf_infeasible[5] = { 0x7F, 0x03, 0xE8, 0, 2 };
+    sim::can_inject(change, CAN_RTD_CONF, rtd_conf, 5);
+    sim::can_inject(change, CAN_IRR_CONF, irr_conf, 4);
+    sim::can_inject(change + duration / 4, CAN_RTD_CONF, rtd_conf_infeasible, 5);
+    /* 10 Hz times the decimation: twice what a 100 ms integration gives. */
+    const uint8_t irr_conf_too_fast[4] = { (uint8_t)((1 << NUM_IRRAD) - 1), 0, 10, 1 };
+    sim::can_inject(change + duration / 4, CAN_IRR_CONF, irr_conf_too_fast, 4);
+    /* Sampled twice as fast, reported at the CONF rates. */
+    const uint8_t rtd_filter_conf[5] = { 0, 3, 2, 0, RTD_DECIMATION };
+    const uint8_t irr_filter_conf[5] = { 1, 3, 1, 2, IRR_DECIMATION };
+    const uint8_t filter_conf_invalid[5] = { 0, 2, 0, 0, 1 };
+    sim::can_inject(change, CAN_FILTER_CONF, rtd_filter_conf, 5);
+    sim::can_inject(change, CAN_FILTER_CONF, irr_filter_conf, 5);
+    sim::can_inject(change + duration / 4, CAN_FILTER_CONF, filter_conf_invalid, 5);
+    /* Same rates and formats, with a deadband and a keep-alive. */
+    sim::ns_t quiet = duration - duration / 8;
+    const uint8_t rtd_conf_quiet[8] = { 0x7F, 0, RTD_HZ_AFTER, 0, 1, 0, QUIET_RTD_DEADBAND, QUIET_SILENCE };
+    const uint8_t irr_conf_quiet[7] = { (uint8_t)((1 << NUM_IRRAD) - 1), 0, IRR_HZ_AFTER, 1, 0, QUIET_IRR_DEADBAND,
+                                        QUIET_SILENCE };
+    sim::can_inject(quiet, CAN_RTD_CONF, rtd_conf_quiet, 8);
+    sim::can_inject(quiet, CAN_IRR_CONF, irr_conf_quiet, 7);
+    shade_at = quiet + duration / 16;
+    sim::schedule(shade_at, [&]() { irrad[0]->set_light(irrad_ch0(0) * SHADE, irrad_ch1(0) * SHADE); });
+    /* Open, mended, acknowledged. */
+    sim::ns_t open_at = duration / 4;
+    sim::ns_t mend_at = open_at + duration / 16;
+    sim::ns_t ack_at = open_at + duration / 8;
+    sim::schedule(open_at, [&]() { rtds[RTD_OF_INDEX[OPEN_IDX]]->set_wiring_fault(OPEN_STATUS, OPEN_CODE); });
+    sim::schedule(mend_at, [&]() { rtds[RTD_OF_INDEX[OPEN_IDX]]->set_wiring_fault(0); });
+    const uint8_t ack[1] = { 0x01 };
+    sim::can_inject(ack_at, CAN_ACK_FAULT, ack, 1);
+    const uint8_t tx_stats_req[1] = { 0 };
+    sim::ns_t stats_at = duration - sim::S + 337 * sim::MS;
+    sim::can_inject(stats_at, CAN_TX_STATS_REQ, tx_stats_req, 1);
+    /* SET_MODE RUN while running changes nothing, but each must be read. */
+    const uint8_t run[1] = { 0x01 };
+    for (int i = 0; i < COMMAND_BURST; ++i) {
+        sim::can_inject(duration / 8 + i * sim::can_frame_time(1, 100000), CAN_SET_MODE, run, 1);
+    }
+    uint32_t foreign = 0;
+    const uint8_t payload[8] = { 0 };
+    for (sim::ns_t t = FOREIGN_PERIOD / 2; t < duration; t += FOREIGN_PERIOD) {
+        sim::can_inject(t, CAN_FOREIGN_LOW, payload, 8);
+        sim::can_inject(t + FOREIGN_PERIOD / 4, CAN_FOREIGN_HIGH, payload, 8);
+        foreign += 2;
+    }
+
+    sim::ns_t dump_at = change + duration / 8;
+    uint32_t dump_from_ms = (uint32_t)(master_us(dump_at - DUMP_BACK - DUMP_SPAN) / 1000);
+    uint32_t dump_to_ms = (uint32_t)(master_us(dump_at - DUMP_BACK) / 1000);
+    uint8_t dump_req[8];
+    memcpy(&dump_req[0], &dump_from_ms, 4);
+    memcpy(&dump_req[4], &dump_to_ms, 4);
+    sim::can_inject(dump_at, CAN_LOG_DUMP_REQ, dump_req, 8);
+
+    /* SYNC, then a follow-up with the master's time at its end. */
+    uint32_t syncs = 0;
+    for (sim::ns_t t = SYNC_PHASE; t + FUP_DELAY < duration; t += sim::S) {
+        uint8_t sync[1] = { (uint8_t)syncs };
+        uint8_t fup[7] = { (uint8_t)syncs };
+        uint64_t stamp = (uint64_t)master_us(t);
+        for (int i = 0; i < 6; ++i) fup[1 + i] = stamp >> (8 * i);
+        sim::can_inject(t, CAN_TIME_SYNC, sync, 1);
+        sim::can_inject(t + FUP_DELAY, CAN_TIME_FUP, fup, 7);
+        ++syncs;
+    }
+
+    double wall = sim::run([]() { blackbody_main(); }, duration, !verbose);
+
+    sim::print_run_summary(stdout, IRRAD_MUX ? "blackbody_a_mux" : "blackbody_a", duration, wall);
+    sim::print_can_summary(stdout);
+
+    std::vector<Sample> all = samples();
+
+    /* Compare each RTD sample against the RTD temperature at send time. */
+    double max_error = 0.0;
+    uint32_t rtd_frames = 0;
+    for (const Sample& sample : all) {
+        if (!sample.rtd || sample.idx >= 8) continue;
+        int rtd = RTD_OF_INDEX[sample.idx];
+        if (rtd < 0) continue;
+        double error = fabs(sample.value - rtd_temperature(rtd, sample.t));
+        if (error > max_error) max_error = error;
+        ++rtd_frames;
+    }
+    /* Each irradiance sample against the light on the sensor its index
+       names, less the 0.05 W/m^2 rounding of packed frames. Samples that
+       were still on their way through the filter after the shade are left
+       out. */
+    uint32_t irr_frames[NUM_IRRAD] = {};
+    double irr_error[NUM_IRRAD] = {};
+    bool irr_ok = true;
+    for (const Sample& sample : all) {
+        if (sample.rtd) continue;
+        if (sample.idx >= NUM_IRRAD) {
+            irr_ok = false;
+            continue;
+        }
+        int idx = sample.idx;
+        if (sample.t >= shade_at && sample.t < shade_at + SHADE_SETTLE) continue;
+        double error = fabs(sample.value - irradiance(idx, sample.t));
+        if (sample.packed) error = error > 0.05 ? error - 0.05 : 0.0;
+        error /= irradiance(idx, sample.t);
+        if (error > irr_error[idx]) irr_error[idx] = error;
+        ++irr_frames[idx];
+    }
+    /* Rates settle within a second of the change. Rates are per cycle, the
+       cycle itself is checked below. */
+    sim::ns_t settle = 2 * sim::S;
+    double cycles_before = cycle_hz(settle, change);
+    double cycles_after = cycle_hz(change + settle, quiet);
+    for (int idx = 0; idx < NUM_IRRAD; ++idx) {
+        Stream stream = { false, idx };
+        double before = stream_hz(all, stream, settle, change);
+        double after = stream_hz(all, stream, change + settle, quiet);
+        double gap = stream_max_gap_ms(all, stream, 0, quiet);
+        printf("IRR%d: %.2f Hz, then %.2f Hz, longest gap %.1f ms, max error %.4f %%\n",
+               idx, before, after, gap, 100.0 * irr_error[idx]);
+        irr_ok = irr_ok && irr_frames[idx] > 0 && irr_error[idx] < 0.005;
+        irr_ok = irr_ok && rate_ok(before, IRR_HZ_BEFORE, cycles_before) && rate_ok(after, IRR_HZ_AFTER, cycles_after);
+        /* A reading still integrating holds its output back one sample. */
+        irr_ok = irr_ok && gap < 1100.0 / IRR_HZ_AFTER + 1000.0 / (IRR_HZ_AFTER * IRR_DECIMATION);
+    }
+    bool rtd_ok = true;
+    for (int idx = 0; idx < NUM_RTD; ++idx) {
+        Stream stream = { true, idx };
+        /* Quarantine is its own check, below */
+        double before = idx == OPEN_IDX ? stream_hz(all, stream, ack_at + settle, change)
+                                        : stream_hz(all, stream, settle, change);
+        double after = stream_hz(all, stream, change + settle, quiet);
+        double gap = stream_max_gap_ms(all, stream, 0, quiet);
+        if (idx == OPEN_IDX) {
+            gap = std::max(stream_max_gap_ms(all, stream, 0, open_at), stream_max_gap_ms(all, stream, ack_at, quiet));
+        }
+        printf("RTD%d: %.2f Hz, then %.2f Hz, longest gap %.1f ms\n", idx, before, after, gap);
+        rtd_ok = rtd_ok && rate_ok(before, RTD_HZ_BEFORE, cycles_before) && rate_ok(after, RTD_HZ_AFTER, cycles_after);
+        /* A packed frame also waits for up to two more RTDs, and across the
+           change the filter starts over from its first sample. */
+        rtd_ok = rtd_ok && gap < 1100.0 / RTD_HZ_BEFORE + 100.0 + 1000.0 / (RTD_HZ_AFTER * RTD_DECIMATION);
+    }
+    /* Seven RTDs fit in three packed frames instead of seven; one
+       irradiance sensor still takes a frame either way. */
+    double rtd_float_hz = frame_hz(CAN_RTD_MEAS, settle, change) / RTD_HZ_BEFORE;
+    double rtd_packed_hz = frame_hz(CAN_RTD_PACKED, change + settle, quiet) / RTD_HZ_AFTER;
+    double irr_float_hz = frame_hz(CAN_IRR_MEAS, settle, change) / IRR_HZ_BEFORE;
+    double irr_packed_hz = frame_hz(CAN_IRR_PACKED, change + settle, quiet) / IRR_HZ_AFTER;
+    printf("RTD frames per round: %.2f float, %.2f packed\n", rtd_float_hz / cycles_before,
+           rtd_packed_hz / cycles_after);
+    printf("IRR frames per round: %.2f float, %.2f packed\n", irr_float_hz / cycles_before,
+           irr_packed_hz / cycles_after);
+    bool packed_ok = rtd_packed_hz < rtd_float_hz * 0.45 && irr_packed_hz <= irr_float_hz * 1.01;
+    bool rate_fault = false, filter_fault = false, irrad_fault = false, layout_fault = false;
+    for (const sim::Frame& frame : sim::can_log()) {
+        if (frame.id != CAN_BB_FAULT || frame.len != 2) continue;
+        /* Every rate before the infeasible one fits */
+        if (frame.t < change + duration / 4) {
+            layout_fault = layout_fault || frame.data[0] == 0x10 || frame.data[0] == 0x12;
+            continue;
+        }
+        rate_fault = rate_fault || frame.data[0] == 0x10;
+        filter_fault = filter_fault || (frame.data[0] == 0x11 && frame.data[1] == 0);
+        irrad_fault = irrad_fault || (frame.data[0] == 0x12 && frame.data[1] == 10);
+    }
+    printf("infeasible rate reported: %s, invalid filter reported: %s, irradiance too fast reported: %s, "
+           "other rates laid out: %s\n", rate_fault ? "yes" : "no", filter_fault ? "yes" : "no",
+           irrad_fault ? "yes" : "no", layout_fault ? "no" : "yes");
+    bool fault_ok = rate_fault && filter_fault && irrad_fault && !layout_fault;
+
+    /* The open RTD: each FAULT_RTD in turn, and nothing from it in between. */
+    const sim::ns_t never = INT64_MAX;
+    sim::ns_t quarantined_at = never, mended_at = never, released_at = never;
+    uint8_t open_status = 0;
+    bool rtd_fault_ok = true;
+    for (const sim::Frame& frame : sim::can_log()) {
+        if (frame.id != CAN_BB_FAULT || frame.data[0] != FAULT_RTD) continue;
+        if (frame.len != 1 + NUM_RTD) {
+            rtd_fault_ok = false;
+            continue;
+        }
+        for (int idx = 0; idx < NUM_RTD; ++idx) {
+            if (idx != OPEN_IDX) rtd_fault_ok = rtd_fault_ok && frame.data[1 + idx] == 0;
+        }
+        uint8_t fault = frame.data[1 + OPEN_IDX];
+        if (fault & RTD_QUARANTINED && fault & ~RTD_QUARANTINED) {
+            if (quarantined_at == never) quarantined_at = frame.t;
+            open_status |= fault;
+        } else if (fault == RTD_QUARANTINED && mended_at == never) {
+            mended_at = frame.t;
+        } else if (fault == 0 && released_at == never) {
+            released_at = frame.t;
+        }
+    }
+    uint32_t leaked = 0;
+    for (const Sample& sample : all) {
+        if (sample.rtd && sample.idx == OPEN_IDX && sample.t > quarantined_at && sample.t < ack_at) ++leaked;
+    }
+    printf("open RTD%d: quarantined after %.0f ms with status 0x%02x, clean %.1f s after mending, "
+           "released %.1f ms after the ACK, %u samples in between\n", OPEN_IDX,
+           (double)(quarantined_at - open_at) / sim::MS, open_status, (double)(mended_at - mend_at) / sim::S,
+           (double)(released_at - ack_at) / sim::MS, (unsigned)leaked);
+    /* Caught by the next sample's threshold fault. The detection cycle
+       reaches each RTD every NUM_RTD s, and the first after mending still
+       reads the threshold fault latched before it. */
+    rtd_fault_ok = rtd_fault_ok && quarantined_at >= open_at && quarantined_at < open_at + 1100 * sim::MS / RTD_HZ_BEFORE;
+    rtd_fault_ok = rtd_fault_ok && (open_status & (0x80 | OPEN_STATUS)) == (0x80 | OPEN_STATUS);
+    rtd_fault_ok = rtd_fault_ok && mended_at > mend_at && mended_at < mend_at + (2 * NUM_RTD + 1) * sim::S;
+    rtd_fault_ok = rtd_fault_ok && released_at >= ack_at && released_at < ack_at + 5 * sim::MS && leaked == 0;
+
+    /* Report-on-change: measurement frames before and after, the longest
+       silence of any sensor, and how soon the shade on IRR0 shows. */
+    double live_hz = frame_hz(CAN_RTD_PACKED, change + settle, quiet) + frame_hz(CAN_IRR_PACKED, change + settle, quiet);
+    double quiet_hz = frame_hz(CAN_RTD_PACKED, quiet + settle, duration) + frame_hz(CAN_IRR_PACKED, quiet + settle, duration);
+    double quiet_gap_ms = 0.0;
+    for (int rtd = 0; rtd < 2; ++rtd) {
+        for (int idx = 0; idx < (rtd ? NUM_RTD : NUM_IRRAD); ++idx) {
+            double gap = stream_max_gap_ms(all, { (bool)rtd, idx }, quiet, duration);
+            if (gap > quiet_gap_ms) quiet_gap_ms = gap;
+        }
+    }
+    double shade_ms = -1.0;
+    bool shade_seen = false;
+    for (const Sample& sample : all) {
+        if (sample.rtd || sample.idx != 0 || sample.t < shade_at) continue;
+        shade_ms = (double)(sample.t - shade_at) / sim::MS;
+        shade_seen = sample.value < irradiance(0, shade_at - 1) - QUIET_IRR_DEADBAND / 100.0;
+        break;
+    }
+    printf("report on change: %.2f measurement frames/s, then %.2f, longest silence %.0f ms, "
+           "shade reported after %.0f ms\n", live_hz, quiet_hz, quiet_gap_ms, shade_ms);
+    bool quiet_ok = quiet_hz * 10.0 <= live_hz && quiet_gap_ms < QUIET_SILENCE * 1000.0 + 1100.0 / IRR_HZ_AFTER;
+    quiet_ok = quiet_ok && shade_seen && shade_ms >= 0.0 && shade_ms < 500.0;
+#if IRRAD_MUX
+    printf("mux selects: %u\n", (unsigned)mux.selects());
+#endif
+
+    sim::IntervalStats cycle = sim::can_intervals(CAN_HEARTBEAT);
+    printf("cycle period: mean %.2f ms, min %.2f ms, max %.2f ms\n", cycle.mean_ms, cycle.min_ms, cycle.max_ms);
+    /* Worst of each SCHED_DIAG field, see task_report_timing. */
+    uint32_t diag_reports = 0;
+    int16_t diag_drift = 0;
+    uint16_t diag_jitter = 0, diag_late_max = 0, diag_late_mean = 0;
+    for (const sim::Frame& frame : sim::can_log()) {
+        if (frame.id != CAN_SCHED_DIAG || frame.len != 8) continue;
+        int16_t drift;
+        uint16_t jitter, late_max, late_mean;
+        memcpy(&drift, &frame.data[0], 2);
+        memcpy(&jitter, &frame.data[2], 2);
+        memcpy(&late_max, &frame.data[4], 2);
+        memcpy(&late_mean, &frame.data[6], 2);
+        if (abs(drift) > abs(diag_drift)) diag_drift = drift;
+        if (jitter > diag_jitter) diag_jitter = jitter;
+        if (late_max > diag_late_max) diag_late_max = late_max;
+        if (late_mean > diag_late_mean) diag_late_mean = late_mean;
+        ++diag_reports;
+    }
+    printf("SCHED_DIAG: %u reports, worst drift %d us/cycle, jitter %u us, slot late max %u us, mean %u us\n",
+           (unsigned)diag_reports, diag_drift, diag_jitter, diag_late_max, diag_late_mean);
+    /* One CAN_TX_STATS per priority, see event_report_tx_stats. */
+    uint32_t stats_replies = 0;
+    bool tx_ok = true;
+    for (const sim::Frame& frame : sim::can_log()) {
+        if (frame.id != CAN_TX_STATS || frame.len != 8) continue;
+        uint16_t dropped;
+        uint32_t sent;
+        memcpy(&dropped, &frame.data[2], 2);
+        memcpy(&sent, &frame.data[4], 4);
+        printf("TX priority %u: %u sent, %u dropped, high water %u\n",
+               frame.data[0], (unsigned)sent, dropped, frame.data[1]);
+        tx_ok = tx_ok && dropped == 0 && frame.data[1] <= 16;
+        ++stats_replies;
+    }
+    tx_ok = tx_ok && stats_replies == 3;
+    /* The first reply starts on the bus once the request is handled, unless
+       frames already in the mailboxes go first. */
+    double reply_ms = -1.0;
+    for (const sim::Frame& frame : sim::can_log()) {
+        if (frame.id != CAN_TX_STATS) continue;
+        reply_ms = (double)(frame.t - sim::can_frame_time(8, 100000) - stats_at) / sim::MS;
+        break;
+    }
+    sim::CanStats can = sim::can_stats();
+    printf("command latency %.3f ms; %u commands received, %u of %u foreign frames filtered, %u overruns\n",
+           reply_ms, (unsigned)can.rx_ok, (unsigned)can.rx_filtered, (unsigned)foreign,
+           (unsigned)can.rx_overrun);
+    bool rx_ok = reply_ms >= 0.0 && reply_ms < 1.0;
+    rx_ok = rx_ok && can.rx_filtered == foreign && can.rx_overrun == 0 && can.rx_ok == 12 + COMMAND_BURST + 2 * syncs;
+    /* SAMPLE_TIME: one per measurement frame, on the master's clock once
+       locked. A float frame leaves after its sample within the queueing
+       delay of a busy round, a packed one up to a round later. */
+    uint32_t measurements = 0, stamps = 0, unlocked = 0;
+    double stamp_early_us = 0.0, stamp_late_ms = 0.0;
+    bool stamp_ok = true;
+    for (const sim::Frame& frame : sim::can_log()) {
+        if (frame.id == CAN_RTD_MEAS || frame.id == CAN_IRR_MEAS || frame.id == CAN_RTD_PACKED ||
+            frame.id == CAN_IRR_PACKED) {
+            ++measurements;
+        }
+        if (frame.id != CAN_SAMPLE_TIME) continue;
+        ++stamps;
+        if (frame.len != 8) {
+            stamp_ok = false;
+            continue;
+        }
+        uint32_t paired = 0x600 + (frame.data[0] & 0x7F);
+        bool packed = paired == CAN_RTD_PACKED || paired == CAN_IRR_PACKED;
+        if (frame.t < LOCK_AFTER) continue;
+        if (!(frame.data[0] & 0x80)) {
+            ++unlocked;
+            continue;
+        }
+        uint64_t stamp = 0;
+        for (int i = 0; i < 6; ++i) stamp |= (uint64_t)frame.data[2 + i] << (8 * i);
+        double age_us = master_us(frame.t) - (double)stamp;
+        if (-age_us > stamp_early_us) stamp_early_us = -age_us;
+        if (!packed && age_us / 1000.0 > stamp_late_ms) stamp_late_ms = age_us / 1000.0;
+        stamp_ok = stamp_ok && age_us > -50.0 && age_us < (packed ? 1100000.0 : 50000.0);
+    }
+    /* Heartbeat seconds are the master's once locked, give or take the
+       second turning over while the frame waits. */
+    bool seconds_ok = true;
+    for (const sim::Frame& frame : sim::can_log()) {
+        if (frame.id != CAN_HEARTBEAT) continue;
+        if (frame.len != 5) {
+            seconds_ok = false;
+            continue;
+        }
+        if (frame.t < LOCK_AFTER) continue;
+        uint32_t seconds;
+        memcpy(&seconds, &frame.data[1], 4);
+        double expect = master_us(frame.t) / 1e6;
+        seconds_ok = seconds_ok && seconds <= expect && seconds > expect - 1.1;
+    }
+    printf("SAMPLE_TIME: %u for %u measurement frames, %u unlocked, at most %.1f us early, "
+           "float frames %.1f ms late; "
+           "heartbeat seconds %s\n", (unsigned)stamps, (unsigned)measurements, (unsigned)unlocked,
+           stamp_early_us, stamp_late_ms, seconds_ok ? "on the master's clock" : "wrong");
+    stamp_ok = stamp_ok && stamps == measurements && unlocked == 0 && seconds_ok;
+
+    /* The dump: each record back to simulated time, against the sensors. */
+    uint32_t dumped_rtd = 0, dumped_irr = 0, dump_ends = 0;
+    uint16_t end_sent = 0, end_lost = 0;
+    double dump_rtd_error = 0.0, dump_irr_error = 0.0, dump_ms = 0.0;
+    bool dump_ok = true;
+    for (const sim::Frame& frame : sim::can_log()) {
+        if (frame.id == CAN_LOG_DUMP_END && frame.len == 8) {
+            memcpy(&end_sent, &frame.data[0], 2);
+            memcpy(&end_lost, &frame.data[2], 2);
+            dump_ms = (double)(frame.t - dump_at) / sim::MS;
+            ++dump_ends;
+        }
+        if (frame.id != CAN_LOG_DUMP) continue;
+        if (frame.len != 8) {
+            dump_ok = false;
+            continue;
+        }
+        uint32_t time_ms;
+        int16_t value;
+        memcpy(&time_ms, &frame.data[0], 4);
+        memcpy(&value, &frame.data[4], 2);
+        uint8_t channel = frame.data[6];
+        sim::ns_t t = (sim::ns_t)((time_ms * 1000.0 - MASTER_EPOCH_US) / (1.0 + MASTER_PPM * 1e-6) * 1000.0);
+        dump_ok = dump_ok && time_ms >= dump_from_ms && time_ms < dump_to_ms && frame.data[7] == 0x01;
+        if (channel & 0x80) {
+            int idx = channel & 0x7F;
+            dump_ok = dump_ok && idx < NUM_IRRAD;
+            if (idx >= NUM_IRRAD) continue;
+            double error = fabs(value / 10.0 - irradiance(idx, t));
+            if (error > dump_irr_error) dump_irr_error = error;
+            ++dumped_irr;
+        } else {
+            int rtd = channel < 8 ? RTD_OF_INDEX[channel] : -1;
+            dump_ok = dump_ok && rtd >= 0;
+            if (rtd < 0) continue;
+            double error = fabs(value / 100.0 - rtd_temperature(rtd, t));
+            if (error > dump_rtd_error) dump_rtd_error = error;
+            ++dumped_rtd;
+        }
+    }
+    double span_s = (double)DUMP_SPAN / sim::S;
+    printf("log dump: %u RTD and %u irradiance samples of %.0f s in %.0f ms, %u lost, "
+           "worst error %.3f C, %.3f W/m^2\n", (unsigned)dumped_rtd, (unsigned)dumped_irr, span_s, dump_ms,
+           end_lost, dump_rtd_error, dump_irr_error);
+    dump_ok = dump_ok && dump_ends == 1 && end_sent == dumped_rtd + dumped_irr && end_lost == 0;
+    dump_ok = dump_ok && fabs(dumped_rtd - NUM_RTD * RTD_HZ_AFTER * span_s) <= NUM_RTD;
+    dump_ok = dump_ok && fabs(dumped_irr - NUM_IRRAD * IRR_HZ_AFTER * span_s) <= NUM_IRRAD;
+    dump_ok = dump_ok && dump_rtd_error < 0.5 && dump_irr_error < 0.5;
+
+    bool timing_ok = fabs(cycle.mean_ms - 1000.0) < 0.5 && diag_reports >= seconds / 10 - 2;
+    timing_ok = timing_ok && abs(diag_drift) < 100 && diag_jitter < 5000;
+    printf("RTD max error: %.4f C over %u frames\n", max_error, (unsigned)rtd_frames);
+    uint32_t rtd_bytes = 0;
+    for (int idx = 0; idx < 8; ++idx) rtd_bytes += rtds[idx]->bytes();
+    if (rtd_frames > 0) printf("RTD SPI: %.2f bytes per sample\n", (double)rtd_bytes / rtd_frames);
+    // One-shot conversions: Vbias only for a round, each conversion started
+    // once it settled and read once it is done
+    double bias_duty = 0.0;
+    uint32_t one_shots = 0, unsettled = 0, stale = 0;
+    for (int idx = 0; idx < 8; ++idx) {
+        bias_duty = std::max(bias_duty, (double)rtds[idx]->bias_time() / duration);
+        one_shots += rtds[idx]->one_shots();
+        unsettled += rtds[idx]->unsettled();
+        stale += rtds[idx]->stale_reads();
+    }
+    printf("RTD Vbias: %.1f %% of the time at most, %u one-shot conversions, %u unsettled, %u read early\n",
+           100.0 * bias_duty, (unsigned)one_shots, (unsigned)unsettled, (unsigned)stale);
+    bool one_shot_ok = one_shots > 0 && unsettled == 0 && stale == 0 && bias_duty < 0.5;
+    printf("RTD SPI timing over %u bursts: ", (unsigned)rtd_probe.bursts());
+    rtd_probe.print(stdout);
+    bool spi_timing_ok = rtd_probe.bursts() > 0 && !*rtd_probe.violations();
+
+    bool ok = cycle.count > 0 && rtd_frames > 0 && sim::can_count(CAN_IRR_MEAS) > 0 && max_error < 0.5;
+    ok = ok && cycle.max_ms < 1100.0 && timing_ok && tx_ok && irr_ok && rtd_ok && packed_ok && fault_ok && rx_ok;
+    ok = ok && rtd_fault_ok;
+    ok = ok && stamp_ok && dump_ok && quiet_ok && one_shot_ok && spi_timing_ok;
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,149 @@
+/**
+ * @file blackbody_b.cpp
+ * @brief Host simulation of the Blackbody B firmware
+ * (blackbody_b/fw/src/main.cpp) with a TSL2591 on the I2C bus and its INT pin
+ * on D6. Reports CAN output rates, and at the end requests the transmit
+ * queue statistics, which must show no dropped frame.
+ *
+ * Other nodes' traffic must stay out of the RX FIFO, and a burst of commands
+ * twice as long as the FIFO must all arrive without raising a fault.
+ *
+ * A time master on the bus runs 40 ppm fast from a different epoch; once
+ * locked, every irradiance frame's CAN_SAMPLE_TIME must be on its clock.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note Usage: blackbody_b [-t seconds] [-v]
+ */
+#include "mbed.h"
+#include <cstdlib>
+#include "models/tsl2591_model.h"
+#include "report.h"
+
+#define CAN_HEARTBEAT   0x620
+#define CAN_SET_MODE    0x621
+#define CAN_BB_FAULT    0x622
+#define CAN_IRR_MEAS    0x627
+#define CAN_TX_STATS_REQ 0x629
+#define CAN_TX_STATS    0x62A
+#define CAN_TIME_SYNC   0x62D
+#define CAN_TIME_FUP    0x62E
+#define CAN_SAMPLE_TIME 0x62F
+#define CAN_FOREIGN     0x100
+#define FOREIGN_PERIOD  (20 * sim::MS)
+#define COMMAND_BURST   (2 * sim::CAN_RX_FIFO_DEPTH)
+
+/* The time master, see time_sync.hpp. */
+#define MASTER_EPOCH_US 5000000.0
+#define MASTER_PPM      40.0
+#define SYNC_PHASE      (613 * sim::MS)
+#define FUP_DELAY       (2 * sim::MS)
+#define LOCK_AFTER      (10 * sim::S)
+
+/* The master's clock at simulated time t, us. */
+static double master_us(sim::ns_t t) {
+    return MASTER_EPOCH_US + t / 1000.0 * (1.0 + MASTER_PPM * 1e-6);
+}
+
+/* Firmware main(), renamed at compile time. */
+int blackbody_main(void);
+
+int main(int argc, char** argv) {
+    double seconds = 3600.0;
+    bool verbose = false;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-t") && i + 1 < argc) seconds = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-v")) verbose = true;
+    }
+
+    Tsl2591Model irrad(D4, D6);
+    irrad.set_light(50.0, 8.0);
+
+    sim::ns_t duration = (sim::ns_t)(seconds * sim::S);
+    const uint8_t tx_stats_req[1] = { 0 };
+    sim::ns_t stats_at = duration - sim::S;
+    sim::can_inject(stats_at, CAN_TX_STATS_REQ, tx_stats_req, 1);
+    const uint8_t run[1] = { 0x01 };
+    for (int i = 0; i < COMMAND_BURST; ++i) {
+        sim::can_inject(duration / 2 + i * sim::can_frame_time(1, 100000), CAN_SET_MODE, run, 1);
+    }
+    uint32_t foreign = 0;
+    const uint8_t payload[8] = { 0 };
+    for (sim::ns_t t = FOREIGN_PERIOD / 2; t < duration; t += FOREIGN_PERIOD, ++foreign) {
+        sim::can_inject(t, CAN_FOREIGN, payload, 8);
+    }
+    uint32_t syncs = 0;
+    for (sim::ns_t t = SYNC_PHASE; t + FUP_DELAY < duration; t += sim::S, ++syncs) {
+        uint8_t sync[1] = { (uint8_t)syncs };
+        uint8_t fup[7] = { (uint8_t)syncs };
+        uint64_t stamp = (uint64_t)master_us(t);
+        for (int i = 0; i < 6; ++i) fup[1 + i] = stamp >> (8 * i);
+        sim::can_inject(t, CAN_TIME_SYNC, sync, 1);
+        sim::can_inject(t + FUP_DELAY, CAN_TIME_FUP, fup, 7);
+    }
+    double wall = sim::run([]() { blackbody_main(); }, duration, !verbose);
+
+    sim::print_run_summary(stdout, "blackbody_b", duration, wall);
+    sim::print_can_summary(stdout);
+
+    sim::IntervalStats heartbeat = sim::can_intervals(CAN_HEARTBEAT);
+    sim::IntervalStats samples = sim::can_intervals(CAN_IRR_MEAS);
+    printf("heartbeat period: mean %.2f ms\n", heartbeat.mean_ms);
+    printf("irradiance period: mean %.2f ms, min %.2f ms, max %.2f ms\n",
+           samples.mean_ms, samples.min_ms, samples.max_ms);
+
+    printf("irradiance sensor: %u integrations, %u power toggles\n",
+           (unsigned)irrad.cycles(), (unsigned)irrad.power_toggles());
+
+    uint32_t stats_replies = 0;
+    bool tx_ok = true;
+    for (const sim::Frame& frame : sim::can_log()) {
+        if (frame.id != CAN_TX_STATS || frame.len != 8) continue;
+        uint16_t dropped;
+        uint32_t sent;
+        memcpy(&dropped, &frame.data[2], 2);
+        memcpy(&sent, &frame.data[4], 4);
+        printf("TX priority %u: %u sent, %u dropped, high water %u\n",
+               frame.data[0], (unsigned)sent, dropped, frame.data[1]);
+        tx_ok = tx_ok && dropped == 0;
+        ++stats_replies;
+    }
+
+    double reply_ms = -1.0;
+    for (const sim::Frame& frame : sim::can_log()) {
+        if (frame.id != CAN_TX_STATS) continue;
+        reply_ms = (double)(frame.t - sim::can_frame_time(8, 100000) - stats_at) / sim::MS;
+        break;
+    }
+    sim::CanStats can = sim::can_stats();
+    printf("command latency %.3f ms; %u commands received, %u of %u foreign frames filtered, %u overruns, %u faults\n",
+           reply_ms, (unsigned)can.rx_ok, (unsigned)can.rx_filtered, (unsigned)foreign,
+           (unsigned)can.rx_overrun, (unsigned)sim::can_count(CAN_BB_FAULT));
+    bool rx_ok = reply_ms >= 0.0 && reply_ms < 1.0 && sim::can_count(CAN_BB_FAULT) == 0;
+    rx_ok = rx_ok && can.rx_filtered == foreign && can.rx_overrun == 0 && can.rx_ok == 1 + COMMAND_BURST + 2 * syncs;
+
+    /* A sample is read, converted and queued within a few ms. */
+    uint32_t stamps = 0;
+    bool stamp_ok = true;
+    for (const sim::Frame& frame : sim::can_log()) {
+        if (frame.id != CAN_SAMPLE_TIME) continue;
+        ++stamps;
+        stamp_ok = stamp_ok && frame.len == 8 && (frame.data[0] & 0x7F) == CAN_IRR_MEAS - 0x600;
+        if (!stamp_ok || frame.t < LOCK_AFTER) continue;
+        uint64_t stamp = 0;
+        for (int i = 0; i < 6; ++i) stamp |= (uint64_t)frame.data[2 + i] << (8 * i);
+        double age_us = master_us(frame.t) - (double)stamp;
+        stamp_ok = (frame.data[0] & 0x80) && age_us > -50.0 && age_us < 20000.0;
+    }
+    printf("SAMPLE_TIME: %u for %u irradiance frames, %s\n", (unsigned)stamps,
+           (unsigned)sim::can_count(CAN_IRR_MEAS), stamp_ok ? "on the master's clock" : "wrong");
+    stamp_ok = stamp_ok && stamps == sim::can_count(CAN_IRR_MEAS);
+
+    /* Streams at the 10 Hz default without power cycling per sample. */
+    bool ok = heartbeat.count > 0 && samples.count > 0;
+    ok = ok && samples.mean_ms > 95.0 && samples.mean_ms < 105.0;
+    ok = ok && irrad.power_toggles() < 4;
+    ok = ok && tx_ok && stats_replies == 3 && rx_ok && stamp_ok;
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
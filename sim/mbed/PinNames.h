@@ -0,0 +1,80 @@
+/**
+ * @file PinNames.h
+ * @brief Host stand-in for the NUCLEO_L432KC PinNames.h. Pin values follow the
+ * STM32 port/pin encoding so that the Arduino aliases resolve to the same
+ * physical pins they do on the Nucleo-32.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#pragma once
+
+/* Port and pin number of a PinName, as in the STM32 PinNamesTypes.h. */
+#define STM_PORT(X) (((uint32_t)(X) >> 4) & 0xF)
+#define STM_PIN(X)  ((uint32_t)(X) & 0xF)
+
+typedef enum {
+    PA_0  = 0x00, PA_1  = 0x01, PA_2  = 0x02, PA_3  = 0x03,
+    PA_4  = 0x04, PA_5  = 0x05, PA_6  = 0x06, PA_7  = 0x07,
+    PA_8  = 0x08, PA_9  = 0x09, PA_10 = 0x0A, PA_11 = 0x0B,
+    PA_12 = 0x0C, PA_13 = 0x0D, PA_14 = 0x0E, PA_15 = 0x0F,
+
+    PB_0  = 0x10, PB_1  = 0x11, PB_3  = 0x13, PB_4  = 0x14,
+    PB_5  = 0x15, PB_6  = 0x16, PB_7  = 0x17,
+
+    PC_14 = 0x2E, PC_15 = 0x2F,
+
+    /* Arduino Nano connector. */
+    A0  = PA_0,
+    A1  = PA_1,
+    A2  = PA_3,
+    A3  = PA_4,
+    A4  = PA_5,
+    A5  = PA_6,
+    A6  = PA_7,
+    A7  = PA_2,     // Shared with USBTX (VCP).
+
+    D0  = PA_10,
+    D1  = PA_9,
+    D2  = PA_12,
+    D3  = PB_0,
+    D4  = PB_7,
+    D5  = PB_6,
+    D6  = PB_1,
+    D7  = PC_14,
+    D8  = PC_15,
+    D9  = PA_8,
+    D10 = PA_11,
+    D11 = PB_5,
+    D12 = PB_4,
+    D13 = PB_3,
+
+    /* Board peripherals. */
+    LED1    = PB_3,
+    USBTX   = PA_2,
+    USBRX   = PA_15,
+    I2C_SCL = PB_6,
+    I2C_SDA = PB_7,
+    SPI_MOSI = PB_5,
+    SPI_MISO = PB_4,
+    SPI_SCK  = PB_3,
+
+    /* Number of simulated pin slots. */
+    PIN_COUNT = 0x30,
+
+    NC = (int)0xFFFFFFFF
+} PinName;
+
+typedef enum {
+    PIN_INPUT,
+    PIN_OUTPUT
+} PinDirection;
+
+typedef enum {
+    PullNone  = 0,
+    PullUp    = 1,
+    PullDown  = 2,
+    OpenDrainPullUp = 3,
+    OpenDrainNoPull = 4,
+    OpenDrainPullDown = 5,
+    PullDefault = PullNone
+} PinMode;
@@ -0,0 +1,611 @@
+/**
+ * @file mbed.h
+ * @brief Host stand-in for mbed-os 6. Provides the subset of the drivers, RTOS
+ * and events APIs used by the Blackbody firmware, backed by the virtual-time
+ * kernel in sim.h. Signatures mirror mbed-os so that firmware sources compile
+ * unmodified.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#pragma once
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <utility>
+#include "PinNames.h"
+#include "sim.h"
+
+/* Device capabilities of the NUCLEO_L432KC target. */
+#define DEVICE_SPI_ASYNCH 1
+#define DEVICE_I2C_ASYNCH 1
+
+/* GPIO HAL ****************************************************************/
+
+/**
+ * @brief Pin handle of the STM32 HAL, laid out as on the target so that
+ * sizeof() of drivers built on it means something. Only pin is used here.
+ */
+typedef struct {
+    uint32_t mask;
+    volatile uint32_t* reg_in;
+    volatile uint32_t* reg_set;
+    volatile uint32_t* reg_clr;
+    PinName pin;
+    void* gpio;
+} gpio_t;
+
+inline void gpio_init(gpio_t* obj, PinName pin) { *obj = gpio_t(); obj->pin = pin; }
+inline void gpio_init_in_ex(gpio_t* obj, PinName pin, PinMode mode) { (void)mode; gpio_init(obj, pin); }
+inline void gpio_init_out_ex(gpio_t* obj, PinName pin, int value) { gpio_init(obj, pin); sim::pin_write(pin, value ? 1 : 0); }
+inline void gpio_mode(gpio_t* obj, PinMode mode) { (void)obj; (void)mode; }
+inline void gpio_init_inout(gpio_t* obj, PinName pin, PinDirection direction, PinMode mode, int value) {
+    if (direction == PIN_OUTPUT) gpio_init_out_ex(obj, pin, value);
+    else gpio_init_in_ex(obj, pin, mode);
+}
+inline int gpio_is_connected(const gpio_t* obj) { return obj->pin != NC; }
+
+/* Open-drain pins released high read back high: every pin is taken as
+   pulled up by whatever it shares a net with. */
+inline void gpio_write(gpio_t* obj, int value) { sim::charge(sim::costs().gpio_write); sim::pin_write(obj->pin, value ? 1 : 0); }
+inline int gpio_read(gpio_t* obj) { sim::charge(sim::costs().gpio_read); return sim::pin_read(obj->pin); }
+
+/* GPIO registers **********************************************************/
+
+namespace sim {
+
+/**
+ * @brief One GPIO port register of the STM32, for firmware that bypasses the
+ * HAL. A store to BSRR drives the pins named in its low half high and those
+ * in its high half low (set wins); a store to BRR drives pins low; a load of
+ * IDR samples the port. Each access is charged sim::costs().gpio_reg_write
+ * or gpio_reg_read.
+ */
+class GpioRegister {
+    public:
+        enum Kind { IDR, BSRR, BRR };
+
+        GpioRegister(uint8_t port, Kind kind) : _port(port), _kind(kind) {}
+
+        GpioRegister& operator=(uint32_t value) {
+            charge(costs().gpio_reg_write);
+            for (uint32_t n = 0; n < 16; ++n) {
+                PinName pin = (PinName)(_port << 4 | n);
+                if (_kind == BRR) {
+                    if (value >> n & 0x1) pin_write(pin, 0);
+                } else if (value >> n & 0x1) {
+                    pin_write(pin, 1);
+                } else if (value >> (n + 16) & 0x1) {
+                    pin_write(pin, 0);
+                }
+            }
+            return *this;
+        }
+
+        operator uint32_t() const {
+            charge(costs().gpio_reg_read);
+            uint32_t value = 0;
+            for (uint32_t n = 0; n < 16; ++n) {
+                PinName pin = (PinName)(_port << 4 | n);
+                if ((_port << 4 | n) < PIN_COUNT) value |= (uint32_t)pin_read(pin) << n;
+            }
+            return value;
+        }
+
+    private:
+        uint8_t _port;
+        Kind _kind;
+};
+
+} // namespace sim
+
+/**
+ * @brief The registers of a GPIO port the shim models, named as in CMSIS.
+ */
+typedef struct {
+    sim::GpioRegister IDR;
+    sim::GpioRegister BSRR;
+    sim::GpioRegister BRR;
+} GPIO_TypeDef;
+
+extern GPIO_TypeDef sim_gpio_ports[3];
+
+#define GPIOA (&sim_gpio_ports[0])
+#define GPIOB (&sim_gpio_ports[1])
+#define GPIOC (&sim_gpio_ports[2])
+
+namespace mbed {
+
+/**
+ * @brief Report a fatal error and halt, as mbed does for bad pinmaps and the
+ * like. On the host the process exits with a failure status.
+ */
+void error(const char* format, ...);
+
+/* Callback ****************************************************************/
+
+template <typename F>
+class Callback;
+
+template <typename R, typename... Args>
+class Callback<R(Args...)> : public std::function<R(Args...)> {
+    public:
+        using std::function<R(Args...)>::function;
+        Callback() = default;
+
+        template <typename T>
+        Callback(T* obj, R (T::*method)(Args...)) :
+            std::function<R(Args...)>([obj, method](Args... args) { return (obj->*method)(args...); }) {}
+};
+
+template <typename R, typename... Args>
+Callback<R(Args...)> callback(R (*func)(Args...)) { return Callback<R(Args...)>(func); }
+
+template <typename T, typename R, typename... Args>
+Callback<R(Args...)> callback(T* obj, R (T::*method)(Args...)) { return Callback<R(Args...)>(obj, method); }
+
+/* Digital IO **************************************************************/
+
+class DigitalOut {
+    public:
+        DigitalOut(PinName pin, int value = 0) { gpio_init_out_ex(&gpio, pin, value); }
+        void write(int value) { gpio_write(&gpio, value); }
+        int read(void) { return sim::pin_level(gpio.pin); }
+        int is_connected(void) { return gpio_is_connected(&gpio); }
+        DigitalOut& operator=(int value) { write(value); return *this; }
+        DigitalOut& operator=(DigitalOut& rhs) { write(rhs.read()); return *this; }
+        operator int() { return read(); }
+
+    protected:
+        gpio_t gpio;
+};
+
+class DigitalIn {
+    public:
+        DigitalIn(PinName pin, PinMode mode = PullDefault) { gpio_init_in_ex(&gpio, pin, mode); }
+        int read(void) { return gpio_read(&gpio); }
+        void mode(PinMode mode) { gpio_mode(&gpio, mode); }
+        int is_connected(void) { return gpio_is_connected(&gpio); }
+        operator int() { return read(); }
+
+    protected:
+        gpio_t gpio;
+};
+
+class InterruptIn {
+    public:
+        InterruptIn(PinName pin, PinMode mode = PullDefault);
+        ~InterruptIn();
+        int read(void) { sim::charge(sim::costs().gpio_read); return sim::pin_level(_pin); }
+        operator int() { return read(); }
+        void rise(Callback<void()> func) { _rise = func; }
+        void fall(Callback<void()> func) { _fall = func; }
+        void mode(PinMode mode) { (void)mode; }
+        void enable_irq(void) { _enabled = true; }
+        void disable_irq(void) { _enabled = false; }
+
+    private:
+        PinName _pin;
+        int _listener;
+        bool _enabled;
+        Callback<void()> _rise;
+        Callback<void()> _fall;
+};
+
+/** @brief Completion callback of the asynchronous SPI and I2C transfers. */
+typedef Callback<void(int)> event_callback_t;
+
+/* I2C *********************************************************************/
+
+#define I2C_EVENT_ERROR               (1 << 1)
+#define I2C_EVENT_ERROR_NO_SLAVE      (1 << 2)
+#define I2C_EVENT_TRANSFER_COMPLETE   (1 << 3)
+#define I2C_EVENT_TRANSFER_EARLY_NACK (1 << 4)
+#define I2C_EVENT_ALL                 (I2C_EVENT_ERROR | I2C_EVENT_TRANSFER_COMPLETE | \
+                                       I2C_EVENT_ERROR_NO_SLAVE | I2C_EVENT_TRANSFER_EARLY_NACK)
+
+class I2C {
+    public:
+        enum Acknowledge { NoACK = 0, ACK = 1 };
+
+        I2C(PinName sda, PinName scl) : _sda(sda), _scl(scl), _hz(100000), _restart(false), _busy(false) {}
+        void frequency(int hz) { _hz = hz; }
+        int read(int address, char* data, int length, bool repeated = false);
+        int write(int address, const char* data, int length, bool repeated = false);
+        void lock(void) {}
+        void unlock(void) {}
+
+        /**
+         * @brief Write tx_length bytes, then read rx_length bytes after a
+         * repeated start, in the background. callback runs in "ISR" context
+         * with the event that ended the transfer. Returns -1 while a transfer
+         * is already in progress.
+         */
+        int transfer(int address, const char* tx_buffer, int tx_length, char* rx_buffer, int rx_length,
+                     const event_callback_t& callback, int event = I2C_EVENT_TRANSFER_COMPLETE,
+                     bool repeated = false);
+
+    private:
+        void _account(int length, bool repeated, bool charge);
+
+        PinName _sda;
+        PinName _scl;
+        int _hz;
+        bool _restart;
+        bool _busy;
+};
+
+/* SPI *********************************************************************/
+
+enum DMAUsage {
+    DMA_USAGE_NEVER,
+    DMA_USAGE_OPPORTUNISTIC,
+    DMA_USAGE_ALWAYS,
+    DMA_USAGE_TEMPORARY_ALLOCATED,
+    DMA_USAGE_ALLOCATED
+};
+
+#define SPI_EVENT_ERROR       (1 << 1)
+#define SPI_EVENT_COMPLETE    (1 << 2)
+#define SPI_EVENT_RX_OVERFLOW (1 << 3)
+#define SPI_EVENT_ALL         (SPI_EVENT_ERROR | SPI_EVENT_COMPLETE | SPI_EVENT_RX_OVERFLOW)
+
+
+/**
+ * @brief SPI1 master. Bytes are exchanged with the sim::SPIDevice targets
+ * attached to the SCLK pin. Blocking transfers charge the CPU for the bus time;
+ * asynchronous (DMA) transfers leave it free and complete from a timer.
+ *
+ * @note Like mbed, the peripheral is reinitialized whenever a different SPI
+ * object uses it. That drives SCLK back to its reset level, which targets that
+ * are already selected see as a stray clock edge.
+ */
+class SPI {
+    public:
+        SPI(PinName mosi, PinName miso, PinName sclk, PinName ssel = NC);
+        void format(int bits, int mode = 0);
+        void frequency(int hz = 1000000);
+        int write(int value);
+        int write(const char* tx_buffer, int tx_length, char* rx_buffer, int rx_length);
+        void lock(void) {}
+        void unlock(void) {}
+        void set_dma_usage(DMAUsage usage) { _dma = usage; }
+
+        template <typename Type>
+        int transfer(const Type* tx_buffer, int tx_length, Type* rx_buffer, int rx_length,
+                     const event_callback_t& callback, int event = SPI_EVENT_COMPLETE) {
+            static_assert(sizeof(Type) == 1, "only 8-bit frames are simulated");
+            return _transfer(reinterpret_cast<const uint8_t*>(tx_buffer), tx_length,
+                             reinterpret_cast<uint8_t*>(rx_buffer), rx_length, callback, event);
+        }
+
+    private:
+        void _acquire(void);
+        sim::ns_t _bus_time(int length) const;
+        int _transfer(const uint8_t* tx, int tx_length, uint8_t* rx, int rx_length,
+                      const event_callback_t& callback, int event);
+
+        static SPI* _owner;
+        static bool _busy;
+
+        PinName _sclk;
+        int _bits;
+        int _mode;
+        int _hz;
+        DMAUsage _dma;
+};
+
+/* CAN *********************************************************************/
+
+enum CANFormat { CANStandard = 0, CANExtended = 1, CANAny = 2 };
+enum CANType { CANData = 0, CANRemote = 1 };
+
+class CANMessage {
+    public:
+        CANMessage() : id(0), len(8), format(CANStandard), type(CANData) { memset(data, 0, sizeof(data)); }
+        CANMessage(unsigned int _id, const unsigned char* _data, unsigned char _len = 8,
+                   CANType _type = CANData, CANFormat _format = CANStandard) :
+            id(_id), len(_len > 8 ? 8 : _len), format(_format), type(_type) {
+            memset(data, 0, sizeof(data));
+            memcpy(data, _data, len);
+        }
+        CANMessage(unsigned int _id, const char* _data, unsigned char _len = 8,
+                   CANType _type = CANData, CANFormat _format = CANStandard) :
+            CANMessage(_id, reinterpret_cast<const unsigned char*>(_data), _len, _type, _format) {}
+        CANMessage(unsigned int _id, CANFormat _format = CANStandard) :
+            id(_id), len(0), format(_format), type(CANRemote) { memset(data, 0, sizeof(data)); }
+
+        unsigned int id;
+        unsigned char data[8];
+        unsigned char len;
+        CANFormat format;
+        CANType type;
+};
+
+class CAN {
+    public:
+        enum Mode { Reset = 0, Normal, Silent, LocalTest, GlobalTest, SilentTest };
+        enum IrqType { RxIrq = 0, TxIrq, EwIrq, DoIrq, WuIrq, EpIrq, AlIrq, BeIrq, IdIrq, IrqCnt };
+
+        CAN(PinName rd, PinName td);
+        CAN(PinName rd, PinName td, int hz);
+        ~CAN();
+        int frequency(int hz);
+        int write(CANMessage msg);
+        int read(CANMessage& msg, int handle = 0);
+        void reset(void) {}
+        int mode(Mode mode);
+        int filter(unsigned int id, unsigned int mask, CANFormat format = CANAny, int handle = 0);
+        unsigned char rderror(void) { return 0; }
+        unsigned char tderror(void) { return 0; }
+        void attach(Callback<void()> func, IrqType type = RxIrq);
+
+        /** @brief Simulator hook: the controller behind this object. */
+        sim::CanNode* node(void) { return _node; }
+
+    protected:
+        /** @brief As mbed, write and read hold these; the mutex is elided. */
+        virtual void lock(void) {}
+        virtual void unlock(void) {}
+
+    private:
+        sim::CanNode* _node;
+};
+
+/* Time ********************************************************************/
+
+class Timer {
+    public:
+        Timer() : _running(false), _start(0), _acc(0) {}
+        void start(void) { if (!_running) { _start = sim::now(); _running = true; } }
+        void stop(void) { if (_running) { _acc += sim::now() - _start; _running = false; } }
+        void reset(void) { _acc = 0; _start = sim::now(); }
+        std::chrono::microseconds elapsed_time(void) const {
+            return std::chrono::microseconds((_acc + (_running ? sim::now() - _start : 0)) / sim::US);
+        }
+
+    private:
+        bool _running;
+        sim::ns_t _start;
+        sim::ns_t _acc;
+};
+
+class Timeout {
+    public:
+        Timeout() : _timer(-1) {}
+        ~Timeout() { detach(); }
+        template <typename Rep, typename Period>
+        void attach(Callback<void()> func, std::chrono::duration<Rep, Period> t) {
+            detach();
+            _func = func;
+            _timer = sim::schedule(sim::now() + std::chrono::duration_cast<std::chrono::nanoseconds>(t).count(),
+                                   [this]() { _timer = -1; _func(); });
+        }
+        void detach(void) { if (_timer >= 0) { sim::cancel(_timer); _timer = -1; } }
+
+    private:
+        int _timer;
+        Callback<void()> _func;
+};
+
+/**
+ * @brief Periodic timer. Like mbed's Ticker, each expiry is scheduled from the
+ * previous deadline, not from when the callback ran.
+ */
+class Ticker {
+    public:
+        Ticker() : _timer(-1), _period(0), _next(0) {}
+        ~Ticker() { detach(); }
+        template <typename Rep, typename Period>
+        void attach(Callback<void()> func, std::chrono::duration<Rep, Period> t) {
+            detach();
+            _func = func;
+            _period = std::chrono::duration_cast<std::chrono::nanoseconds>(t).count();
+            if (_period == 0) _period = sim::US;
+            _next = sim::now() + _period;
+            _arm();
+        }
+        void detach(void) { if (_timer >= 0) { sim::cancel(_timer); _timer = -1; } }
+
+    private:
+        void _arm(void) {
+            _timer = sim::schedule(_next, [this]() {
+                _next += _period;
+                _arm();
+                _func();
+            });
+        }
+
+        int _timer;
+        sim::ns_t _period;
+        sim::ns_t _next;
+        Callback<void()> _func;
+};
+
+inline void wait_us(int us) { sim::charge((sim::ns_t)us * sim::US); }
+
+/**
+ * @brief mbed's calibrated spin; on the target it only errs long, by the
+ * call overhead.
+ */
+inline void wait_ns(unsigned int ns) { sim::charge((sim::ns_t)ns); }
+
+/**
+ * @brief Masks interrupts for its lifetime, see sim::critical_enter.
+ */
+class CriticalSectionLock {
+    public:
+        CriticalSectionLock() { sim::critical_enter(); }
+        ~CriticalSectionLock() { sim::critical_exit(); }
+        static void enable(void) { sim::critical_enter(); }
+        static void disable(void) { sim::critical_exit(); }
+};
+
+} // namespace mbed
+
+/* Events ******************************************************************/
+
+#define EVENTS_EVENT_SIZE (64)
+
+namespace events {
+
+/**
+ * @brief Single consumer event queue. Capacity follows the byte size given at
+ * construction, one EVENTS_EVENT_SIZE slot per pending event; posts to a full
+ * queue fail and return 0 like mbed's.
+ */
+class EventQueue {
+    public:
+        EventQueue(unsigned size = 32 * EVENTS_EVENT_SIZE, unsigned char* buffer = nullptr) :
+            _capacity(size / EVENTS_EVENT_SIZE), _next_id(1), _break(false) { (void)buffer; }
+        ~EventQueue();
+
+        template <typename F>
+        int call(F f) { return _post(mbed::Callback<void()>(f)); }
+
+        template <typename F, typename... Args>
+        int call(F f, Args... args) { return _post([=]() { f(args...); }); }
+
+        template <typename Rep, typename Period, typename F>
+        int call_in(std::chrono::duration<Rep, Period> t, F f) {
+            return _defer(std::chrono::duration_cast<std::chrono::nanoseconds>(t).count(), 0, mbed::Callback<void()>(f));
+        }
+
+        template <typename Rep, typename Period, typename F>
+        int call_every(std::chrono::duration<Rep, Period> t, F f) {
+            sim::ns_t period = std::chrono::duration_cast<std::chrono::nanoseconds>(t).count();
+            return _defer(period, period, mbed::Callback<void()>(f));
+        }
+
+        bool cancel(int id);
+
+        /** @brief Run pending events, then block for more, forever. */
+        void dispatch_forever(void);
+
+        /** @brief Run the events that are pending now and return. */
+        void dispatch_once(void);
+
+        void break_dispatch(void) { _break = true; }
+
+        /** @brief Simulator hook: number of posts rejected because the queue was full. */
+        uint32_t overflows(void) const { return _overflows; }
+
+    private:
+        struct Pending {
+            int id;
+            mbed::Callback<void()> func;
+        };
+        struct Deferred {
+            int id;
+            int timer;
+            sim::ns_t period;
+            sim::ns_t next;
+            mbed::Callback<void()> func;
+        };
+
+        int _post(mbed::Callback<void()> func);
+        int _defer(sim::ns_t delay, sim::ns_t period, mbed::Callback<void()> func);
+        void _arm(Deferred* d);
+
+        unsigned _capacity;
+        int _next_id;
+        bool _break;
+        uint32_t _overflows = 0;
+        std::deque<Pending> _pending;
+        std::deque<Deferred*> _deferred;
+};
+
+} // namespace events
+
+/* RTOS ********************************************************************/
+
+typedef enum {
+    osOK = 0,
+    osError = -1,
+    osErrorTimeout = -2,
+    osErrorResource = -3,
+    osErrorParameter = -4,
+    osErrorNoMemory = -5,
+    osErrorISR = -6
+} osStatus_t;
+
+/** @brief CMSIS-RTOS2 delay, in kernel ticks (1 ms). */
+inline osStatus_t osDelay(uint32_t ticks) {
+    sim::sleep_until(sim::now() + (sim::ns_t)ticks * sim::MS);
+    return osOK;
+}
+
+inline uint32_t osKernelGetTickCount(void) { return (uint32_t)(sim::now() / sim::MS); }
+
+namespace rtos {
+
+namespace Kernel {
+
+struct Clock {
+    using duration = std::chrono::milliseconds;
+    using duration_u32 = std::chrono::duration<uint32_t, std::milli>;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<Clock>;
+    static constexpr bool is_steady = true;
+    static time_point now() { return time_point(duration(sim::now() / sim::MS)); }
+};
+
+} // namespace Kernel
+
+class Semaphore {
+    public:
+        Semaphore(int32_t count = 0) : _count(count) {}
+        Semaphore(int32_t count, uint16_t max_count) : _count(count) { (void)max_count; }
+
+        void acquire(void) {
+            while (_count <= 0) sim::idle();
+            --_count;
+        }
+
+        bool try_acquire(void) {
+            if (_count <= 0) return false;
+            --_count;
+            return true;
+        }
+
+        bool try_acquire_until(Kernel::Clock::time_point abs_time) {
+            sim::ns_t limit = (sim::ns_t)abs_time.time_since_epoch().count() * sim::MS;
+            while (_count <= 0 && sim::now() < limit) sim::idle_until(limit);
+            return try_acquire();
+        }
+
+        bool try_acquire_for(Kernel::Clock::duration_u32 rel_time) {
+            sim::ns_t limit = sim::now() + (sim::ns_t)rel_time.count() * sim::MS;
+            while (_count <= 0 && sim::now() < limit) sim::idle_until(limit);
+            return try_acquire();
+        }
+
+        osStatus_t release(void) { ++_count; return osOK; }
+
+    private:
+        volatile int32_t _count;
+};
+
+namespace ThisThread {
+
+inline void sleep_for(Kernel::Clock::duration_u32 rel_time) {
+    sim::sleep_until(sim::now() + (sim::ns_t)rel_time.count() * sim::MS);
+}
+
+inline void sleep_until(Kernel::Clock::time_point abs_time) {
+    sim::ns_t t = (sim::ns_t)abs_time.time_since_epoch().count() * sim::MS;
+    if (t > sim::now()) sim::sleep_until(t);
+}
+
+} // namespace ThisThread
+
+} // namespace rtos
+
+using namespace mbed;
+using namespace events;
+using namespace rtos;
+using namespace std;
@@ -0,0 +1,776 @@
+/**
+ * @file mbed_sim.cpp
+ * @brief Virtual-time kernel and mbed driver implementations for the host
+ * shim. See sim.h.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#include "mbed.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdlib>
+#include <map>
+#include <unistd.h>
+#include <fcntl.h>
+
+namespace sim {
+
+/* Kernel ******************************************************************/
+
+namespace {
+
+struct Timer {
+    int id;
+    std::function<void()> fn;
+};
+
+struct EdgeListener {
+    int id;
+    PinName pin;
+    PinListener fn;
+};
+
+struct Kernel {
+    ns_t now = 0;
+    ns_t deadline = UINT64_MAX;
+    ns_t cpu = 0;
+    int isr_depth = 0;
+    int critical_depth = 0;
+    int next_timer = 0;
+    /* Keyed by (expiry, sequence) so that equal expiries fire in order. */
+    std::map<std::pair<ns_t, int>, Timer> timers;
+    std::map<int, std::pair<ns_t, int>> timer_keys;
+
+    uint8_t pins[PIN_COUNT] = {0};
+    std::vector<PinListener> write_listeners;
+    std::vector<PinListener> read_listeners;
+    std::vector<EdgeListener> edge_listeners;
+    int next_edge = 0;
+
+    std::multimap<int, SPIDevice*> spi_devices;
+
+    std::map<std::pair<int, uint8_t>, I2CDevice*> i2c_devices;
+    I2CStats i2c = {0, 0, 0, 0, 0};
+
+    std::vector<CanNode*> can_nodes;
+    std::vector<Frame> can_log;
+    bool can_busy = false;
+    ns_t can_busy_total = 0;
+
+    Costs costs = {
+        /* gpio_write */ 250 * NS,
+        /* gpio_read  */ 250 * NS,
+        /* i2c_setup  */ 5 * US,
+        /* can_api    */ 2 * US,
+        /* spi_setup  */ 2 * US,
+        /* spi_init   */ 10 * US,
+        /* gpio_reg_write */ 25 * NS,
+        /* gpio_reg_read  */ 25 * NS,
+    };
+};
+
+Kernel& k(void) {
+    static Kernel kernel;
+    static bool init = false;
+    if (!init) {
+        init = true;
+        /* The VCP UART owns USBTX (A7) and idles high. */
+        kernel.pins[USBTX] = 1;
+    }
+    return kernel;
+}
+
+/** Fire every timer due at or before t, advancing the clock to each. */
+void fire_due(ns_t t) {
+    Kernel& kn = k();
+    while (!kn.timers.empty() && kn.timers.begin()->first.first <= t) {
+        auto it = kn.timers.begin();
+        Timer timer = std::move(it->second);
+        kn.now = std::max(kn.now, it->first.first);
+        kn.timer_keys.erase(timer.id);
+        kn.timers.erase(it);
+        ++kn.isr_depth;
+        timer.fn();
+        --kn.isr_depth;
+    }
+}
+
+void advance_to(ns_t t) {
+    Kernel& kn = k();
+    if (t >= kn.deadline) {
+        fire_due(kn.deadline);
+        kn.now = kn.deadline;
+        throw Halt();
+    }
+    fire_due(t);
+    if (t > kn.now) kn.now = t;
+}
+
+} // namespace
+
+Costs& costs(void) { return k().costs; }
+
+ns_t now(void) { return k().now; }
+
+bool in_isr(void) { return k().isr_depth > 0; }
+
+void charge(ns_t dt) {
+    if (in_isr()) return;
+    k().cpu += dt;
+    if (k().critical_depth > 0) {
+        k().now += dt;
+        return;
+    }
+    advance_to(k().now + dt);
+}
+
+void critical_enter(void) {
+    ++k().critical_depth;
+}
+
+void critical_exit(void) {
+    if (--k().critical_depth == 0 && !in_isr()) advance_to(k().now);
+}
+
+ns_t cpu_time(void) { return k().cpu; }
+
+void sleep_until(ns_t t) {
+    if (in_isr()) return;
+    if (t < k().now) t = k().now;
+    advance_to(t);
+}
+
+void idle(void) {
+    idle_until(UINT64_MAX);
+}
+
+void idle_until(ns_t limit) {
+    Kernel& kn = k();
+    ns_t next = kn.timers.empty() ? kn.deadline : kn.timers.begin()->first.first;
+    advance_to(std::max(std::min(next, limit), kn.now));
+}
+
+int schedule(ns_t at, std::function<void()> fn) {
+    Kernel& kn = k();
+    int id = kn.next_timer++;
+    std::pair<ns_t, int> key(at, id);
+    kn.timers[key] = Timer{id, std::move(fn)};
+    kn.timer_keys[id] = key;
+    return id;
+}
+
+void cancel(int id) {
+    Kernel& kn = k();
+    auto it = kn.timer_keys.find(id);
+    if (it == kn.timer_keys.end()) return;
+    kn.timers.erase(it->second);
+    kn.timer_keys.erase(it);
+}
+
+double run(std::function<void()> entry, ns_t duration, bool quiet) {
+    Kernel& kn = k();
+    kn.deadline = kn.now + duration;
+
+    int saved_stdout = -1;
+    if (quiet) {
+        fflush(stdout);
+        saved_stdout = dup(STDOUT_FILENO);
+        int devnull = open("/dev/null", O_WRONLY);
+        dup2(devnull, STDOUT_FILENO);
+        close(devnull);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    try {
+        entry();
+    } catch (Halt&) {
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    if (quiet) {
+        fflush(stdout);
+        dup2(saved_stdout, STDOUT_FILENO);
+        close(saved_stdout);
+    }
+    kn.deadline = UINT64_MAX;
+    return std::chrono::duration<double>(end - start).count();
+}
+
+/* Pins ********************************************************************/
+
+static int pin_index(PinName pin) {
+    return (pin == NC || pin >= PIN_COUNT) ? -1 : (int)pin;
+}
+
+int pin_level(PinName pin) {
+    int idx = pin_index(pin);
+    return idx < 0 ? 0 : k().pins[idx];
+}
+
+void pin_write(PinName pin, int level) {
+    int idx = pin_index(pin);
+    if (idx < 0) return;
+    k().pins[idx] = level ? 1 : 0;
+    for (auto& listener : k().write_listeners) listener(pin, level ? 1 : 0);
+}
+
+int pin_read(PinName pin) {
+    int level = pin_level(pin);
+    if (pin_index(pin) < 0) return level;
+    for (auto& listener : k().read_listeners) listener(pin, level);
+    return level;
+}
+
+void pin_drive(PinName pin, int level) {
+    int idx = pin_index(pin);
+    if (idx < 0) return;
+    Kernel& kn = k();
+    uint8_t prev = kn.pins[idx];
+    kn.pins[idx] = level ? 1 : 0;
+    if (prev == kn.pins[idx]) return;
+    ++kn.isr_depth;
+    for (auto& listener : kn.edge_listeners) {
+        if (listener.pin == pin) listener.fn(pin, kn.pins[idx]);
+    }
+    --kn.isr_depth;
+}
+
+void on_pin_write(PinListener listener) {
+    k().write_listeners.push_back(listener);
+}
+
+void on_pin_read(PinListener listener) {
+    k().read_listeners.push_back(listener);
+}
+
+int on_pin_edge(PinName pin, PinListener listener) {
+    Kernel& kn = k();
+    kn.edge_listeners.push_back(EdgeListener{kn.next_edge, pin, listener});
+    return kn.next_edge++;
+}
+
+void remove_pin_edge(int id) {
+    auto& listeners = k().edge_listeners;
+    listeners.erase(std::remove_if(listeners.begin(), listeners.end(),
+                                   [id](const EdgeListener& l) { return l.id == id; }),
+                    listeners.end());
+}
+
+/* I2C *********************************************************************/
+
+void i2c_attach(PinName sda, uint8_t addr7, I2CDevice* device) {
+    k().i2c_devices[std::make_pair((int)sda, addr7)] = device;
+}
+
+void i2c_detach(PinName sda, uint8_t addr7) {
+    k().i2c_devices.erase(std::make_pair((int)sda, addr7));
+}
+
+I2CDevice* i2c_find(PinName sda, uint8_t addr7) {
+    auto it = k().i2c_devices.find(std::make_pair((int)sda, addr7));
+    return it == k().i2c_devices.end() ? nullptr : it->second;
+}
+
+I2CStats& i2c_stats(void) { return k().i2c; }
+
+/* SPI *********************************************************************/
+
+void spi_attach(PinName sclk, SPIDevice* device) {
+    k().spi_devices.insert(std::make_pair((int)sclk, device));
+}
+
+void spi_detach(PinName sclk, SPIDevice* device) {
+    auto range = k().spi_devices.equal_range((int)sclk);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == device) {
+            k().spi_devices.erase(it);
+            return;
+        }
+    }
+}
+
+uint8_t spi_exchange(PinName sclk, uint8_t mosi, int mode) {
+    /* Deselected targets leave MISO to the pull-up. */
+    uint8_t miso = 0xFF;
+    auto range = k().spi_devices.equal_range((int)sclk);
+    for (auto it = range.first; it != range.second; ++it) {
+        miso &= it->second->spi_transfer(mosi, mode);
+    }
+    return miso;
+}
+
+void spi_glitch(PinName sclk) {
+    auto range = k().spi_devices.equal_range((int)sclk);
+    for (auto it = range.first; it != range.second; ++it) {
+        it->second->spi_glitch();
+    }
+}
+
+/* CAN *********************************************************************/
+
+static void can_arbitrate(void);
+
+static void can_deliver(const Frame& frame, const CanNode* sender) {
+    for (CanNode* node : k().can_nodes) {
+        if (node == sender && !node->loopback) continue;
+        bool accepted = false;
+        for (const CanFilter& filter : node->filters) {
+            accepted = accepted || (filter.active && ((frame.id ^ filter.id) & filter.mask) == 0);
+        }
+        if (!accepted) {
+            ++node->stats.rx_filtered;
+            continue;
+        }
+        if ((int)node->rx_fifo.size() >= CAN_RX_FIFO_DEPTH) {
+            ++node->stats.rx_overrun;
+            continue;
+        }
+        node->rx_fifo.push_back(frame);
+        ++node->stats.rx_ok;
+        if (node->irq[0]) node->irq[0]();
+    }
+}
+
+/** Start the lowest identifier pending in any mailbox, if the bus is idle. */
+static void can_arbitrate(void) {
+    Kernel& kn = k();
+    if (kn.can_busy) return;
+    CanNode* winner = nullptr;
+    size_t slot = 0;
+    for (CanNode* node : kn.can_nodes) {
+        for (size_t i = 0; i < node->mailboxes.size(); ++i) {
+            if (winner == nullptr || node->mailboxes[i].id < winner->mailboxes[slot].id) {
+                winner = node;
+                slot = i;
+            }
+        }
+    }
+    if (winner == nullptr) return;
+
+    ns_t duration = can_frame_time(winner->mailboxes[slot].len, winner->bitrate);
+    kn.can_busy = true;
+    kn.can_busy_total += duration;
+    schedule(kn.now + duration, [winner, slot]() {
+        Kernel& kn = k();
+        Frame frame = winner->mailboxes[slot];
+        winner->mailboxes.erase(winner->mailboxes.begin() + slot);
+        frame.t = kn.now;
+        kn.can_log.push_back(frame);
+        ++winner->stats.tx_ok;
+        kn.can_busy = false;
+        can_deliver(frame, winner);
+        if (winner->irq[1]) winner->irq[1]();
+        can_arbitrate();
+    });
+}
+
+CanNode* can_node_create(void) {
+    Kernel& kn = k();
+    CanNode* node = new CanNode();
+    node->index = (int)kn.can_nodes.size();
+    node->bitrate = 100000;
+    node->loopback = false;
+    node->stats = CanStats{0, 0, 0, 0, 0};
+    for (CanFilter& filter : node->filters) filter = CanFilter{false, 0, 0};
+    node->filters[0] = CanFilter{true, 0, 0};
+    kn.can_nodes.push_back(node);
+    return node;
+}
+
+void can_node_destroy(CanNode* node) {
+    auto& nodes = k().can_nodes;
+    nodes.erase(std::remove(nodes.begin(), nodes.end(), node), nodes.end());
+    delete node;
+}
+
+bool can_node_write(CanNode* node, const Frame& frame) {
+    if ((int)node->mailboxes.size() >= CAN_MAILBOXES) {
+        ++node->stats.tx_full;
+        return false;
+    }
+    Frame f = frame;
+    f.node = node->index;
+    node->mailboxes.push_back(f);
+    can_arbitrate();
+    return true;
+}
+
+bool can_node_read(CanNode* node, Frame& frame) {
+    if (node->rx_fifo.empty()) return false;
+    frame = node->rx_fifo.front();
+    node->rx_fifo.pop_front();
+    return true;
+}
+
+ns_t can_frame_time(uint8_t len, uint32_t bitrate) {
+    /* SOF..EOF plus intermission is 47 bits; stuffing can add one bit per four
+       over the 34 + 8 * len bits it applies to. */
+    uint32_t bits = 47 + 8 * len + (34 + 8 * len - 1) / 4;
+    return (ns_t)bits * S / bitrate;
+}
+
+const std::vector<Frame>& can_log(void) { return k().can_log; }
+
+void can_inject(ns_t at, uint32_t id, const uint8_t* data, uint8_t len) {
+    Frame frame;
+    frame.t = at;
+    frame.id = id;
+    frame.len = len > 8 ? 8 : len;
+    memset(frame.data, 0, sizeof(frame.data));
+    memcpy(frame.data, data, frame.len);
+    frame.node = -1;
+    schedule(at, [frame]() { can_deliver(frame, nullptr); });
+}
+
+CanStats can_stats(void) {
+    CanStats total = {0, 0, 0, 0, 0};
+    for (CanNode* node : k().can_nodes) {
+        total.tx_ok += node->stats.tx_ok;
+        total.tx_full += node->stats.tx_full;
+        total.rx_ok += node->stats.rx_ok;
+        total.rx_overrun += node->stats.rx_overrun;
+        total.rx_filtered += node->stats.rx_filtered;
+    }
+    return total;
+}
+
+double can_bus_load(void) {
+    return k().now == 0 ? 0.0 : (double)k().can_busy_total / (double)k().now;
+}
+
+} // namespace sim
+
+/* GPIO registers **********************************************************/
+
+#define GPIO_PORT(port) { sim::GpioRegister(port, sim::GpioRegister::IDR), \
+                          sim::GpioRegister(port, sim::GpioRegister::BSRR), \
+                          sim::GpioRegister(port, sim::GpioRegister::BRR) }
+
+GPIO_TypeDef sim_gpio_ports[3] = { GPIO_PORT(0), GPIO_PORT(1), GPIO_PORT(2) };
+
+/* mbed drivers ************************************************************/
+
+namespace mbed {
+
+void error(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    exit(EXIT_FAILURE);
+}
+
+InterruptIn::InterruptIn(PinName pin, PinMode mode) : _pin(pin), _enabled(true) {
+    (void)mode;
+    _listener = sim::on_pin_edge(pin, [this](PinName, int level) {
+        if (!_enabled) return;
+        if (level && _rise) _rise();
+        if (!level && _fall) _fall();
+    });
+}
+
+InterruptIn::~InterruptIn() {
+    sim::remove_pin_edge(_listener);
+}
+
+static sim::ns_t i2c_time(int length, int hz) {
+    /* Start, address + R/W, one ack'd byte per data byte, stop. */
+    return (sim::ns_t)(2 + 9 * (1 + length)) * sim::S / (sim::ns_t)hz;
+}
+
+/** Count one address phase of length bytes, continuing the transaction if the
+    last one ended in a repeated start, and charge the CPU if it waits. */
+void I2C::_account(int length, bool repeated, bool charge) {
+    sim::I2CStats& stats = sim::i2c_stats();
+    sim::ns_t t = i2c_time(length, _hz);
+    stats.busy += t;
+    if (_restart) ++stats.restarts;
+    else ++stats.transactions;
+    stats.bytes += 1 + length;
+    _restart = repeated;
+    if (charge) sim::charge(sim::costs().i2c_setup + t);
+}
+
+int I2C::write(int address, const char* data, int length, bool repeated) {
+    sim::I2CStats& stats = sim::i2c_stats();
+    _account(length, repeated, true);
+    sim::I2CDevice* device = sim::i2c_find(_sda, (uint8_t)(address >> 1));
+    if (device == nullptr || !device->i2c_write(reinterpret_cast<const uint8_t*>(data), length)) {
+        ++stats.naks;
+        return -1;
+    }
+    return 0;
+}
+
+int I2C::read(int address, char* data, int length, bool repeated) {
+    sim::I2CStats& stats = sim::i2c_stats();
+    _account(length, repeated, true);
+    sim::I2CDevice* device = sim::i2c_find(_sda, (uint8_t)(address >> 1));
+    if (device == nullptr || !device->i2c_read(reinterpret_cast<uint8_t*>(data), length)) {
+        ++stats.naks;
+        memset(data, 0xFF, length);
+        return -1;
+    }
+    return 0;
+}
+
+int I2C::transfer(int address, const char* tx_buffer, int tx_length, char* rx_buffer, int rx_length,
+                  const event_callback_t& callback, int event, bool repeated) {
+    if (_busy) return -1;
+    _busy = true;
+    sim::charge(sim::costs().i2c_setup);
+    sim::ns_t t = 0;
+    if (tx_length > 0) t += i2c_time(tx_length, _hz);
+    if (rx_length > 0 || tx_length == 0) t += i2c_time(rx_length, _hz);
+    /* As with SPI, the target sees the whole transfer at completion; nothing
+     * else can use the bus meanwhile. */
+    sim::schedule(sim::now() + t, [=]() {
+        sim::I2CDevice* device = sim::i2c_find(_sda, (uint8_t)(address >> 1));
+        bool acked = device != nullptr;
+        if (tx_length > 0) {
+            _account(tx_length, rx_length > 0 || repeated, false);
+            acked = acked && device->i2c_write(reinterpret_cast<const uint8_t*>(tx_buffer), tx_length);
+        }
+        if (rx_length > 0 || tx_length == 0) {
+            _account(rx_length, repeated, false);
+            if (acked) acked = device->i2c_read(reinterpret_cast<uint8_t*>(rx_buffer), rx_length);
+            if (!acked) memset(rx_buffer, 0xFF, rx_length);
+        }
+        _busy = false;
+        int result = acked ? I2C_EVENT_TRANSFER_COMPLETE : I2C_EVENT_ERROR_NO_SLAVE;
+        if (!acked) ++sim::i2c_stats().naks;
+        if (callback && (event & result)) callback(result);
+    });
+    return 0;
+}
+
+static bool pin_in(PinName pin, std::initializer_list<PinName> pins) {
+    return std::find(pins.begin(), pins.end(), pin) != pins.end();
+}
+
+SPI* SPI::_owner = nullptr;
+bool SPI::_busy = false;
+
+SPI::SPI(PinName mosi, PinName miso, PinName sclk, PinName ssel) :
+    _sclk(sclk), _bits(8), _mode(0), _hz(1000000), _dma(DMA_USAGE_NEVER) {
+    (void)ssel;
+    /* SPI1 alternate functions on the L432KC. */
+    if (!pin_in(mosi, {PA_7, PA_12, PB_5}) || !pin_in(miso, {PA_6, PA_11, PB_4})
+        || !pin_in(sclk, {PA_1, PA_5, PB_3})) {
+        error("pinmap not found for peripheral\n");
+    }
+}
+
+void SPI::_acquire(void) {
+    if (_owner == this) return;
+    _owner = this;
+    sim::charge(sim::costs().spi_init);
+    /* SCLK returns to the mode 0 idle level while the peripheral is reset. */
+    if (_mode & 2) sim::spi_glitch(_sclk);
+}
+
+sim::ns_t SPI::_bus_time(int length) const {
+    return (sim::ns_t)length * _bits * sim::S / (sim::ns_t)_hz;
+}
+
+/* As in mbed, the owner only updates the setting; anyone else reclaims. */
+void SPI::format(int bits, int mode) {
+    _bits = bits;
+    _mode = mode;
+    if (_owner == this) sim::charge(sim::costs().spi_setup);
+    else _acquire();
+}
+
+void SPI::frequency(int hz) {
+    _hz = hz;
+    if (_owner == this) sim::charge(sim::costs().spi_setup);
+    else _acquire();
+}
+
+int SPI::write(int value) {
+    _acquire();
+    sim::charge(sim::costs().spi_setup + _bus_time(1));
+    return sim::spi_exchange(_sclk, (uint8_t)value, _mode);
+}
+
+int SPI::write(const char* tx_buffer, int tx_length, char* rx_buffer, int rx_length) {
+    _acquire();
+    int length = std::max(tx_length, rx_length);
+    sim::charge(sim::costs().spi_setup + _bus_time(length));
+    for (int i = 0; i < length; ++i) {
+        /* mbed clocks out the fill character 0xFF once tx_buffer runs out. */
+        uint8_t out = i < tx_length ? (uint8_t)tx_buffer[i] : 0xFF;
+        uint8_t in = sim::spi_exchange(_sclk, out, _mode);
+        if (i < rx_length) rx_buffer[i] = (char)in;
+    }
+    return length;
+}
+
+int SPI::_transfer(const uint8_t* tx, int tx_length, uint8_t* rx, int rx_length,
+                   const event_callback_t& callback, int event) {
+    if (_busy) return -1;
+    _acquire();
+    _busy = true;
+    sim::charge(sim::costs().spi_setup);
+    int length = std::max(tx_length, rx_length);
+    /* The target sees the bytes as they are clocked; exchanging them all at
+     * completion is equivalent since nothing else touches the bus meanwhile. */
+    sim::schedule(sim::now() + _bus_time(length), [=]() {
+        for (int i = 0; i < length; ++i) {
+            uint8_t out = i < tx_length ? tx[i] : 0xFF;
+            uint8_t in = sim::spi_exchange(_sclk, out, _mode);
+            if (i < rx_length) rx[i] = in;
+        }
+        _busy = false;
+        if (callback && (event & SPI_EVENT_COMPLETE)) callback(SPI_EVENT_COMPLETE);
+    });
+    return 0;
+}
+
+CAN::CAN(PinName rd, PinName td) : _node(sim::can_node_create()) {
+    (void)rd;
+    (void)td;
+}
+
+CAN::CAN(PinName rd, PinName td, int hz) : CAN(rd, td) {
+    frequency(hz);
+}
+
+CAN::~CAN() {
+    sim::can_node_destroy(_node);
+}
+
+int CAN::frequency(int hz) {
+    _node->bitrate = (uint32_t)hz;
+    return 1;
+}
+
+int CAN::write(CANMessage msg) {
+    lock();
+    sim::charge(sim::costs().can_api);
+    sim::Frame frame;
+    frame.t = sim::now();
+    frame.id = msg.id;
+    frame.len = msg.len;
+    memcpy(frame.data, msg.data, sizeof(frame.data));
+    int ret = sim::can_node_write(_node, frame) ? 1 : 0;
+    unlock();
+    return ret;
+}
+
+int CAN::read(CANMessage& msg, int handle) {
+    (void)handle;
+    lock();
+    sim::charge(sim::costs().can_api);
+    sim::Frame frame;
+    bool ok = sim::can_node_read(_node, frame);
+    unlock();
+    if (!ok) return 0;
+    msg.id = frame.id;
+    msg.len = frame.len;
+    msg.format = CANStandard;
+    msg.type = CANData;
+    memcpy(msg.data, frame.data, sizeof(msg.data));
+    return 1;
+}
+
+int CAN::mode(Mode mode) {
+    _node->loopback = (mode == LocalTest);
+    return 1;
+}
+
+int CAN::filter(unsigned int id, unsigned int mask, CANFormat format, int handle) {
+    (void)format;
+    if (handle < 0 || handle >= sim::CAN_FILTER_BANKS) return 0;
+    _node->filters[handle] = sim::CanFilter{true, id, mask};
+    return 1;
+}
+
+void CAN::attach(Callback<void()> func, IrqType type) {
+    if (type < IrqCnt) _node->irq[type] = func;
+}
+
+} // namespace mbed
+
+/* Events ******************************************************************/
+
+namespace events {
+
+EventQueue::~EventQueue() {
+    for (Deferred* d : _deferred) {
+        sim::cancel(d->timer);
+        delete d;
+    }
+}
+
+int EventQueue::_post(mbed::Callback<void()> func) {
+    if (_pending.size() >= _capacity) {
+        ++_overflows;
+        return 0;
+    }
+    int id = _next_id++;
+    _pending.push_back(Pending{id, func});
+    return id;
+}
+
+void EventQueue::_arm(Deferred* d) {
+    d->timer = sim::schedule(d->next, [this, d]() {
+        _post(d->func);
+        if (d->period) {
+            d->next += d->period;
+            _arm(d);
+        } else {
+            _deferred.erase(std::find(_deferred.begin(), _deferred.end(), d));
+            delete d;
+        }
+    });
+}
+
+int EventQueue::_defer(sim::ns_t delay, sim::ns_t period, mbed::Callback<void()> func) {
+    Deferred* d = new Deferred{_next_id++, -1, period, sim::now() + delay, func};
+    _deferred.push_back(d);
+    _arm(d);
+    return d->id;
+}
+
+bool EventQueue::cancel(int id) {
+    for (auto it = _deferred.begin(); it != _deferred.end(); ++it) {
+        if ((*it)->id == id) {
+            sim::cancel((*it)->timer);
+            delete *it;
+            _deferred.erase(it);
+            return true;
+        }
+    }
+    for (auto it = _pending.begin(); it != _pending.end(); ++it) {
+        if (it->id == id) {
+            _pending.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+void EventQueue::dispatch_once(void) {
+    size_t n = _pending.size();
+    while (n-- && !_pending.empty()) {
+        Pending event = _pending.front();
+        _pending.pop_front();
+        event.func();
+    }
+}
+
+void EventQueue::dispatch_forever(void) {
+    _break = false;
+    while (!_break) {
+        while (!_pending.empty() && !_break) {
+            Pending event = _pending.front();
+            _pending.pop_front();
+            event.func();
+        }
+        if (!_break) sim::idle();
+    }
+}
+
+} // namespace events
@@ -0,0 +1,272 @@
+/**
+ * @file sim.h
+ * @brief Virtual-time kernel behind the host mbed shim. Owns the simulated
+ * clock, the timer list used by Ticker/Timeout/EventQueue, pin levels, the I2C
+ * device registry and the CAN bus. Test harnesses use this API to attach device
+ * models, inject stimulus and inspect what the firmware did.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note Time only moves when firmware code blocks (osDelay, sleep_for,
+ * wait_us, an idle EventQueue) or when it touches a peripheral, which is
+ * charged the cost in sim::costs(). Runs are therefore deterministic and an
+ * hour of firmware time takes a fraction of a second on the host.
+ */
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <vector>
+#include "PinNames.h"
+
+namespace sim {
+
+/** Simulated time, in nanoseconds since reset. */
+typedef uint64_t ns_t;
+
+constexpr ns_t NS = 1;
+constexpr ns_t US = 1000 * NS;
+constexpr ns_t MS = 1000 * US;
+constexpr ns_t S  = 1000 * MS;
+
+/**
+ * @brief Thrown out of firmware code once the run deadline is reached. Only
+ * sim::run catches it.
+ */
+struct Halt {};
+
+/**
+ * @brief Execution cost charged for each peripheral access. Defaults
+ * approximate an 80 MHz L432KC running the mbed HAL.
+ */
+struct Costs {
+    ns_t gpio_write;
+    ns_t gpio_read;
+    ns_t i2c_setup;
+    ns_t can_api;
+    /** HAL call overhead of one SPI transfer. */
+    ns_t spi_setup;
+    /** Reinitializing the SPI peripheral for a different SPI object. */
+    ns_t spi_init;
+    /** A store to, or load from, a GPIO port register, bypassing the HAL. */
+    ns_t gpio_reg_write;
+    ns_t gpio_reg_read;
+};
+
+Costs& costs(void);
+
+/** @return Current simulated time. */
+ns_t now(void);
+
+/**
+ * @brief Account for firmware execution time. Timers that expire inside the
+ * window fire in order. Ignored while a timer callback (ISR) is running.
+ */
+void charge(ns_t dt);
+
+/** @brief Block the calling (only) thread until t. */
+void sleep_until(ns_t t);
+
+/** @brief Block the calling thread until the next timer fires. */
+void idle(void);
+
+/** @brief Block until the next timer fires, or until limit. */
+void idle_until(ns_t limit);
+
+/**
+ * @return Total time charged to firmware execution, i.e. time the CPU was
+ * busy rather than blocked.
+ */
+ns_t cpu_time(void);
+
+/** @return true while a timer or pin interrupt callback is running. */
+bool in_isr(void);
+
+/**
+ * @brief Mask interrupts, nesting. Time charged inside the section still
+ * passes, but timers that expire in it fire only when the outermost section
+ * exits.
+ */
+void critical_enter(void);
+void critical_exit(void);
+
+/**
+ * @brief Run a timer callback at an absolute time. Callbacks run in "ISR"
+ * context.
+ * @return Timer id, usable with cancel().
+ */
+int schedule(ns_t at, std::function<void()> fn);
+
+void cancel(int id);
+
+/**
+ * @brief Run entry (typically the renamed firmware main) for duration of
+ * simulated time.
+ *
+ * @param quiet Discard everything the firmware prints to stdout.
+ * @return Host wall time spent, in seconds.
+ */
+double run(std::function<void()> entry, ns_t duration, bool quiet = true);
+
+/* Pins ********************************************************************/
+
+typedef std::function<void(PinName pin, int level)> PinListener;
+
+/** @return Level of a pin, whether driven by firmware or a model. */
+int pin_level(PinName pin);
+
+/** @brief Firmware-side write (DigitalOut). Notifies pin listeners. */
+void pin_write(PinName pin, int level);
+
+/** @brief Firmware-side read (DigitalIn). Notifies read listeners. */
+int pin_read(PinName pin);
+
+/**
+ * @brief Model-side drive of a pin read by firmware (DigitalIn, InterruptIn).
+ * Fires InterruptIn edge callbacks.
+ */
+void pin_drive(PinName pin, int level);
+
+/** @brief Observe every firmware-side pin write. */
+void on_pin_write(PinListener listener);
+
+/** @brief Observe every firmware-side pin read, with the level read. */
+void on_pin_read(PinListener listener);
+
+/** @brief Observe edges on a pin driven by a model. Used by InterruptIn. */
+int on_pin_edge(PinName pin, PinListener listener);
+
+void remove_pin_edge(int id);
+
+/* I2C *********************************************************************/
+
+/**
+ * @brief An I2C target attached to a simulated bus. Return false to NAK.
+ */
+class I2CDevice {
+    public:
+        virtual ~I2CDevice() {}
+        virtual bool i2c_write(const uint8_t* data, int length) = 0;
+        virtual bool i2c_read(uint8_t* data, int length) = 0;
+};
+
+struct I2CStats {
+    /** START to STOP; a repeated start continues the same transaction. */
+    uint32_t transactions;
+    uint32_t restarts;
+    uint32_t bytes;
+    uint32_t naks;
+    ns_t busy;
+};
+
+/** @brief Attach a device at a 7-bit address on the bus using sda. */
+void i2c_attach(PinName sda, uint8_t addr7, I2CDevice* device);
+
+void i2c_detach(PinName sda, uint8_t addr7);
+
+I2CDevice* i2c_find(PinName sda, uint8_t addr7);
+
+I2CStats& i2c_stats(void);
+
+/* SPI *********************************************************************/
+
+/**
+ * @brief A target on a simulated hardware SPI bus. Targets track their own
+ * chip select and return 0xFF when not selected.
+ */
+class SPIDevice {
+    public:
+        virtual ~SPIDevice() {}
+
+        /** @brief Exchange one byte, clocked in the given SPI mode. */
+        virtual uint8_t spi_transfer(uint8_t mosi, int mode) = 0;
+
+        /**
+         * @brief A stray SCLK edge, e.g. while the peripheral is being
+         * reinitialized with CS low.
+         */
+        virtual void spi_glitch(void) = 0;
+};
+
+void spi_attach(PinName sclk, SPIDevice* device);
+
+void spi_detach(PinName sclk, SPIDevice* device);
+
+/** @brief Exchange one byte with every target on the bus. */
+uint8_t spi_exchange(PinName sclk, uint8_t mosi, int mode);
+
+/** @brief Deliver a stray clock edge to every target on the bus. */
+void spi_glitch(PinName sclk);
+
+/* CAN *********************************************************************/
+
+struct Frame {
+    ns_t t;
+    uint32_t id;
+    uint8_t len;
+    uint8_t data[8];
+    int node;
+};
+
+struct CanStats {
+    uint32_t tx_ok;
+    uint32_t tx_full;
+    uint32_t rx_ok;
+    uint32_t rx_overrun;
+    uint32_t rx_filtered;   // Refused by every acceptance filter.
+};
+
+/** @brief One acceptance filter bank in identifier/mask mode. */
+struct CanFilter {
+    bool active;
+    uint32_t id;
+    uint32_t mask;
+};
+
+constexpr int CAN_FILTER_BANKS = 14;
+
+/**
+ * @brief One bxCAN controller: three transmit mailboxes, acceptance filters
+ * and a three deep receive FIFO on a shared bus. As after mbed's can_init,
+ * bank 0 accepts everything until it is set.
+ */
+struct CanNode {
+    int index;
+    uint32_t bitrate;
+    bool loopback;
+    std::deque<Frame> mailboxes;
+    std::deque<Frame> rx_fifo;
+    CanFilter filters[CAN_FILTER_BANKS];
+    std::function<void()> irq[9];
+    CanStats stats;
+};
+
+constexpr int CAN_MAILBOXES = 3;
+constexpr int CAN_RX_FIFO_DEPTH = 3;
+
+CanNode* can_node_create(void);
+
+void can_node_destroy(CanNode* node);
+
+/** @return false if every mailbox is occupied. */
+bool can_node_write(CanNode* node, const Frame& frame);
+
+bool can_node_read(CanNode* node, Frame& frame);
+
+/** @return Bus time taken by a standard data frame, worst-case stuffing. */
+ns_t can_frame_time(uint8_t len, uint32_t bitrate);
+
+/** @brief Every frame that completed on the bus, in order. */
+const std::vector<Frame>& can_log(void);
+
+/** @brief Deliver a frame from an off-board node to every controller at t. */
+void can_inject(ns_t at, uint32_t id, const uint8_t* data, uint8_t len);
+
+/** @brief Sum of the statistics of every controller. */
+CanStats can_stats(void);
+
+/** @brief Fraction of time the bus carried frames since reset. */
+double can_bus_load(void);
+
+} // namespace sim
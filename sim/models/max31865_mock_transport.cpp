@@ -0,0 +1,28 @@
+/**
+ * @file max31865_mock_transport.cpp
+ * @brief Host mock of the MAX31865 bus.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#include "max31865_mock_transport.h"
+
+Max31865MockTransport::Max31865MockTransport(Max31865Model& chip, int hz, sim::ns_t overhead) :
+    _chip(chip), _hz(hz), _overhead(overhead), _transfers(0), _bytes(0), _busy(0)
+{
+    /* The model's CS pin is not driven in this mode. */
+    _chip.deselect();
+}
+
+void Max31865MockTransport::transfer(const uint8_t* tx, uint8_t* rx, int length) {
+    sim::ns_t t = _overhead + (sim::ns_t)length * 8 * sim::S / (sim::ns_t)_hz;
+    ++_transfers;
+    _bytes += length;
+    _busy += t;
+    sim::charge(t);
+
+    _chip.select();
+    for (int i = 0; i < length; ++i) {
+        rx[i] = _chip.transfer(tx[i]);
+    }
+    _chip.deselect();
+}
@@ -0,0 +1,41 @@
+/**
+ * @file max31865_mock_transport.h
+ * @brief Host mock of the MAX31865 bus. Hands register bursts straight to a
+ * Max31865Model and charges the time an ideal SPI bus would take, so that the
+ * driver can be exercised and benchmarked without any pin-level traffic.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#pragma once
+#include <cstdint>
+#include "MAX31865_Transport.h"
+#include "models/max31865_model.h"
+#include "sim.h"
+
+class Max31865MockTransport : public MAX31865_Transport {
+    public:
+        /**
+         * @brief Construct a new mock transport.
+         *
+         * @param chip Model the bursts are delivered to.
+         * @param hz SCLK frequency used to compute bus time.
+         * @param overhead Fixed cost per burst, e.g. CS handling.
+         */
+        Max31865MockTransport(Max31865Model& chip, int hz = 4000000, sim::ns_t overhead = 1 * sim::US);
+
+        void transfer(const uint8_t* tx, uint8_t* rx, int length) override;
+
+        /** @brief Bursts, bytes and bus time since construction. */
+        uint32_t transfers(void) const { return _transfers; }
+        uint32_t bytes(void) const { return _bytes; }
+        sim::ns_t busy(void) const { return _busy; }
+
+    private:
+        Max31865Model& _chip;
+        int _hz;
+        sim::ns_t _overhead;
+
+        uint32_t _transfers;
+        uint32_t _bytes;
+        sim::ns_t _busy;
+};
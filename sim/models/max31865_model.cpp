@@ -0,0 +1,272 @@
+/**
+ * @file max31865_model.cpp
+ * @brief Behavioural model of a MAX31865 RTD-to-digital converter.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#include "max31865_model.h"
+#include <cmath>
+
+/* Callendar-Van Dusen, IEC 60751. */
+#define CVD_A (3.9083e-3)
+#define CVD_B (-5.775e-7)
+#define CVD_C (-4.183e-12)
+
+enum {
+    REG_CONFIG  = 0x00,
+    REG_RTD_MSB = 0x01,
+    REG_RTD_LSB = 0x02,
+    REG_HFT_MSB = 0x03,
+    REG_HFT_LSB = 0x04,
+    REG_LFT_MSB = 0x05,
+    REG_LFT_LSB = 0x06,
+    REG_FAULT   = 0x07,
+};
+
+#define CONFIG_VBIAS       (0x80)
+#define CONFIG_AUTO        (0x40)
+#define CONFIG_ONE_SHOT    (0x20)
+#define CONFIG_FAULT_CYCLE (0x0C)
+#define CONFIG_FAULT_AUTO  (0x04)
+#define CONFIG_FAULT_CLEAR (0x02)
+
+/* Faults only the detection cycle finds, and the over/under-voltage one. */
+#define FAULT_CYCLE_BITS   (0x38)
+#define FAULT_VOLTAGE      (0x04)
+
+/* Automatic fault detection cycle, CS high to complete. */
+#define FAULT_CYCLE_NS     (550 * sim::US)
+
+/* One-shot conversion time with the 50 and 60 Hz filter (max), and the
+   Vbias settling before one: 1 ms plus 10.5 time constants of a 40 us
+   input filter. */
+#define CONFIG_FILTER_50HZ (0x01)
+#define ONE_SHOT_50HZ_NS   (62500 * sim::US)
+#define ONE_SHOT_60HZ_NS   (52 * sim::MS)
+#define BIAS_SETTLE_NS     (1420 * sim::US)
+
+/* Nothing scheduled. */
+#define NEVER              ((sim::ns_t)-1)
+
+Max31865Model::Max31865Model(PinName mosi, PinName miso, PinName sclk, PinName cs,
+                             double r0, double rref) :
+    _mosi(mosi), _miso(miso), _sclk(sclk), _cs(cs), _r0(r0), _rref(rref),
+    _temp([](sim::ns_t) { return 25.0; }),
+    _selected(false), _byte(0), _addr(0), _write(false), _bit(0),
+    _shift_in(0), _shift_out(0xFF), _transactions(0), _bytes(0), _config_writes(0),
+    _mode_errors(0), _wiring_fault(0), _wiring_code(-1), _cycle_done(NEVER), _fault_cycles(0),
+    _bias_on(NEVER), _bias_time(0), _one_shot_done(NEVER), _one_shot_settled(false), _one_shots(0),
+    _unsettled(0), _stale_reads(0)
+{
+    power_cycle();
+
+    sim::on_pin_write([this](PinName pin, int level) { _on_pin(pin, level); });
+    sim::spi_attach(_sclk, this);
+
+    /* DigitalOut powers up low, so a chip whose CS has not been raised yet
+       is already listening. */
+    if (!sim::pin_level(_cs)) select();
+}
+
+Max31865Model::~Max31865Model() {
+    sim::spi_detach(_sclk, this);
+}
+
+void Max31865Model::power_cycle(void) {
+    /* Power-on register values. */
+    _regs[REG_CONFIG]  = 0x00;
+    _regs[REG_RTD_MSB] = 0x00;
+    _regs[REG_RTD_LSB] = 0x00;
+    _regs[REG_HFT_MSB] = 0xFF;
+    _regs[REG_HFT_LSB] = 0xFF;
+    _regs[REG_LFT_MSB] = 0x00;
+    _regs[REG_LFT_LSB] = 0x00;
+    _regs[REG_FAULT]   = 0x00;
+
+    if (_bias_on != NEVER) _bias_time += sim::now() - _bias_on;
+    _bias_on = NEVER;
+    _cycle_done = NEVER;
+    _one_shot_done = NEVER;
+}
+
+void Max31865Model::set_temperature(double temp_c) {
+    _temp = [temp_c](sim::ns_t) { return temp_c; };
+}
+
+void Max31865Model::set_temperature(std::function<double(sim::ns_t)> temp_c) {
+    _temp = temp_c;
+}
+
+void Max31865Model::set_wiring_fault(uint8_t status, int32_t code) {
+    _wiring_fault = status;
+    _wiring_code = status ? code : -1;
+}
+
+sim::ns_t Max31865Model::bias_time(void) const {
+    return _bias_time + (_bias_on != NEVER ? sim::now() - _bias_on : 0);
+}
+
+uint16_t Max31865Model::code_at(double t) const {
+    double ratio = 1.0 + CVD_A * t + CVD_B * t * t;
+    if (t < 0.0) ratio += CVD_C * (t - 100.0) * t * t * t;
+    double code = std::round(_r0 * ratio / _rref * 32768.0);
+    if (code < 0.0) code = 0.0;
+    if (code > 32767.0) code = 32767.0;
+    return (uint16_t)code;
+}
+
+/** Finish a fault detection cycle that has run its time. */
+void Max31865Model::_fault_cycle(void) {
+    if (_cycle_done == NEVER || sim::now() < _cycle_done) return;
+    _cycle_done = NEVER;
+    _regs[REG_FAULT] |= _wiring_fault & FAULT_CYCLE_BITS;
+    _regs[REG_CONFIG] &= ~CONFIG_FAULT_CYCLE;
+    ++_fault_cycles;
+}
+
+/** Latch a new conversion into the RTD and fault registers. */
+void Max31865Model::_convert(void) {
+    if (_wiring_fault & FAULT_VOLTAGE) {
+        _regs[REG_FAULT] |= FAULT_VOLTAGE;
+        _regs[REG_RTD_LSB] |= 1;
+        return;
+    }
+    uint8_t config = _regs[REG_CONFIG];
+    if (!(config & CONFIG_VBIAS) || !(config & (CONFIG_AUTO | CONFIG_ONE_SHOT))) return;
+    /* A one-shot conversion takes its time; the registers hold the last
+       one until it is done. */
+    bool one_shot = !(config & CONFIG_AUTO);
+    if (one_shot && (_one_shot_done == NEVER || sim::now() < _one_shot_done)) return;
+
+    uint16_t code = _wiring_code >= 0 ? (uint16_t)_wiring_code : code_at(_temp(sim::now()));
+    if (one_shot) {
+        _one_shot_done = NEVER;
+        ++_one_shots;
+        /* Started before the bias settled: low by about a percent */
+        if (!_one_shot_settled) {
+            code = (uint16_t)(code - code / 100);
+            ++_unsettled;
+        }
+    }
+    uint16_t high = (uint16_t)((_regs[REG_HFT_MSB] << 8) | _regs[REG_HFT_LSB]) >> 1;
+    uint16_t low  = (uint16_t)((_regs[REG_LFT_MSB] << 8) | _regs[REG_LFT_LSB]) >> 1;
+    if (code >= high) _regs[REG_FAULT] |= 0x80;
+    if (code <= low)  _regs[REG_FAULT] |= 0x40;
+
+    _regs[REG_RTD_MSB] = (uint8_t)(code >> 7);
+    _regs[REG_RTD_LSB] = (uint8_t)((code << 1) | (_regs[REG_FAULT] ? 1 : 0));
+    _regs[REG_CONFIG] &= ~CONFIG_ONE_SHOT;
+}
+
+void Max31865Model::select(void) {
+    _selected = true;
+    _byte = 0;
+    _bit = 0;
+    _shift_in = 0;
+    _shift_out = 0xFF;
+    ++_transactions;
+    _fault_cycle();
+    _convert();
+}
+
+void Max31865Model::deselect(void) {
+    _selected = false;
+}
+
+uint8_t Max31865Model::_next_out(void) {
+    if (_byte == 0 || _write) return 0xFF;
+    return _regs[(_addr + _byte - 1) & 0x07];
+}
+
+uint8_t Max31865Model::transfer(uint8_t mosi) {
+    if (!_selected) return 0xFF;
+    uint8_t out = _next_out();
+    ++_bytes;
+    if (_byte == 0) {
+        _addr = mosi & 0x7F;
+        _write = (mosi & 0x80) != 0;
+    } else if (_write) {
+        uint8_t reg = (_addr + _byte - 1) & 0x07;
+        if (reg == REG_CONFIG) {
+            ++_config_writes;
+            _write_config(mosi);
+        } else if (reg >= REG_HFT_MSB && reg <= REG_LFT_LSB) {
+            _regs[reg] = mosi;
+        }
+    }
+    if (_byte == 0 && !_write && _addr >= REG_RTD_MSB && _addr <= REG_RTD_LSB && _one_shot_done != NEVER) ++_stale_reads;
+    ++_byte;
+    return out;
+}
+
+void Max31865Model::_write_config(uint8_t config) {
+    if ((config & CONFIG_FAULT_CLEAR) && !(config & (CONFIG_ONE_SHOT | CONFIG_FAULT_CYCLE))) {
+        _regs[REG_FAULT] = 0x00;
+    }
+    bool settled = _bias_on != NEVER && sim::now() - _bias_on >= BIAS_SETTLE_NS;
+    if ((config & CONFIG_VBIAS) && _bias_on == NEVER) {
+        _bias_on = sim::now();
+    } else if (!(config & CONFIG_VBIAS) && _bias_on != NEVER) {
+        _bias_time += sim::now() - _bias_on;
+        _bias_on = NEVER;
+    }
+    _regs[REG_CONFIG] = config & ~CONFIG_FAULT_CLEAR;
+    /* Automatic cycle: 100X010Xb, timed from CS going high. */
+    if ((config & (CONFIG_VBIAS | CONFIG_AUTO | CONFIG_ONE_SHOT | CONFIG_FAULT_CYCLE))
+        == (CONFIG_VBIAS | CONFIG_FAULT_AUTO)) {
+        _cycle_done = sim::now() + FAULT_CYCLE_NS;
+    } else {
+        _regs[REG_CONFIG] &= ~CONFIG_FAULT_CYCLE;
+    }
+    /* A 1-shot with D3 or D2 set is ignored, as is one without the bias;
+       taking the bias away stops one that is running. */
+    if ((config & (CONFIG_VBIAS | CONFIG_AUTO | CONFIG_ONE_SHOT | CONFIG_FAULT_CYCLE))
+        == (CONFIG_VBIAS | CONFIG_ONE_SHOT)) {
+        _one_shot_done = sim::now() + (config & CONFIG_FILTER_50HZ ? ONE_SHOT_50HZ_NS : ONE_SHOT_60HZ_NS);
+        _one_shot_settled = settled;
+    } else {
+        if (!(config & CONFIG_VBIAS) || (config & CONFIG_AUTO)) _one_shot_done = NEVER;
+        if (_one_shot_done != NEVER) _regs[REG_CONFIG] |= CONFIG_ONE_SHOT;
+        else _regs[REG_CONFIG] &= ~CONFIG_ONE_SHOT;
+    }
+}
+
+/**
+ * SCLK rising edge: present the next output bit and latch the input bit.
+ * @return Level driven on SDO.
+ */
+int Max31865Model::_clock(int mosi) {
+    if (_bit == 0) _shift_out = _next_out();
+    int out = (_shift_out >> (7 - _bit)) & 1;
+    _shift_in = (uint8_t)((_shift_in << 1) | (mosi & 1));
+    if (++_bit == 8) {
+        _bit = 0;
+        transfer(_shift_in);
+    }
+    return out;
+}
+
+void Max31865Model::_on_pin(PinName pin, int level) {
+    if (pin == _cs) {
+        if (!level && !_selected) select();
+        else if (level && _selected) deselect();
+        return;
+    }
+    if (pin != _sclk || !_selected || !level) return;
+    sim::pin_drive(_miso, _clock(sim::pin_level(_mosi)));
+}
+
+uint8_t Max31865Model::spi_transfer(uint8_t mosi, int mode) {
+    if (!_selected) return 0xFF;
+    /* Only modes 1 and 3 (CPHA = 1) are supported. */
+    if (!(mode & 1)) ++_mode_errors;
+    uint8_t miso = 0;
+    for (int i = 7; i >= 0; --i) {
+        miso = (uint8_t)((miso << 1) | _clock((mosi >> i) & 1));
+    }
+    return miso;
+}
+
+void Max31865Model::spi_glitch(void) {
+    if (_selected) _clock(sim::pin_level(_mosi));
+}
@@ -0,0 +1,139 @@
+/**
+ * @file max31865_model.h
+ * @brief Behavioural model of a MAX31865 RTD-to-digital converter and the
+ * PT100/PT1000 attached to it, for the host simulator.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note The model decodes SPI from pin writes, so any transport that toggles
+ * the firmware-side pins (e.g. BitBangSPI) talks to it unmodified. It also
+ * attaches to the simulated hardware SPI bus on its SCLK pin. Transports that
+ * move whole bytes can use select()/transfer()/deselect() directly.
+ */
+#pragma once
+#include <cstdint>
+#include <functional>
+#include "sim.h"
+
+class Max31865Model : public sim::SPIDevice {
+    public:
+        /**
+         * @brief Construct a new model listening on the given bus pins.
+         *
+         * @param mosi Pin the firmware drives with data for the chip (SDI).
+         * @param miso Pin the chip drives back (SDO).
+         * @param sclk Serial clock.
+         * @param cs Chip select, active low.
+         * @param r0 RTD resistance at 0 C. 100 for a PT100.
+         * @param rref Reference resistor. 400 for a PT100.
+         */
+        Max31865Model(PinName mosi, PinName miso, PinName sclk, PinName cs,
+                      double r0 = 100.0, double rref = 400.0);
+        ~Max31865Model();
+
+        /** @brief Set a constant RTD temperature, in C. */
+        void set_temperature(double temp_c);
+
+        /** @brief Set the RTD temperature as a function of simulated time. */
+        void set_temperature(std::function<double(sim::ns_t)> temp_c);
+
+        /**
+         * @brief Break the wiring. The automatic fault detection cycle
+         * reports status's D5 to D3; D2 (over/under-voltage) is reported at
+         * any time and halts conversions. If code is 0 or more, conversions
+         * read it, e.g. 0x7FFF for an open element. A status of 0 mends it.
+         */
+        void set_wiring_fault(uint8_t status, int32_t code = -1);
+
+        /**
+         * @brief Brown-out: the registers go back to their power-on values,
+         * configuration included, and any conversion or cycle stops.
+         */
+        void power_cycle(void);
+
+        /** @brief Fault detection cycles run since construction. */
+        uint32_t fault_cycles(void) const { return _fault_cycles; }
+
+        /**
+         * @brief Time Vbias has been on since construction, the RTD's
+         * self-heating and most of the chip's supply current.
+         */
+        sim::ns_t bias_time(void) const;
+
+        /** @brief One-shot conversions completed since construction. */
+        uint32_t one_shots(void) const { return _one_shots; }
+
+        /**
+         * @brief One-shot conversions started before Vbias settled, and
+         * RTD register reads while a one-shot conversion was still running.
+         * Both read a wrong or an old value.
+         */
+        uint32_t unsettled(void) const { return _unsettled; }
+        uint32_t stale_reads(void) const { return _stale_reads; }
+
+        /** @return 15-bit ADC code the chip would convert at temp_c. */
+        uint16_t code_at(double temp_c) const;
+
+        /** @return Current contents of a register (0x00 - 0x07). */
+        uint8_t reg(int addr) const { return _regs[addr & 0x07]; }
+
+        /* Byte level interface. */
+        void select(void);
+        void deselect(void);
+        uint8_t transfer(uint8_t mosi);
+
+        /** @brief Transactions and bytes seen since construction. */
+        uint32_t transactions(void) const { return _transactions; }
+        uint32_t bytes(void) const { return _bytes; }
+        uint32_t config_writes(void) const { return _config_writes; }
+
+        /** @brief Hardware SPI bytes clocked in a mode the chip does not support. */
+        uint32_t mode_errors(void) const { return _mode_errors; }
+
+        /* sim::SPIDevice */
+        uint8_t spi_transfer(uint8_t mosi, int mode) override;
+        void spi_glitch(void) override;
+
+    private:
+        void _on_pin(PinName pin, int level);
+        int _clock(int mosi);
+        void _convert(void);
+        void _fault_cycle(void);
+        void _write_config(uint8_t config);
+        uint8_t _next_out(void);
+
+        PinName _mosi;
+        PinName _miso;
+        PinName _sclk;
+        PinName _cs;
+        double _r0;
+        double _rref;
+        std::function<double(sim::ns_t)> _temp;
+
+        uint8_t _regs[8];
+        bool _selected;
+        int _byte;
+        uint8_t _addr;
+        bool _write;
+        int _bit;
+        uint8_t _shift_in;
+        uint8_t _shift_out;
+
+        uint32_t _transactions;
+        uint32_t _bytes;
+        uint32_t _config_writes;
+        uint32_t _mode_errors;
+
+        uint8_t _wiring_fault;
+        int32_t _wiring_code;
+        sim::ns_t _cycle_done;  /* Fault detection cycle runs until then */
+        uint32_t _fault_cycles;
+
+        sim::ns_t _bias_on;     /* When Vbias went on, if it is */
+        sim::ns_t _bias_time;   /* On before that */
+        sim::ns_t _one_shot_done;
+        bool _one_shot_settled;
+        uint32_t _one_shots;
+        uint32_t _unsettled;
+        uint32_t _stale_reads;
+};
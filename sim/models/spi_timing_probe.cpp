@@ -0,0 +1,132 @@
+/**
+ * @file spi_timing_probe.cpp
+ * @brief Edge timing of a bit-banged SPI bus.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#include "spi_timing_probe.h"
+#include <algorithm>
+#include <cstring>
+
+#define UNSEEN UINT64_MAX
+
+/* MAX31865 datasheet, AC electrical characteristics. */
+const SpiTimingProbe::Timing SpiTimingProbe::MAX31865 = {
+    /* cc  */ 400,
+    /* cch */ 100,
+    /* cwh */ 400,
+    /* cp  */ 200,
+    /* ch  */ 100,
+    /* cl  */ 100,
+    /* dc  */ 35,
+    /* cdh */ 35,
+    /* cdd */ 80,
+};
+
+SpiTimingProbe::SpiTimingProbe(PinName mosi, PinName miso, PinName sclk, std::vector<PinName> cs) :
+    _mosi(mosi), _miso(miso), _sclk(sclk), _cs(cs), _cs_high(cs.size(), UNSEEN)
+{
+    reset();
+    _mosi_level = sim::pin_level(_mosi);
+    _sclk_level = sim::pin_level(_sclk);
+    sim::on_pin_write([this](PinName pin, int level) { _on_write(pin, level); });
+    sim::on_pin_read([this](PinName pin, int) { _on_read(pin); });
+}
+
+void SpiTimingProbe::reset(void) {
+    _selected = -1;
+    _cs_low = _mosi_change = _rise = _fall = 0;
+    _clocked = false;
+    _held = true;
+    _worst = Timing{ UNSEEN, UNSEEN, UNSEEN, UNSEEN, UNSEEN, UNSEEN, UNSEEN, UNSEEN, UNSEEN };
+    _bursts = 0;
+    _clocks = 0;
+    std::fill(_cs_high.begin(), _cs_high.end(), UNSEEN);
+}
+
+void SpiTimingProbe::_min(sim::ns_t& worst, sim::ns_t value) {
+    if (value < worst) worst = value;
+}
+
+void SpiTimingProbe::_on_write(PinName pin, int level) {
+    sim::ns_t now = sim::now();
+    for (size_t i = 0; i < _cs.size(); ++i) {
+        if (pin != _cs[i]) continue;
+        if (!level && _selected < 0) {
+            if (_cs_high[i] != UNSEEN) _min(_worst.cwh, now - _cs_high[i]);
+            _selected = (int)i;
+            _cs_low = now;
+            _clocked = false;
+        } else if (level && _selected == (int)i) {
+            if (_clocked) _min(_worst.cch, now - _fall);
+            _cs_high[i] = now;
+            _selected = -1;
+            ++_bursts;
+        }
+        return;
+    }
+
+    if (pin == _mosi) {
+        if (level == _mosi_level) return;
+        _mosi_level = level;
+        _mosi_change = now;
+        if (_selected >= 0 && _clocked && !_held) {
+            _min(_worst.cdh, now - _fall);
+            _held = true;
+        }
+        return;
+    }
+
+    if (pin != _sclk || level == _sclk_level) return;
+    _sclk_level = level;
+    if (_selected < 0) return;
+    if (level) {
+        if (!_clocked) {
+            _min(_worst.cc, now - _cs_low);
+        } else {
+            _min(_worst.cl, now - _fall);
+            _min(_worst.cp, now - _rise);
+        }
+        _rise = now;
+        _clocked = true;
+        ++_clocks;
+    } else if (_clocked) {
+        _min(_worst.ch, now - _rise);
+        _min(_worst.dc, now - _mosi_change);
+        _fall = now;
+        _held = false;
+    }
+}
+
+void SpiTimingProbe::_on_read(PinName pin) {
+    if (pin != _miso || _selected < 0 || !_clocked || !_sclk_level) return;
+    _min(_worst.cdd, sim::now() - _rise);
+}
+
+const char* SpiTimingProbe::violations(const Timing& limits) const {
+    static const char* names[] = { "tCC", "tCCH", "tCWH", "tCP", "tCH", "tCL", "tDC", "tCDH", "tCDD" };
+    const sim::ns_t* worst = &_worst.cc;
+    const sim::ns_t* limit = &limits.cc;
+    _names[0] = '\0';
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        if (worst[i] >= limit[i]) continue;
+        if (_names[0]) strcat(_names, ",");
+        strcat(_names, names[i]);
+    }
+    return _names;
+}
+
+void SpiTimingProbe::print(FILE* out, const Timing& limits) const {
+    static const char* names[] = { "CC", "CCH", "CWH", "CP", "CH", "CL", "DC", "CDH", "CDD" };
+    const sim::ns_t* worst = &_worst.cc;
+    const sim::ns_t* limit = &limits.cc;
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        if (worst[i] == UNSEEN) {
+            fprintf(out, "%s%s -", i ? ", " : "", names[i]);
+        } else {
+            fprintf(out, "%s%s %llu%s", i ? ", " : "", names[i], (unsigned long long)worst[i],
+                    worst[i] < limit[i] ? "!" : "");
+        }
+    }
+    fprintf(out, " ns\n");
+}
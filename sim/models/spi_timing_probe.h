@@ -0,0 +1,88 @@
+/**
+ * @file spi_timing_probe.h
+ * @brief Logic analyser for a bit-banged SPI bus in mode 1, for the host
+ * simulator. Records the time of every firmware-side edge on the bus and
+ * every read of SDO, and keeps the tightest value of each MAX31865 timing
+ * parameter seen while a chip is selected.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note Mode 1: SCLK idles low, the chip shifts SDO out on the rising edge and
+ * latches SDI on the falling edge, so setup and hold of SDI are taken about
+ * the falling edge and SDO valid time after the rising edge. Parameters not
+ * seen yet read sim::ns_t max.
+ */
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "sim.h"
+
+class SpiTimingProbe {
+    public:
+        /** @brief Minimum times, ns. */
+        struct Timing {
+            sim::ns_t cc;       /* CS low to first SCLK rising edge */
+            sim::ns_t cch;      /* Last SCLK falling edge to CS high */
+            sim::ns_t cwh;      /* CS high between bursts */
+            sim::ns_t cp;       /* SCLK period */
+            sim::ns_t ch;       /* SCLK high */
+            sim::ns_t cl;       /* SCLK low */
+            sim::ns_t dc;       /* SDI setup to SCLK falling edge */
+            sim::ns_t cdh;      /* SDI hold after SCLK falling edge */
+            sim::ns_t cdd;      /* SCLK rising edge to SDO read */
+        };
+
+        /** @brief The MAX31865 datasheet limits. */
+        static const Timing MAX31865;
+
+        /**
+         * @brief Construct a new probe on the given bus pins.
+         *
+         * @param cs Chip selects on the bus, active low.
+         */
+        SpiTimingProbe(PinName mosi, PinName miso, PinName sclk, std::vector<PinName> cs);
+
+        /** @brief Tightest value of each parameter seen so far. */
+        const Timing& worst(void) const { return _worst; }
+
+        /** @brief Bursts, CS low to CS high, seen so far. */
+        uint32_t bursts(void) const { return _bursts; }
+
+        /** @brief SCLK rising edges seen so far with a chip selected. */
+        uint32_t clocks(void) const { return _clocks; }
+
+        /** @return Names of the parameters below limits, comma separated, or "". */
+        const char* violations(const Timing& limits = MAX31865) const;
+
+        /** @brief Print the worst values against limits, one line. */
+        void print(FILE* out, const Timing& limits = MAX31865) const;
+
+        /** @brief Start over, e.g. after a stretch that is not of interest. */
+        void reset(void);
+
+    private:
+        void _on_write(PinName pin, int level);
+        void _on_read(PinName pin);
+        static void _min(sim::ns_t& worst, sim::ns_t value);
+
+        PinName _mosi;
+        PinName _miso;
+        PinName _sclk;
+        std::vector<PinName> _cs;
+        std::vector<sim::ns_t> _cs_high;    /* When each CS last went high */
+
+        int _selected;          /* Index in _cs, or -1 */
+        int _mosi_level;
+        int _sclk_level;
+        sim::ns_t _cs_low;
+        sim::ns_t _mosi_change;
+        sim::ns_t _rise;
+        sim::ns_t _fall;
+        bool _clocked;          /* A rising edge in this burst */
+        bool _held;             /* SDI changed since the last falling edge */
+        Timing _worst;
+        uint32_t _bursts;
+        uint32_t _clocks;
+        mutable char _names[64];
+};
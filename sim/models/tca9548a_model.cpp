@@ -0,0 +1,84 @@
+/**
+ * @file tca9548a_model.cpp
+ * @brief Behavioural model of a TCA9548A 1-to-8 I2C switch.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#include "tca9548a_model.h"
+#include <cstring>
+
+Tca9548aModel::Tca9548aModel(PinName sda, uint8_t addr7) :
+    _sda(sda), _addr7(addr7), _control(0), _selects(0)
+{
+    sim::i2c_attach(_sda, _addr7, this);
+}
+
+Tca9548aModel::~Tca9548aModel() {
+    for (auto& route : _routes) {
+        if (sim::i2c_find(_sda, route.first) == route.second) sim::i2c_detach(_sda, route.first);
+        delete route.second;
+    }
+    sim::i2c_detach(_sda, _addr7);
+}
+
+void Tca9548aModel::attach(int channel, uint8_t addr7, sim::I2CDevice* device) {
+    _channels[channel & 0x07][addr7] = device;
+    if (!_routes.count(addr7)) _routes[addr7] = new Route(this, addr7);
+    _route();
+}
+
+std::vector<sim::I2CDevice*> Tca9548aModel::_connected(uint8_t addr7) const {
+    std::vector<sim::I2CDevice*> devices;
+    for (int channel = 0; channel < 8; ++channel) {
+        if (!(_control & (1 << channel))) continue;
+        auto it = _channels[channel].find(addr7);
+        if (it != _channels[channel].end()) devices.push_back(it->second);
+    }
+    return devices;
+}
+
+void Tca9548aModel::_route(void) {
+    for (auto& route : _routes) {
+        bool connected = !_connected(route.first).empty();
+        if (connected) {
+            sim::i2c_attach(_sda, route.first, route.second);
+        } else if (sim::i2c_find(_sda, route.first) == route.second) {
+            sim::i2c_detach(_sda, route.first);
+        }
+    }
+}
+
+bool Tca9548aModel::i2c_write(const uint8_t* data, int length) {
+    /* Every byte written lands in the control register; the last one sticks. */
+    if (length < 1) return true;
+    _control = data[length - 1];
+    ++_selects;
+    _route();
+    return true;
+}
+
+bool Tca9548aModel::i2c_read(uint8_t* data, int length) {
+    for (int i = 0; i < length; ++i) data[i] = _control;
+    return true;
+}
+
+bool Tca9548aModel::Route::i2c_write(const uint8_t* data, int length) {
+    bool ack = false;
+    for (sim::I2CDevice* device : _mux->_connected(_addr7)) {
+        ack = device->i2c_write(data, length) || ack;
+    }
+    return ack;
+}
+
+bool Tca9548aModel::Route::i2c_read(uint8_t* data, int length) {
+    /* Open drain: a 0 from any device wins. */
+    std::vector<uint8_t> buffer(length);
+    bool ack = false;
+    memset(data, 0xFF, length);
+    for (sim::I2CDevice* device : _mux->_connected(_addr7)) {
+        if (!device->i2c_read(buffer.data(), length)) continue;
+        for (int i = 0; i < length; ++i) data[i] &= buffer[i];
+        ack = true;
+    }
+    return ack;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file tca9548a_model.h
+ * @brief Behavioural model of a TCA9548A 1-to-8 I2C switch for the host
+ * simulator.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note Downstream devices are attached per channel instead of to a bus.
+ * Whenever the control register changes, the model attaches itself upstream at
+ * every address present on a connected channel and routes each transaction to
+ * the devices there. With two connected devices at one address, both see
+ * writes and reads return the wired AND of their data, as on a real bus.
+ */
+#pragma once
+#include <cstdint>
+#include <map>
+#include <vector>
+#include "sim.h"
+
+class Tca9548aModel : public sim::I2CDevice {
+    public:
+        /**
+         * @brief Construct a new model and attach it to the bus.
+         *
+         * @param sda SDA pin of the upstream bus.
+         * @param addr7 7-bit address of the switch.
+         */
+        Tca9548aModel(PinName sda, uint8_t addr7 = 0x70);
+        ~Tca9548aModel();
+
+        /**
+         * @brief Attach a device at addr7 on a downstream channel. Construct
+         * the device with sda NC so that it does not attach upstream itself.
+         */
+        void attach(int channel, uint8_t addr7, sim::I2CDevice* device);
+
+        /** @return Control register, bit n connects channel n. */
+        uint8_t control(void) const { return _control; }
+
+        /** @brief Writes to the control register since construction. */
+        uint32_t selects(void) const { return _selects; }
+
+        bool i2c_write(const uint8_t* data, int length) override;
+        bool i2c_read(uint8_t* data, int length) override;
+
+    private:
+        /** Routes one downstream address to the connected channels. */
+        class Route : public sim::I2CDevice {
+            public:
+                Route(Tca9548aModel* mux, uint8_t addr7) : _mux(mux), _addr7(addr7) {}
+                bool i2c_write(const uint8_t* data, int length) override;
+                bool i2c_read(uint8_t* data, int length) override;
+
+            private:
+                Tca9548aModel* _mux;
+                uint8_t _addr7;
+        };
+
+        /** Attach or detach each downstream address upstream. */
+        void _route(void);
+
+        /** Devices at addr7 on connected channels. */
+        std::vector<sim::I2CDevice*> _connected(uint8_t addr7) const;
+
+        PinName _sda;
+        uint8_t _addr7;
+        uint8_t _control;
+        uint32_t _selects;
+
+        std::map<uint8_t, sim::I2CDevice*> _channels[8];
+        std::map<uint8_t, Route*> _routes;
+};
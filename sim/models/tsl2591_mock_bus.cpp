@@ -0,0 +1,34 @@
+/**
+ * @file tsl2591_mock_bus.cpp
+ * @brief Host mock of the TSL2591 I2C bus.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#include "tsl2591_mock_bus.h"
+
+Tsl2591MockBus::Tsl2591MockBus(Tsl2591Model& chip, int hz) :
+    _chip(chip), _hz(hz), _transactions(0), _bytes(0), _busy(0)
+{
+}
+
+void Tsl2591MockBus::_phase(int length) {
+    /* START or repeated start, address + R/W, one ack'd byte per data byte. */
+    sim::ns_t t = (sim::ns_t)(1 + 9 * (1 + length)) * sim::S / (sim::ns_t)_hz;
+    _bytes += 1 + length;
+    _busy += t;
+    sim::charge(t);
+}
+
+int Tsl2591MockBus::write(const char* data, int length) {
+    ++_transactions;
+    _phase(length);
+    return _chip.i2c_write(reinterpret_cast<const uint8_t*>(data), length) ? 0 : -1;
+}
+
+int Tsl2591MockBus::read(uint8_t command, char* data, int length) {
+    ++_transactions;
+    _phase(1);
+    _phase(length);
+    if (!_chip.i2c_write(&command, 1)) return -1;
+    return _chip.i2c_read(reinterpret_cast<uint8_t*>(data), length) ? 0 : -1;
+}
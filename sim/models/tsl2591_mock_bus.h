@@ -0,0 +1,46 @@
+/**
+ * @file tsl2591_mock_bus.h
+ * @brief Host mock of the TSL2591 I2C bus. Hands transactions straight to a
+ * Tsl2591Model and charges the time an ideal I2C bus would take, counting
+ * transactions and bytes so that access patterns can be compared.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#pragma once
+#include <cstdint>
+#include "TSL2591_Bus.h"
+#include "models/tsl2591_model.h"
+#include "sim.h"
+
+class Tsl2591MockBus : public TSL2591_Bus {
+    public:
+        /**
+         * @brief Construct a new mock bus.
+         *
+         * @param chip Model the transactions are delivered to.
+         * @param hz SCL frequency used to compute bus time.
+         */
+        Tsl2591MockBus(Tsl2591Model& chip, int hz = 400000);
+
+        int write(const char* data, int length) override;
+        int read(uint8_t command, char* data, int length) override;
+
+        /**
+         * @brief START to STOP transactions, bytes on the wire (address bytes
+         * included) and bus time since construction.
+         */
+        uint32_t transactions(void) const { return _transactions; }
+        uint32_t bytes(void) const { return _bytes; }
+        sim::ns_t busy(void) const { return _busy; }
+
+    private:
+        /** Account for one address phase plus length data bytes. */
+        void _phase(int length);
+
+        Tsl2591Model& _chip;
+        int _hz;
+
+        uint32_t _transactions;
+        uint32_t _bytes;
+        sim::ns_t _busy;
+};
@@ -0,0 +1,218 @@
+/**
+ * @file tsl2591_model.cpp
+ * @brief Behavioural model of a TSL2591 light-to-digital converter.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#include "tsl2591_model.h"
+#include <cstring>
+
+#define CMD_BIT         (0x80)
+#define CMD_TRANSACTION (0x60)
+#define CMD_NORMAL      (0x20)
+#define CMD_SPECIAL     (0x60)
+
+#define EN_NPIEN (0x80)
+#define EN_AIEN  (0x10)
+#define EN_AEN   (0x02)
+#define EN_PON   (0x01)
+
+#define STATUS_NPINTR (0x20)
+#define STATUS_AINT   (0x10)
+#define STATUS_AVALID (0x01)
+
+enum {
+    REG_ENABLE  = 0x00,
+    REG_CONTROL = 0x01,
+    REG_AILTL   = 0x04,
+    REG_AIHTL   = 0x06,
+    REG_NPAILTL = 0x08,
+    REG_NPAIHTL = 0x0A,
+    REG_PERSIST = 0x0C,
+    REG_PID     = 0x11,
+    REG_ID      = 0x12,
+    REG_STATUS  = 0x13,
+    REG_C0DATAL = 0x14,
+    REG_C1DATAL = 0x16,
+};
+
+static const double GAIN[4] = { 1.0, 25.0, 428.0, 9876.0 };
+static const uint8_t PERSIST_CYCLES[16] = { 0, 1, 2, 3, 5, 10, 15, 20, 25, 30, 35, 40, 45, 50, 55, 60 };
+
+Tsl2591Model::Tsl2591Model(PinName sda, PinName int_pin, uint8_t addr7) :
+    _sda(sda), _int(int_pin), _addr7(addr7), _ptr(0), _timer(-1), _started(0),
+    _control_written(false), _mixed(0.0),
+    _persist_count(0), _cycles(0), _power_toggles(0), _clock_error_ppm(0)
+{
+    memset(_regs, 0, sizeof(_regs));
+    _regs[REG_ID] = 0x50;
+    set_light(0.0, 0.0);
+    if (_sda != NC) sim::i2c_attach(_sda, _addr7, this);
+    sim::pin_drive(_int, 1);
+}
+
+Tsl2591Model::~Tsl2591Model() {
+    if (_timer >= 0) sim::cancel(_timer);
+    if (_sda != NC) sim::i2c_detach(_sda, _addr7);
+}
+
+void Tsl2591Model::set_light(double ch0_rate, double ch1_rate) {
+    _light = [ch0_rate, ch1_rate](sim::ns_t, double* ch0, double* ch1) {
+        *ch0 = ch0_rate;
+        *ch1 = ch1_rate;
+    };
+}
+
+void Tsl2591Model::set_light(Light light) {
+    _light = light;
+}
+
+sim::ns_t Tsl2591Model::_period(void) const {
+    sim::ns_t nominal = (sim::ns_t)((_regs[REG_CONTROL] & 0x07) + 1) * 100 * sim::MS;
+    return nominal + nominal / 1000000 * _clock_error_ppm;
+}
+
+/** Start a fresh integration if the ALS is powered and enabled. */
+void Tsl2591Model::_restart(void) {
+    if (_timer >= 0) {
+        sim::cancel(_timer);
+        _timer = -1;
+    }
+    uint8_t en = _regs[REG_ENABLE];
+    if ((en & (EN_PON | EN_AEN)) != (EN_PON | EN_AEN)) {
+        _regs[REG_STATUS] &= ~STATUS_AVALID;
+        return;
+    }
+    _started = sim::now();
+    _control_written = false;
+    _mixed = 0.0;
+    _timer = sim::schedule(_started + _period(), [this]() { _complete(); });
+}
+
+void Tsl2591Model::_complete(void) {
+    _timer = -1;
+    double rate0, rate1;
+    _light(sim::now(), &rate0, &rate1);
+
+    uint8_t atime = _regs[REG_CONTROL] & 0x07;
+    double scale = GAIN[(_regs[REG_CONTROL] >> 4) & 0x03] * 100.0 * (atime + 1);
+    if (_control_written) {
+        /* Counted partly at each setting, over the old integration time. */
+        scale = _mixed + GAIN[(_regs[REG_CONTROL] >> 4) & 0x03] * (double)(sim::now() - _started) / sim::MS;
+        _control_written = false;
+        _mixed = 0.0;
+    }
+    double max = atime == 0 ? 37888.0 : 65535.0;
+    double c0 = rate0 * scale;
+    double c1 = rate1 * scale;
+    uint16_t ch0 = (uint16_t)(c0 > max ? max : (c0 < 0 ? 0 : c0));
+    uint16_t ch1 = (uint16_t)(c1 > max ? max : (c1 < 0 ? 0 : c1));
+
+    _regs[REG_C0DATAL]     = ch0 & 0xFF;
+    _regs[REG_C0DATAL + 1] = ch0 >> 8;
+    _regs[REG_C1DATAL]     = ch1 & 0xFF;
+    _regs[REG_C1DATAL + 1] = ch1 >> 8;
+    _regs[REG_STATUS] |= STATUS_AVALID;
+    ++_cycles;
+
+    uint16_t ailt   = _regs[REG_AILTL]   | (_regs[REG_AILTL + 1] << 8);
+    uint16_t aiht   = _regs[REG_AIHTL]   | (_regs[REG_AIHTL + 1] << 8);
+    uint16_t npailt = _regs[REG_NPAILTL] | (_regs[REG_NPAILTL + 1] << 8);
+    uint16_t npaiht = _regs[REG_NPAIHTL] | (_regs[REG_NPAIHTL + 1] << 8);
+
+    /* APERS 0 interrupts on every cycle, whatever the thresholds. */
+    if ((_regs[REG_PERSIST] & 0x0F) == 0) {
+        _regs[REG_STATUS] |= STATUS_AINT;
+    } else if (ch0 < ailt || ch0 > aiht) {
+        uint8_t needed = PERSIST_CYCLES[_regs[REG_PERSIST] & 0x0F];
+        if (++_persist_count >= needed) _regs[REG_STATUS] |= STATUS_AINT;
+    } else {
+        _persist_count = 0;
+    }
+    if (ch0 < npailt || ch0 > npaiht) _regs[REG_STATUS] |= STATUS_NPINTR;
+
+    _update_int();
+    _started = sim::now();
+    _timer = sim::schedule(_started + _period(), [this]() { _complete(); });
+}
+
+void Tsl2591Model::_update_int(void) {
+    uint8_t en = _regs[REG_ENABLE];
+    uint8_t status = _regs[REG_STATUS];
+    bool asserted = ((en & EN_AIEN) && (status & STATUS_AINT))
+                 || ((en & EN_NPIEN) && (status & STATUS_NPINTR));
+    sim::pin_drive(_int, asserted ? 0 : 1);
+}
+
+void Tsl2591Model::_special_function(uint8_t sf) {
+    switch (sf) {
+        case 0x04: _regs[REG_STATUS] |= STATUS_AINT; break;
+        case 0x06: _regs[REG_STATUS] &= ~STATUS_AINT; break;
+        case 0x07: _regs[REG_STATUS] &= ~(STATUS_AINT | STATUS_NPINTR); break;
+        case 0x0A: _regs[REG_STATUS] &= ~STATUS_NPINTR; break;
+        default: break;
+    }
+    _update_int();
+}
+
+void Tsl2591Model::_write_reg(uint8_t addr, uint8_t value) {
+    switch (addr) {
+        case REG_ENABLE: {
+            uint8_t changed = (_regs[REG_ENABLE] ^ value) & (EN_PON | EN_AEN);
+            _regs[REG_ENABLE] = value & 0xD3;
+            if (changed) {
+                ++_power_toggles;
+                _restart();
+            }
+            _update_int();
+            break;
+        }
+        case REG_CONTROL:
+            if (_timer >= 0) {
+                _mixed += GAIN[(_regs[REG_CONTROL] >> 4) & 0x03] * (double)(sim::now() - _started) / sim::MS;
+                _started = sim::now();
+                _control_written = true;
+            }
+            _regs[REG_CONTROL] = value & 0xB7;
+            if (_regs[REG_CONTROL] & 0x80) {
+                /* SRESET */
+                memset(_regs, 0, REG_ID);
+                _regs[REG_STATUS] = 0;
+                _restart();
+            }
+            /* Otherwise an integration in flight runs on to its old end: the
+               datasheet does not say a CONTROL write restarts it. */
+            break;
+        case REG_PID:
+        case REG_ID:
+        case REG_STATUS:
+            break;
+        default:
+            if (addr < REG_PID) _regs[addr] = value;
+            break;
+    }
+}
+
+bool Tsl2591Model::i2c_write(const uint8_t* data, int length) {
+    if (length < 1) return true;
+    uint8_t cmd = data[0];
+    if (!(cmd & CMD_BIT)) return false;
+    if ((cmd & CMD_TRANSACTION) == CMD_SPECIAL) {
+        _special_function(cmd & 0x1F);
+        return true;
+    }
+    _ptr = cmd & 0x1F;
+    for (int i = 1; i < length; ++i) {
+        _write_reg(_ptr, data[i]);
+        _ptr = (_ptr + 1) & 0x1F;
+    }
+    return true;
+}
+
+bool Tsl2591Model::i2c_read(uint8_t* data, int length) {
+    for (int i = 0; i < length; ++i) {
+        data[i] = _regs[_ptr];
+        _ptr = (_ptr + 1) & 0x1F;
+    }
+    return true;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file tsl2591_model.h
+ * @brief Behavioural model of a TSL2591 light-to-digital converter for the
+ * host simulator.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note Integration cycles run on the simulated clock: results land in the
+ * data registers, AVALID is set and the interrupt pin is asserted exactly one
+ * integration period after the ALS is enabled, and every period after that.
+ * The period runs off the part's own oscillator, see set_clock_error.
+ */
+#pragma once
+#include <cstdint>
+#include <functional>
+#include "sim.h"
+
+class Tsl2591Model : public sim::I2CDevice {
+    public:
+        /**
+         * @brief Light reaching the sensor, in counts per millisecond of
+         * integration at 1x gain, for channel 0 (full) and channel 1 (IR).
+         */
+        typedef std::function<void(sim::ns_t t, double* ch0_rate, double* ch1_rate)> Light;
+
+        /**
+         * @brief Construct a new model and attach it to the bus.
+         *
+         * @param sda SDA pin of the bus the sensor sits on, or NC to attach
+         * it behind a mux with Tca9548aModel::attach.
+         * @param int_pin Open drain INT output, or NC.
+         * @param addr7 7-bit address. 0x29 for every TSL2591.
+         */
+        Tsl2591Model(PinName sda, PinName int_pin = NC, uint8_t addr7 = 0x29);
+        ~Tsl2591Model();
+
+        void set_light(double ch0_rate, double ch1_rate);
+        void set_light(Light light);
+
+        /**
+         * @brief Offset the internal oscillator from nominal, so that the
+         * integration period drifts against the host's clock as on a real
+         * board. 0 by default.
+         *
+         * @param ppm Parts per million, positive for a slower oscillator.
+         */
+        void set_clock_error(int32_t ppm) { _clock_error_ppm = ppm; }
+
+        /** @return Current contents of a register. */
+        uint8_t reg(int addr) const { return _regs[addr & 0x1F]; }
+
+        /** @brief Completed integration cycles since construction. */
+        uint32_t cycles(void) const { return _cycles; }
+
+        /** @brief Writes to the ENABLE register that changed PON or AEN. */
+        uint32_t power_toggles(void) const { return _power_toggles; }
+
+        bool i2c_write(const uint8_t* data, int length) override;
+        bool i2c_read(uint8_t* data, int length) override;
+
+    private:
+        void _write_reg(uint8_t addr, uint8_t value);
+        void _special_function(uint8_t sf);
+        void _restart(void);
+        void _complete(void);
+        void _update_int(void);
+        sim::ns_t _period(void) const;
+
+        PinName _sda;
+        PinName _int;
+        uint8_t _addr7;
+        Light _light;
+
+        uint8_t _regs[32];
+        uint8_t _ptr;
+        int _timer;
+        sim::ns_t _started;
+        bool _control_written;
+        double _mixed;
+        uint8_t _persist_count;
+        uint32_t _cycles;
+        uint32_t _power_toggles;
+        int32_t _clock_error_ppm;
+};
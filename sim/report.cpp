@@ -0,0 +1,69 @@
+/**
+ * @file report.cpp
+ * @brief Summaries of a simulation run for the host harnesses.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#include "report.h"
+#include <map>
+
+namespace sim {
+
+IntervalStats can_intervals(uint32_t id) {
+    IntervalStats stats = {0, 0.0, 0.0, 0.0};
+    bool first = true;
+    ns_t last = 0;
+    double total = 0.0;
+    for (const Frame& frame : can_log()) {
+        if (frame.id != id) continue;
+        if (!first) {
+            double dt = (double)(frame.t - last) / MS;
+            if (stats.count == 0 || dt < stats.min_ms) stats.min_ms = dt;
+            if (stats.count == 0 || dt > stats.max_ms) stats.max_ms = dt;
+            total += dt;
+            ++stats.count;
+        }
+        first = false;
+        last = frame.t;
+    }
+    if (stats.count) stats.mean_ms = total / stats.count;
+    return stats;
+}
+
+uint32_t can_count(uint32_t id) {
+    uint32_t count = 0;
+    for (const Frame& frame : can_log()) {
+        if (frame.id == id) ++count;
+    }
+    return count;
+}
+
+void print_can_summary(FILE* out) {
+    std::map<uint32_t, uint32_t> counts;
+    for (const Frame& frame : can_log()) ++counts[frame.id];
+
+    double seconds = (double)now() / S;
+    fprintf(out, "CAN frames:\n");
+    for (auto& entry : counts) {
+        IntervalStats iv = can_intervals(entry.first);
+        fprintf(out, "  0x%03X  %8u frames  %8.3f Hz  interval mean %8.2f ms  min %8.2f ms  max %8.2f ms\n",
+                (unsigned)entry.first, (unsigned)entry.second, entry.second / seconds,
+                iv.mean_ms, iv.min_ms, iv.max_ms);
+    }
+    CanStats stats = can_stats();
+    fprintf(out, "  bus load %.2f %%, tx ok %u, tx mailboxes full %u, rx ok %u, rx overrun %u, rx filtered %u\n",
+            can_bus_load() * 100.0, (unsigned)stats.tx_ok, (unsigned)stats.tx_full,
+            (unsigned)stats.rx_ok, (unsigned)stats.rx_overrun, (unsigned)stats.rx_filtered);
+}
+
+void print_run_summary(FILE* out, const char* name, ns_t simulated, double wall_s) {
+    double seconds = (double)simulated / S;
+    fprintf(out, "%s: simulated %.1f s in %.3f s host time (%.0fx)\n",
+            name, seconds, wall_s, wall_s > 0.0 ? seconds / wall_s : 0.0);
+    I2CStats& i2c = i2c_stats();
+    fprintf(out, "I2C: %u transactions, %u repeated starts, %u bytes, %u NAKs, busy %.2f %%\n",
+            (unsigned)i2c.transactions, (unsigned)i2c.restarts, (unsigned)i2c.bytes, (unsigned)i2c.naks,
+            simulated ? 100.0 * (double)i2c.busy / (double)simulated : 0.0);
+}
+
+} // namespace sim
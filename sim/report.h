@@ -0,0 +1,40 @@
+/**
+ * @file report.h
+ * @brief Summaries of a simulation run for the host harnesses.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include "sim.h"
+
+namespace sim {
+
+/**
+ * @brief Spacing between consecutive frames with one CAN identifier.
+ */
+struct IntervalStats {
+    uint32_t count;
+    double mean_ms;
+    double min_ms;
+    double max_ms;
+};
+
+IntervalStats can_intervals(uint32_t id);
+
+/** @return Number of frames seen on the bus with the given identifier. */
+uint32_t can_count(uint32_t id);
+
+/**
+ * @brief Print per-identifier frame counts and rates, bus load and controller
+ * statistics.
+ */
+void print_can_summary(FILE* out);
+
+/**
+ * @brief Print the run header: simulated time, host time, speed-up.
+ */
+void print_run_summary(FILE* out, const char* name, ns_t simulated, double wall_s);
+
+} // namespace sim
@@ -0,0 +1,92 @@
+/**
+ * @file change_reporter_bench.cpp
+ * @brief An hour of seven slowly drifting, slightly noisy RTDs at 4 Hz
+ * through ChangeReporter, with a step on one of them. Checks that a deadband
+ * of 0.1 C cuts the reports by at least ten, that no channel stays silent
+ * past its keep-alive, that what was last reported never lags the sample by
+ * the deadband or more, that the step goes out with the sample that shows it
+ * and that a deadband of 0 reports every sample.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note Usage: change_reporter_bench
+ */
+#include "mbed.h"
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include "ChangeReporter.h"
+
+#define CHANNELS    7
+#define RATE_HZ     4
+#define SECONDS     3600
+#define DEADBAND    10          /* 0.10 C in 0.01 C */
+#define SILENCE_S   10
+#define STEP_AT     (1800 * RATE_HZ)
+#define STEP        300         /* 3 C, shade on a panel, say */
+
+struct Result {
+    uint32_t samples;
+    uint32_t reports;
+    double longest_s;       /* Between reports of one channel */
+    int32_t worst_lag;      /* Largest |sample - last reported| held back */
+    bool step_reported;
+};
+
+/* Channel ch: 20 + 5 ch C, 2 C over 20 minutes, 0.02 C of noise. */
+static Result run(uint16_t deadband) {
+    ChangeReporter reporter;
+    reporter.configure({ deadband, SILENCE_S });
+    std::mt19937 rng(1);
+    std::normal_distribution<double> noise(0.0, 2.0);
+    Result result = { 0, 0, 0.0, 0, false };
+    int32_t last[CHANNELS];
+    uint64_t last_us[CHANNELS] = {};
+    for (uint32_t n = 0; n < SECONDS * RATE_HZ; ++n) {
+        uint64_t now_us = 1000000ULL * n / RATE_HZ;
+        for (uint8_t ch = 0; ch < CHANNELS; ++ch) {
+            double t = (double)n / RATE_HZ;
+            int32_t value = 2000 + 500 * ch + (int32_t)lround(200.0 * sin(2.0 * M_PI * t / 1200.0) + noise(rng));
+            if (ch == 3 && n >= STEP_AT) value -= STEP;
+            ++result.samples;
+            if (!reporter.due(ch, value, now_us)) {
+                if (abs(value - last[ch]) > result.worst_lag) result.worst_lag = abs(value - last[ch]);
+                continue;
+            }
+            if (n > 0 && (now_us - last_us[ch]) / 1e6 > result.longest_s) result.longest_s = (now_us - last_us[ch]) / 1e6;
+            if (ch == 3 && n == STEP_AT) result.step_reported = true;
+            reporter.reported(ch, value, now_us);
+            last[ch] = value;
+            last_us[ch] = now_us;
+            ++result.reports;
+        }
+    }
+    return result;
+}
+
+int main(void) {
+    bool ok = true;
+    printf("%-10s %8s %8s %10s %10s %6s\n", "deadband", "samples", "reports", "longest", "worst lag", "step");
+    Result every = run(0);
+    Result deadband = run(DEADBAND);
+    for (const Result* r : { &every, &deadband }) {
+        printf("%6.2f C  %8u %8u %8.2f s %8.2f C %6s\n", r == &every ? 0.0 : DEADBAND / 100.0,
+               (unsigned)r->samples, (unsigned)r->reports, r->longest_s, r->worst_lag / 100.0,
+               r->step_reported ? "sent" : "held");
+    }
+    ok = ok && every.reports == every.samples && every.step_reported;
+    printf("reports cut %.1f times\n", (double)deadband.samples / deadband.reports);
+    ok = ok && deadband.reports * 10 <= deadband.samples;
+    ok = ok && deadband.longest_s <= SILENCE_S + 1.0 / RATE_HZ;
+    ok = ok && deadband.worst_lag < DEADBAND && deadband.step_reported;
+
+    /* A keep-alive of 0 takes the default */
+    ChangeReporter reporter;
+    reporter.configure({ DEADBAND, 0 });
+    bool default_ok = reporter.configuration().max_silence_s == REPORT_SILENCE_DEFAULT;
+    printf("keep-alive 0 means %u s\n", reporter.configuration().max_silence_s);
+    ok = ok && default_ok;
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,150 @@
+/**
+ * @file channel_filter_bench.cpp
+ * @brief Runs noisy, spiky RTD-like signals through ChannelFilter in each
+ * mode. Checks that a median of 3 takes out single-sample spikes, that the
+ * EMA and the boxcar cut the noise about as far as they should, that one
+ * output comes per decimation samples, that a round through add_round() gives
+ * the same as each channel through add(), and that configurations which are
+ * not valid are refused and leave the old one in place.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note Usage: channel_filter_bench
+ */
+#include "mbed.h"
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include "ChannelFilter.h"
+
+#define SAMPLES     20000
+#define LEVEL       2500        /* 25.00 C in 0.01 C */
+#define NOISE       40.0        /* Standard deviation, 0.01 C */
+#define SPIKE       30000       /* A dropped bit, say */
+#define SPIKE_EVERY 37          /* Samples between spikes */
+
+struct Result {
+    uint32_t outputs;
+    double std;             /* Of the outputs around LEVEL */
+    int32_t worst;          /* Largest |output - LEVEL| */
+};
+
+/* Channel ch gets its own noise; every SPIKE_EVERY samples, with spikes. */
+static Result run(ChannelFilter& filter, bool spikes, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> noise(0.0, NOISE);
+    Result result = { 0, 0.0, 0 };
+    double sum2 = 0.0;
+    uint32_t counted = 0;
+    for (uint32_t n = 0; n < SAMPLES; ++n) {
+        int32_t values[FILTER_CHANNELS];
+        int32_t out[FILTER_CHANNELS];
+        for (uint8_t ch = 0; ch < FILTER_CHANNELS; ++ch) {
+            values[ch] = LEVEL + (int32_t)lround(noise(rng));
+            if (spikes && (n + 5 * ch) % SPIKE_EVERY == 0) values[ch] += n % 2 ? SPIKE : -SPIKE;
+        }
+        uint8_t ready = filter.add_round(values, 0xFF, out);
+        for (uint8_t ch = 0; ch < FILTER_CHANNELS; ++ch) {
+            if (!(ready >> ch & 0x1)) continue;
+            int32_t error = out[ch] - LEVEL;
+            /* Leave the EMA's settling out of the statistics */
+            if (n >= 1000) {
+                sum2 += (double)error * error;
+                ++counted;
+                if (abs(error) > result.worst) result.worst = abs(error);
+            }
+            ++result.outputs;
+        }
+    }
+    result.std = counted > 0 ? sqrt(sum2 / counted) : 0.0;
+    return result;
+}
+
+int main(void) {
+    bool ok = true;
+    struct Case {
+        const char* name;
+        ChannelFilter::config conf;
+        bool spikes;
+        double gain;        /* Expected noise std relative to NOISE */
+    };
+    /* EMA with shift k: std ratio sqrt(a / (2 - a)), a = 2^-k. Boxcar of D:
+       1 / sqrt(D). A median of 3 on white noise: about 0.67. Sliding medians
+       of 5 are correlated over their window, so a boxcar after them gains
+       less than 1 / sqrt(D): about 0.28 for 16. */
+    const Case cases[] = {
+        { "pass through", { 1, ChannelFilter::MODE_NONE, 1, 1 }, false, 1.0 },
+        { "median 3", { 3, ChannelFilter::MODE_NONE, 1, 1 }, true, 0.67 },
+        { "EMA 1/8", { 1, ChannelFilter::MODE_EMA, 3, 1 }, false, sqrt(0.125 / 1.875) },
+        { "EMA 1/8 / 4", { 1, ChannelFilter::MODE_EMA, 3, 4 }, false, sqrt(0.125 / 1.875) },
+        { "boxcar 8", { 1, ChannelFilter::MODE_BOXCAR, 1, 8 }, false, 1.0 / sqrt(8.0) },
+        { "med 5, box 16", { 5, ChannelFilter::MODE_BOXCAR, 1, 16 }, true, 0.28 },
+    };
+    printf("%-14s %8s %10s %10s %8s\n", "filter", "outputs", "std", "expected", "worst");
+    for (const Case& c : cases) {
+        ChannelFilter filter;
+        ok = ok && filter.configure(c.conf);
+        Result result = run(filter, c.spikes, 1);
+        double expected = NOISE * c.gain;
+        printf("%-14s %8u %8.2f   %8.2f   %8d\n", c.name, (unsigned)result.outputs, result.std, expected,
+               (int)result.worst);
+        /* One output per decimation samples on every channel */
+        ok = ok && result.outputs == FILTER_CHANNELS * (SAMPLES / c.conf.decimation);
+        ok = ok && fabs(result.std / expected - 1.0) < 0.15;
+        /* No spike gets through, not even in part */
+        ok = ok && result.worst < 6 * NOISE;
+    }
+
+    /* add() channel by channel against add_round() */
+    bool same = true;
+    {
+        const ChannelFilter::config conf = { 3, ChannelFilter::MODE_EMA, 2, 3 };
+        ChannelFilter one, round;
+        one.configure(conf);
+        round.configure(conf);
+        std::mt19937 rng(2);
+        std::uniform_int_distribution<int32_t> value(-100000, 100000);
+        for (uint32_t n = 0; n < 3000; ++n) {
+            int32_t values[FILTER_CHANNELS];
+            int32_t out[FILTER_CHANNELS];
+            /* Channels drop out now and then */
+            uint8_t mask = (uint8_t)(rng() | 0x01);
+            for (uint8_t ch = 0; ch < FILTER_CHANNELS; ++ch) values[ch] = value(rng);
+            uint8_t ready = round.add_round(values, mask, out);
+            for (uint8_t ch = 0; ch < FILTER_CHANNELS; ++ch) {
+                if (!(mask >> ch & 0x1)) continue;
+                int32_t single;
+                bool due = one.add(ch, values[ch], &single);
+                same = same && due == (bool)(ready >> ch & 0x1) && (!due || single == out[ch]);
+            }
+        }
+    }
+    printf("add() matches add_round(): %s\n", same ? "yes" : "no");
+    ok = ok && same;
+
+    /* Refused, and the previous configuration kept */
+    const ChannelFilter::config invalid[] = {
+        { 0, ChannelFilter::MODE_NONE, 1, 1 },
+        { 2, ChannelFilter::MODE_NONE, 1, 1 },
+        { FILTER_MEDIAN_MAX + 2, ChannelFilter::MODE_NONE, 1, 1 },
+        { 1, 3, 1, 1 },
+        { 1, ChannelFilter::MODE_EMA, 0, 1 },
+        { 1, ChannelFilter::MODE_EMA, FILTER_EMA_SHIFT_MAX + 1, 1 },
+        { 1, ChannelFilter::MODE_BOXCAR, 1, 0 },
+        { 1, ChannelFilter::MODE_BOXCAR, 1, FILTER_DECIMATE_MAX + 1 },
+    };
+    ChannelFilter filter;
+    const ChannelFilter::config kept = { 3, ChannelFilter::MODE_BOXCAR, 1, 4 };
+    filter.configure(kept);
+    uint32_t refused = 0;
+    for (const ChannelFilter::config& conf : invalid) {
+        if (!filter.configure(conf)) ++refused;
+    }
+    bool kept_ok = filter.configuration().median == kept.median && filter.decimation() == kept.decimation;
+    printf("invalid configurations refused: %u of %u, previous kept: %s\n", (unsigned)refused,
+           (unsigned)(sizeof(invalid) / sizeof(invalid[0])), kept_ok ? "yes" : "no");
+    ok = ok && refused == sizeof(invalid) / sizeof(invalid[0]) && kept_ok;
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,301 @@
+/**
+ * @file cycle_schedule_bench.cpp
+ * @brief Builds CycleSchedule tables for the default Blackbody A rates, for
+ * raised and lowered rates, and for task sets that cannot fit, and runs the
+ * default table on the simulated clock. Checks that slots never overlap, that
+ * every job starts at or after its release and finishes before the next one,
+ * that RTDs are spread over their period, that infeasible sets are reported
+ * with the right reason, that a failed build keeps the previous table, and
+ * that a task with a deadline shorter than its period goes first and misses
+ * when it cannot make it.
+ *
+ * Then runs it with tasks that take a varying share of their run time, and
+ * one cycle that overruns, and checks that the cycle does not drift and that
+ * the measured lateness and periods match.
+ *
+ * Then wakes background work from an interrupt at odd times while the
+ * cycle runs, and checks that it runs at once without moving any slot, and
+ * that it can abort the cycle.
+ *
+ * Last, rebuilds from a task, once successfully and then with a set that
+ * does not fit, and checks that the table built first still takes over.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note Usage: cycle_schedule_bench
+ */
+#include "mbed.h"
+#include <cstdlib>
+#include <vector>
+#include "CycleSchedule.h"
+
+/* Run times as in mainNoCan.cpp. */
+#define HEARTBEAT_US    (200)
+#define RTD_US          (1000)
+#define IRRAD_US        (1500)
+
+struct Config {
+    const char* name;
+    uint16_t rtd_hz;
+    uint8_t rtds;
+    uint16_t irrad_hz;
+    uint8_t irrads;
+    CycleSchedule::build_result expected;
+};
+
+static void nop(uint8_t) {}
+
+/* Same layout as build_schedule() in mainNoCan.cpp. */
+static void add_tasks(CycleSchedule& schedule, const Config& config) {
+    schedule.clear();
+    schedule.add_task(nop, 0, 1, HEARTBEAT_US, 0);
+    uint32_t rtd_period = config.rtd_hz > 0 ? CYCLE_PERIOD_US / config.rtd_hz : CYCLE_PERIOD_US;
+    for (uint8_t idx = 0; idx < config.rtds; ++idx) {
+        schedule.add_task(nop, idx, config.rtd_hz, RTD_US, 2, rtd_period * idx / config.rtds);
+    }
+    if (config.irrads > 0) schedule.add_task(nop, 0, config.irrad_hz, IRRAD_US * config.irrads, 1);
+}
+
+/* Task rate, run time and phase in add_tasks() order. */
+static void task_of(const Config& config, uint8_t task, uint16_t* rate, uint32_t* duration, uint32_t* phase) {
+    if (task == 0) {
+        *rate = 1; *duration = HEARTBEAT_US; *phase = 0;
+    } else if (task <= config.rtds) {
+        *rate = config.rtd_hz; *duration = RTD_US;
+        *phase = CYCLE_PERIOD_US / config.rtd_hz * (task - 1) / config.rtds;
+    } else {
+        *rate = config.irrad_hz; *duration = IRRAD_US * config.irrads; *phase = 0;
+    }
+}
+
+/* Slots in order, no overlap, each job within its release and deadline. */
+static bool check_table(const CycleSchedule& schedule, const Config& config, uint32_t* max_late_us) {
+    bool ok = true;
+    uint32_t end = 0;
+    uint16_t jobs[CYCLE_MAX_TASKS] = {};
+    *max_late_us = 0;
+    for (uint16_t i = 0; i < schedule.slots(); ++i) {
+        uint8_t task = schedule.slot_task(i);
+        uint16_t rate;
+        uint32_t duration, phase;
+        task_of(config, task, &rate, &duration, &phase);
+        uint32_t release = phase + (uint32_t)((uint64_t)jobs[task] * CYCLE_PERIOD_US / rate);
+        uint32_t deadline = phase + (uint32_t)((uint64_t)(jobs[task] + 1) * CYCLE_PERIOD_US / rate);
+        if (deadline > CYCLE_PERIOD_US) deadline = CYCLE_PERIOD_US;
+        uint32_t start = schedule.slot_start(i);
+        ok = ok && start >= end && start >= release && start + duration <= deadline;
+        if (start - release > *max_late_us) *max_late_us = start - release;
+        end = start + duration;
+        ++jobs[task];
+    }
+    uint16_t expected_slots = 1 + config.rtds * config.rtd_hz + (config.irrads > 0 ? config.irrad_hz : 0);
+    return ok && schedule.slots() == expected_slots;
+}
+
+int main(void) {
+    static const Config configs[] = {
+        { "default",          2,  7,  10, 1, CycleSchedule::BUILD_OK },
+        { "thermal test",     10, 7,  10, 1, CycleSchedule::BUILD_OK },
+        { "race, 8 irrads",   1,  7,  5,  8, CycleSchedule::BUILD_OK },
+        { "8 irrads at 10Hz", 2,  7,  10, 8, CycleSchedule::BUILD_OK },
+        { "overloaded",       200, 7, 10, 1, CycleSchedule::BUILD_OVERLOADED },
+        { "8 irrads at 100Hz", 2, 7,  100, 8, CycleSchedule::BUILD_OVERLOADED },
+        { "too many slots",   20, 7,  50, 1, CycleSchedule::BUILD_TOO_MANY_SLOTS },
+    };
+
+    bool ok = true;
+    static CycleSchedule schedule;
+    printf("%-18s %8s %8s %12s %10s %s\n", "config", "result", "slots", "load ppm", "late us", "");
+    for (const Config& config : configs) {
+        add_tasks(schedule, config);
+        CycleSchedule::build_result result = schedule.build();
+        uint32_t late = 0;
+        bool pass = result == config.expected;
+        if (result == CycleSchedule::BUILD_OK) pass = pass && check_table(schedule, config, &late);
+        printf("%-18s %8d %8u %12u %10u %s\n", config.name, result, (unsigned)schedule.slots(),
+               (unsigned)schedule.load_ppm(), (unsigned)late, pass ? "ok" : "BAD");
+        ok = ok && pass;
+    }
+
+    /* Non-preemptive: a long job in front of a short period misses, even at
+       low load. */
+    schedule.clear();
+    schedule.add_task(nop, 0, 100, 6000, 0);
+    schedule.add_task(nop, 1, 1, 9000, 1, 1000);
+    CycleSchedule::build_result result = schedule.build();
+    printf("%-18s %8d %8s %12u %10s %s\n", "blocking", result, "-", (unsigned)schedule.load_ppm(), "-",
+           result == CycleSchedule::BUILD_DEADLINE_MISSED && schedule.failed_task() == 0 ? "ok" : "BAD");
+    ok = ok && result == CycleSchedule::BUILD_DEADLINE_MISSED && schedule.failed_task() == 0;
+
+    /* The failed builds above kept the last good table ("8 irrads at 10Hz"). */
+    Config kept = configs[3];
+    uint32_t late;
+    bool kept_ok = check_table(schedule, kept, &late);
+    printf("failed builds keep the previous table: %s\n", kept_ok ? "yes" : "no");
+    ok = ok && kept_ok;
+
+    /* A deadline of its own puts a short job in front of a longer one released
+       with it, which would otherwise go first on its earlier next release. */
+    schedule.clear();
+    schedule.add_task(nop, 0, 10, 5000, 0);
+    schedule.add_task(nop, 1, 1, 100, 1, 0, 1000);
+    result = schedule.build();
+    bool first = result == CycleSchedule::BUILD_OK && schedule.slot_task(0) == 1 && schedule.slot_start(0) == 0 &&
+                 schedule.slot_task(1) == 0 && schedule.slot_start(1) == 100;
+    printf("%-18s %8d %8s %12u %10s %s\n", "own deadline", result, "-", (unsigned)schedule.load_ppm(), "-",
+           first ? "ok" : "BAD");
+    ok = ok && first;
+    schedule.clear();
+    schedule.add_task(nop, 0, 10, 5000, 0);
+    schedule.add_task(nop, 1, 1, 100, 1, 0, 50);
+    result = schedule.build();
+    printf("%-18s %8d %8s %12u %10s %s\n", "deadline too short", result, "-", (unsigned)schedule.load_ppm(), "-",
+           result == CycleSchedule::BUILD_DEADLINE_MISSED && schedule.failed_task() == 1 ? "ok" : "BAD");
+    ok = ok && result == CycleSchedule::BUILD_DEADLINE_MISSED && schedule.failed_task() == 1;
+
+    /* Run the default table and check when each job starts. */
+    static std::vector<sim::ns_t> heartbeats;
+    static std::vector<sim::ns_t> rtd0;
+    static std::vector<sim::ns_t> irrad;
+    schedule.clear();
+    schedule.add_task([](uint8_t) { heartbeats.push_back(sim::now()); }, 0, 1, HEARTBEAT_US, 0);
+    for (uint8_t idx = 0; idx < 7; ++idx) {
+        schedule.add_task([](uint8_t idx) { if (idx == 0) rtd0.push_back(sim::now()); },
+                          idx, 2, RTD_US, 2, 500000 * idx / 7);
+    }
+    schedule.add_task([](uint8_t) { irrad.push_back(sim::now()); }, 0, 10, IRRAD_US, 1);
+    bool built = schedule.build() == CycleSchedule::BUILD_OK;
+    sim::run([&]() {
+        for (int cycle = 0; cycle < 10; ++cycle) schedule.run_cycle();
+    }, 20 * sim::S);
+
+    bool timing_ok = built && heartbeats.size() == 10 && rtd0.size() == 20 && irrad.size() == 100;
+    for (size_t i = 1; i < heartbeats.size(); ++i) {
+        timing_ok = timing_ok && heartbeats[i] - heartbeats[i - 1] == 1000 * sim::MS;
+    }
+    for (size_t i = 1; i < irrad.size(); ++i) {
+        sim::ns_t gap = irrad[i] - irrad[i - 1];
+        timing_ok = timing_ok && gap >= 99 * sim::MS && gap <= 101 * sim::MS;
+    }
+    printf("simulated: %zu cycles, heartbeat period %s, irradiance every 100 ms %s\n",
+           heartbeats.size(), timing_ok ? "1000 ms" : "off", timing_ok ? "yes" : "no");
+    ok = ok && timing_ok;
+
+    /* Again with the tasks taking up to their whole run time, and one task
+       running a whole period over in cycle 40. */
+    static uint32_t seed = 1;
+    static int cycle_no = 0;
+    static uint32_t late_max = 0;
+    static CycleSchedule::timing_stats before;
+    heartbeats.clear();
+    schedule.clear();
+    schedule.add_task([](uint8_t) {
+        heartbeats.push_back(sim::now());
+        sim::charge((sim::ns_t)(seed % HEARTBEAT_US) * sim::US);
+    }, 0, 1, HEARTBEAT_US, 0);
+    for (uint8_t idx = 0; idx < 7; ++idx) {
+        schedule.add_task([](uint8_t) {
+            seed = seed * 1103515245 + 12345;
+            sim::charge((sim::ns_t)(seed >> 16) % RTD_US * sim::US);
+            if (cycle_no == 40 && seed % 7 == 0) sim::charge(1200 * sim::MS);
+        }, idx, 2, RTD_US, 2, 500000 * idx / 7);
+    }
+    schedule.add_task([](uint8_t) { sim::charge(IRRAD_US * sim::US); }, 0, 10, IRRAD_US, 1);
+    built = schedule.build() == CycleSchedule::BUILD_OK;
+    schedule.reset_timing();
+    sim::run([&]() {
+        for (cycle_no = 0; cycle_no < 80; ++cycle_no) {
+            schedule.run_cycle();
+            if (cycle_no != 39) continue;
+            before = schedule.timing();
+            for (uint16_t i = 0; i < schedule.slots(); ++i) {
+                if (schedule.slot_late_max_us(i) > late_max) late_max = schedule.slot_late_max_us(i);
+            }
+        }
+    }, 200 * sim::S);
+
+    const CycleSchedule::timing_stats& stats = schedule.timing();
+    uint32_t steady = 0;
+    for (size_t i = 1; i < heartbeats.size(); ++i) {
+        if (heartbeats[i] - heartbeats[i - 1] == 1000 * sim::MS) ++steady;
+    }
+    /* Before the overrun no job runs over its run time, so every slot starts
+       on the tick it waits for. */
+    bool drift_ok = built && before.cycles == 40 && before.periods == 40 && before.overruns == 0;
+    drift_ok = drift_ok && before.period_min_us == CYCLE_PERIOD_US && before.period_max_us == CYCLE_PERIOD_US;
+    drift_ok = drift_ok && before.late_max_us == 0 && late_max == 0 && before.late_sum_us == 0;
+    /* The timeline carries on from the run above, so the first period
+       counts. The overrun restarts it once, which costs the period after it;
+       every other cycle is exactly one period. */
+    drift_ok = drift_ok && heartbeats.size() == 80 && steady == 78 && stats.overruns == 1;
+    drift_ok = drift_ok && stats.cycles == 80 && stats.periods == 79;
+    printf("loaded: %u cycles, %u overrun, %u of %u periods 1000 ms, slot late max %u us before it %s\n",
+           (unsigned)stats.cycles, (unsigned)stats.overruns, (unsigned)steady,
+           (unsigned)(heartbeats.size() - 1), (unsigned)late_max, drift_ok ? "ok" : "BAD");
+    ok = ok && drift_ok;
+
+    /* Background work released by a ticker out of step with the table. */
+    static Semaphore wake(0, 1);
+    static sim::ns_t released = 0;
+    static sim::ns_t wake_latency_max = 0;
+    static uint32_t woken = 0;
+    static bool abort_next = false;
+    heartbeats.clear();
+    irrad.clear();
+    schedule.clear();
+    schedule.add_task([](uint8_t) { heartbeats.push_back(sim::now()); }, 0, 1, HEARTBEAT_US, 0);
+    schedule.add_task([](uint8_t) { irrad.push_back(sim::now()); }, 0, 10, IRRAD_US, 1);
+    built = schedule.build() == CycleSchedule::BUILD_OK;
+    schedule.set_background([]() {
+        if (sim::now() - released > wake_latency_max) wake_latency_max = sim::now() - released;
+        ++woken;
+        if (abort_next) schedule.abort_cycle();
+    }, &wake);
+    Ticker ticker;
+    sim::ns_t aborted_after = 0;
+    sim::run([&]() {
+        ticker.attach([]() { released = sim::now(); wake.release(); }, 137ms);
+        for (int cycle = 0; cycle < 10; ++cycle) schedule.run_cycle();
+        abort_next = true;
+        sim::ns_t start = sim::now();
+        schedule.run_cycle();
+        aborted_after = sim::now() - start;
+        ticker.detach();
+    }, 20 * sim::S);
+    schedule.set_background(nullptr, nullptr);
+    bool wake_ok = built && woken >= 10000 / 137 && wake_latency_max < sim::MS;
+    for (size_t i = 1; i < heartbeats.size(); ++i) {
+        wake_ok = wake_ok && heartbeats[i] - heartbeats[i - 1] == 1000 * sim::MS;
+    }
+    for (size_t i = 1; i < irrad.size(); ++i) {
+        sim::ns_t gap = irrad[i] - irrad[i - 1];
+        wake_ok = wake_ok && gap >= 99 * sim::MS && gap <= 101 * sim::MS;
+    }
+    wake_ok = wake_ok && aborted_after < 200 * sim::MS;
+    printf("background: %u wakes, latency max %.3f ms, cycle aborted after %.1f ms %s\n",
+           (unsigned)woken, (double)wake_latency_max / sim::MS, (double)aborted_after / sim::MS,
+           wake_ok ? "ok" : "BAD");
+    ok = ok && wake_ok;
+
+    /* Rebuilt mid-cycle: "thermal test" waits for the next cycle, and an
+       overloaded set built after it must not drop it. */
+    static CycleSchedule::build_result rebuilt[2];
+    schedule.clear();
+    schedule.add_task([](uint8_t) {
+        add_tasks(schedule, configs[1]);
+        rebuilt[0] = schedule.build();
+        add_tasks(schedule, configs[4]);
+        rebuilt[1] = schedule.build();
+    }, 0, 1, HEARTBEAT_US, 0);
+    built = schedule.build() == CycleSchedule::BUILD_OK;
+    sim::run([&]() { schedule.run_cycle(); }, 2 * sim::S);
+    bool waiting = schedule.slots() == 1;
+    sim::run([&]() { schedule.run_cycle(); }, 2 * sim::S);
+    bool pending_ok = built && waiting && rebuilt[0] == CycleSchedule::BUILD_OK
+                      && rebuilt[1] == CycleSchedule::BUILD_OVERLOADED && check_table(schedule, configs[1], &late);
+    printf("failed rebuild keeps the table waiting for the next cycle: %s\n", pending_ok ? "yes" : "no");
+    ok = ok && pending_ok;
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
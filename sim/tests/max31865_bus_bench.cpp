@@ -0,0 +1,116 @@
+/**
+ * @file max31865_bus_bench.cpp
+ * @brief Sixteen MAX31865 on one MAX31865_Bus, each at its own temperature,
+ * two of them with their chip select on pins that double as I2C. Checks that
+ * every chip reads its own temperature, that a chip on the shared bus costs
+ * less RAM than one with a MAX31865_BitBangTransport of its own and about
+ * the same bus time, and that the bus refuses chip selects it cannot drive.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note Usage: max31865_bus_bench
+ */
+#include "mbed.h"
+#include <cmath>
+#include <cstdlib>
+#include "MAX31865_BitBangEnabled.h"
+#include "MAX31865_Bus.h"
+#include "models/max31865_model.h"
+#include "rtd_bench.h"
+
+#define CHIPS       (MAX31865_BUS_CHIPS)
+#define READS       (100)
+
+/* Every free pin of the Nucleo-32 but the console and I2C pins. A4 and A5
+   are bridged to SDA and SCL. */
+static const PinName cs_pins[CHIPS] = {
+    A6, A4, A3, A0, A5, A2, A1, D0, D1, D2, D3, D6, D7, D8, D9, D10
+};
+
+static bool shares_i2c(PinName pin) {
+    return pin == A4 || pin == A5;
+}
+
+/* Mean bus time of a read_all(), us. */
+static double read_us(MAX31865_RTD& rtd) {
+    sim::ns_t t0 = sim::now();
+    for (int i = 0; i < READS; ++i) rtd.read_all();
+    return (double)(sim::now() - t0) / READS / sim::US;
+}
+
+int main(void) {
+    bool ok = true;
+    Max31865Model* chips[CHIPS];
+    for (int i = 0; i < CHIPS; ++i) {
+        chips[i] = new Max31865Model(D12, D11, D13, cs_pins[i]);
+        chips[i]->set_temperature(20.0 + 5.0 * i);
+    }
+
+    I2C i2c(I2C_SDA, I2C_SCL);
+    MAX31865_Bus bus(D12, D11, D13);
+    MAX31865_BusTransport* transports[CHIPS];
+    MAX31865_RTD* rtds[CHIPS];
+    bool added = true;
+    for (int i = 0; i < CHIPS; ++i) {
+        int chip = bus.add(cs_pins[i], shares_i2c(cs_pins[i]) ? &i2c : nullptr);
+        added = added && chip == i;
+        transports[i] = new MAX31865_BusTransport(&bus, (uint8_t)chip);
+        rtds[i] = new MAX31865_RTD(MAX31865_RTD::RTD_PT100, transports[i]);
+    }
+    printf("%u chips on the bus\n", (unsigned)bus.chips());
+    ok = ok && added && bus.chips() == CHIPS;
+
+    /* Each chip answers for itself: a crossed chip select would read another
+       chip, 5 C or more away. */
+    double max_error = 0.0;
+    double bus_us = 0.0, own_us = 0.0;
+    MAX31865_BitBangTransport own(D12, D11, D13, cs_pins[0]);
+    MAX31865_RTD own_rtd(MAX31865_RTD::RTD_PT100, &own);
+    sim::run([&]() {
+        for (int i = 0; i < CHIPS; ++i) configure(*rtds[i]);
+        wait_us(100000);
+        for (int i = 0; i < CHIPS; ++i) {
+            rtds[i]->read_all();
+            double error = fabs(rtds[i]->temperature() - (20.0 + 5.0 * i));
+            if (error > max_error) max_error = error;
+        }
+        bus_us = read_us(*rtds[0]);
+        configure(own_rtd);
+        own_us = read_us(own_rtd);
+    }, 10 * sim::S);
+    printf("max error over %d chips: %.4f C\n", CHIPS, max_error);
+    printf("read_all: %.2f us on the bus, %.2f us on its own pins\n", bus_us, own_us);
+    ok = ok && max_error < MAX_ERROR;
+    /* The bus also holds CS for the MAX31865 setup and hold times */
+    ok = ok && bus_us <= own_us * 1.02;
+
+    /* RAM */
+    size_t own_bytes = sizeof(MAX31865_BitBangTransport);
+    size_t bus_bytes = MAX31865_Bus::channel_bytes();
+    printf("%-24s %10s %10s\n", "RAM", "per chip", "16 chips");
+    printf("%-24s %8u B %8u B\n", "own bit-bang transport", (unsigned)own_bytes, (unsigned)(own_bytes * CHIPS));
+    printf("%-24s %8u B %8u B\n", "shared bus", (unsigned)bus_bytes,
+           (unsigned)(sizeof(MAX31865_Bus) + sizeof(MAX31865_BusTransport) * CHIPS));
+    ok = ok && bus_bytes < own_bytes;
+
+    /* Refused chip selects */
+    MAX31865_Bus spare(D12, D11, D13);
+    const PinName refused[] = { D12, D11, D13, USBTX, A7, USBRX, NC };
+    bool refused_ok = true;
+    for (PinName pin : refused) refused_ok = refused_ok && spare.add(pin) == -1;
+    int first = spare.add(A6);
+    refused_ok = refused_ok && first == 0 && spare.add(A6) == -1;
+    refused_ok = refused_ok && bus.add(D4) == -1;   /* Full */
+    printf("refuses bus, console, duplicate and extra chip selects: %s\n", refused_ok ? "yes" : "no");
+    ok = ok && refused_ok;
+
+    /* A refused chip is nobody: its reads float high. */
+    MAX31865_BusTransport nobody(&spare, (uint8_t)-1);
+    uint8_t tx[2] = { 0x07, 0x00 };
+    uint8_t rx[2] = { 0, 0 };
+    sim::run([&]() { nobody.transfer(tx, rx, 2); }, 1 * sim::S);
+    ok = ok && rx[1] == 0xFF;
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file max31865_fast_bus_bench.cpp
+ * @brief MAX31865_RTD::read_all() over the HAL MAX31865_Bus and over
+ * MAX31865_FastBus at 1 to 5 MHz, with a logic analyser on the bus. Checks
+ * that every bus reads the right temperature, that each edge meets the
+ * MAX31865 interface timing, that SCLK runs at the frequency asked for and
+ * that the fast bus takes a fraction of the time and CPU of the HAL. Then
+ * makes the port accesses cheaper than the fast bus allows for and checks
+ * that the analyser sees SCLK run out of spec.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note Usage: max31865_fast_bus_bench
+ */
+#include "mbed.h"
+#include <cmath>
+#include <cstdlib>
+#include "MAX31865_BitBangEnabled.h"
+#include "MAX31865_FastBus.h"
+#include "models/max31865_model.h"
+#include "models/spi_timing_probe.h"
+#include "rtd_bench.h"
+
+#define READS       (100)
+
+struct BusResult {
+    Result reads;
+    uint32_t sclk_hz;       /* Asked for, 0 for the HAL */
+    double measured_hz;
+    bool timing_ok;
+};
+
+static BusResult bench_bus(const char* name, uint32_t sclk_hz, MAX31865_Bus& bus, SpiTimingProbe& probe) {
+    MAX31865_BusTransport transport(&bus, 0);
+    MAX31865_RTD rtd(MAX31865_RTD::RTD_PT100, &transport);
+    /* The configuration writes toggle SDI; read_all() sends zeros */
+    probe.reset();
+    BusResult result = { bench(name, rtd, &MAX31865_RTD::read_all, READS), sclk_hz, 0.0, false };
+    result.measured_hz = 1e9 / probe.worst().cp;
+    result.timing_ok = probe.bursts() > READS && !*probe.violations();
+    printf("%-12s %10.2f %10.2f %10.4f %9.2f MHz  ", name, result.reads.elapsed_us, result.reads.cpu_us,
+           result.reads.max_error, result.measured_hz / 1e6);
+    probe.print(stdout);
+    return result;
+}
+
+int main(void) {
+    /* Bit-banged, wired as on Blackbody A v0.2.0. */
+    Max31865Model chip(D12, D11, D13, A6);
+    chip.set_temperature(TEMPERATURE);
+    SpiTimingProbe probe(D12, D11, D13, { A6 });
+
+    MAX31865_Bus hal(D12, D11, D13);
+    MAX31865_FastBus<D12, D11, D13, 1000000> fast1;
+    MAX31865_FastBus<D12, D11, D13, 2000000> fast2;
+    MAX31865_FastBus<D12, D11, D13> fast4;
+    MAX31865_FastBus<D12, D11, D13, MAX31865_SCLK_MAX_HZ> fast5;
+    MAX31865_Bus* buses[] = { &hal, &fast1, &fast2, &fast4, &fast5 };
+    for (MAX31865_Bus* bus : buses) bus->add(A6);
+
+    printf("%-12s %10s %10s %10s %13s  %s\n", "bus", "elapsed us", "cpu us", "max err C", "SCLK", "worst timing");
+    BusResult results[] = {
+        bench_bus("hal", 0, hal, probe),
+        bench_bus("fast 1 MHz", 1000000, fast1, probe),
+        bench_bus("fast 2 MHz", 2000000, fast2, probe),
+        bench_bus("fast 4 MHz", MAX31865_FAST_SCLK_HZ, fast4, probe),
+        bench_bus("fast 5 MHz", MAX31865_SCLK_MAX_HZ, fast5, probe),
+    };
+
+    bool ok = true;
+    for (const BusResult& r : results) {
+        ok = ok && r.reads.max_error < MAX_ERROR && r.timing_ok;
+        /* Never faster than asked, and within 5 % of it */
+        if (r.sclk_hz) ok = ok && r.measured_hz <= r.sclk_hz && r.measured_hz > 0.95 * r.sclk_hz;
+    }
+    double speedup = results[0].reads.elapsed_us / results[3].reads.elapsed_us;
+    printf("fast bus at 4 MHz reads %.1f times as fast as the HAL\n", speedup);
+    ok = ok && speedup > 3.0 && results[3].reads.cpu_us < results[0].reads.cpu_us / 3;
+
+    /* A core that reaches the port in 5 ns instead of 25: the waits no longer
+       make up a full half period at 5 MHz. */
+    sim::Costs saved = sim::costs();
+    sim::costs().gpio_reg_write = 5;
+    sim::costs().gpio_reg_read = 5;
+    BusResult tight = bench_bus("fast 5 MHz*", MAX31865_SCLK_MAX_HZ, fast5, probe);
+    sim::costs() = saved;
+    printf("with 5 ns port accesses: %s out of spec\n", *probe.violations() ? probe.violations() : "nothing");
+    ok = ok && !tight.timing_ok;
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
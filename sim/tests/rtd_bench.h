@@ -0,0 +1,59 @@
+/**
+ * @file rtd_bench.h
+ * @brief What the MAX31865_RTD benches share: the chip's temperature, the
+ * error allowed on a reading, the configuration they run, and the timing of
+ * a run of reads.
+ * @version 0.1.0
+ * @date 2026-10-17
+ */
+#pragma once
+#include <cmath>
+#include <functional>
+#include "mbed.h"
+#include "MAX31865_BitBangEnabled.h"
+
+#define TEMPERATURE (37.5)  /* C */
+#define MAX_ERROR   (0.05)  /* C, about two codes */
+
+/* Per-read cost and worst error of a run of reads. */
+struct Result {
+    const char* name;
+    double elapsed_us;
+    double cpu_us;
+    double max_error;
+};
+
+typedef uint8_t (MAX31865_RTD::*ReadFn)(void);
+
+/* Continuous conversion at 50 Hz, no fault detection, thresholds wide open. */
+static inline void configure(MAX31865_RTD& rtd) {
+    rtd.configure(true, true, false, false, MAX31865_FAULT_DETECTION_NONE,
+                  true, true, 0x0000, 0x7fff);
+}
+
+/* Configure, let the first conversion finish, then time n calls of read
+   against a chip at TEMPERATURE. between runs before every read, e.g. to
+   let another SPI user in. */
+static inline Result bench(const char* name, MAX31865_RTD& rtd, ReadFn read, int n,
+                           std::function<void()> between = nullptr) {
+    Result result = { name, 0.0, 0.0, 0.0 };
+    sim::run([&]() {
+        configure(rtd);
+        wait_us(100000);
+        sim::ns_t elapsed = 0;
+        sim::ns_t cpu = 0;
+        for (int i = 0; i < n; ++i) {
+            if (between) between();
+            sim::ns_t t0 = sim::now();
+            sim::ns_t c0 = sim::cpu_time();
+            (rtd.*read)();
+            elapsed += sim::now() - t0;
+            cpu += sim::cpu_time() - c0;
+            double error = fabs(rtd.temperature() - TEMPERATURE);
+            if (error > result.max_error) result.max_error = error;
+        }
+        result.elapsed_us = (double)elapsed / n / sim::US;
+        result.cpu_us = (double)cpu / n / sim::US;
+    }, 60 * sim::S);
+    return result;
+}
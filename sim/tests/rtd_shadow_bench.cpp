@@ -0,0 +1,150 @@
+/**
+ * @file rtd_shadow_bench.cpp
+ * @brief Register traffic of MAX31865_RTD around its shadow of the chip's
+ * configuration and thresholds. Checks that configuring again with the same
+ * values writes nothing, that a shorted element or a chip gone quiet costs no
+ * rewrite of registers the chip still holds, that after a brown-out only the
+ * registers that lost their value are written again, by read_all() or by
+ * verify(), and that the fault detection cycle writes the configuration back
+ * but not the thresholds.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note Usage: rtd_shadow_bench
+ */
+#include "mbed.h"
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "MAX31865_BitBangEnabled.h"
+#include "models/max31865_mock_transport.h"
+#include "models/max31865_model.h"
+#include "rtd_bench.h"
+
+#define READS       (100)
+
+/* Mock bus that counts the configuration and threshold writes, and can go
+   quiet, reading all zeros, like a chip whose SDO is stuck low. */
+class CountingTransport : public MAX31865_Transport {
+    public:
+        CountingTransport(Max31865Model& chip) : _mock(chip) {}
+
+        void transfer(const uint8_t* tx, uint8_t* rx, int length) override {
+            ++transfers;
+            if (tx[0] == 0x80) ++config_writes;
+            if (tx[0] == 0x83 || tx[0] == 0x85) threshold_bytes += length - 1;
+            if (quiet) {
+                for (int i = 0; i < length; ++i) rx[i] = 0x00;
+                return;
+            }
+            _mock.transfer(tx, rx, length);
+        }
+
+        void reset(void) { transfers = config_writes = threshold_bytes = 0; }
+
+        uint32_t transfers = 0;
+        uint32_t config_writes = 0;
+        uint32_t threshold_bytes = 0;
+        bool quiet = false;
+
+    private:
+        Max31865MockTransport _mock;
+};
+
+/* Checks made in the simulation, printed after it: stdout is the
+   firmware's while it runs. */
+struct Check {
+    const char* what;
+    bool ok;
+};
+static std::vector<Check> checks;
+
+static bool check(const char* what, bool ok) {
+    checks.push_back({ what, ok });
+    return ok;
+}
+
+int main(void) {
+    bool ok = true;
+    Max31865Model chip(D11, D12, D13, A3);
+    chip.set_temperature(TEMPERATURE);
+    CountingTransport bus(chip);
+    MAX31865_RTD rtd(MAX31865_RTD::RTD_PT100, &bus);
+
+    double read_us = 0.0;
+    sim::run([&]() {
+        /* First configuration: everything, once. */
+        configure(rtd);
+        ok &= check("configure writes config and both thresholds",
+                    bus.config_writes == 1 && bus.threshold_bytes == 4 && bus.transfers == 2);
+        bus.reset();
+        configure(rtd);
+        ok &= check("configure again writes nothing", bus.transfers == 0);
+        wait_us(100000);
+
+        bus.reset();
+        for (int i = 0; i < READS; ++i) rtd.read_all();
+        ok &= check("read_all on a sound chip: one burst each", bus.transfers == READS);
+
+        /* A shorted element reads zero and trips the low threshold: the
+           fault is cleared, the registers the chip holds are left alone and
+           nothing waits. */
+        chip.set_wiring_fault(MAX31865_FAULT_RTDIN_FORCE, 0);
+        bus.reset();
+        sim::ns_t t0 = sim::now();
+        for (int i = 0; i < READS; ++i) rtd.read_all();
+        read_us = (double)(sim::now() - t0) / READS / sim::US;
+        ok &= check("shorted: fault clear only, no threshold writes",
+                    bus.config_writes == READS && bus.threshold_bytes == 0 && bus.transfers == 2 * READS);
+        ok &= check("shorted: no 100 us reconfiguration wait", read_us < 100.0);
+        ok &= check("shorted: fault still reported", (rtd.status() & MAX31865_FAULT_LOW_THRESHOLD) != 0);
+        chip.set_wiring_fault(0);
+
+        /* A chip gone quiet reads zero with no fault bit: read_resistance()
+           only flags the channel for verify(). */
+        bus.quiet = true;
+        bus.reset();
+        for (int i = 0; i < READS; ++i) rtd.read_resistance();
+        ok &= check("quiet: read_resistance one burst each, no writes",
+                    bus.transfers == READS && bus.config_writes == 0 && bus.threshold_bytes == 0);
+        ok &= check("quiet: verify pending", rtd.verify_pending());
+
+        /* It browns out and comes back: configuration 0, HFT 0xFFFF, LFT 0,
+           which is what was written. */
+        chip.power_cycle();
+        bus.quiet = false;
+        bus.reset();
+        uint8_t written = rtd.verify();
+        ok &= check("verify after a brown-out: config and high threshold",
+                    written == (MAX31865_REG_CONFIGURATION | MAX31865_REG_HIGH_THRESHOLD)
+                    && bus.config_writes == 1 && bus.threshold_bytes == 2 && !rtd.verify_pending());
+        ok &= check("high threshold restored", chip.reg(0x03) == 0x7f && chip.reg(0x04) == 0xff);
+        bus.reset();
+        written = rtd.verify();
+        ok &= check("verify again: read only", written == 0 && bus.transfers == 1);
+
+        /* Same again, found by read_all(). */
+        chip.power_cycle();
+        wait_us(100000);
+        bus.reset();
+        rtd.read_all();
+        ok &= check("read_all after a brown-out: config and high threshold",
+                    bus.config_writes == 1 && bus.threshold_bytes == 2);
+        wait_us(100000);
+        rtd.read_all();
+        ok &= check("reads the temperature again", fabs(rtd.temperature() - TEMPERATURE) < 0.05);
+
+        /* The fault detection cycle: its own configuration, then back to the
+           stored one; the thresholds stay. */
+        bus.reset();
+        uint8_t status = rtd.detect_faults();
+        ok &= check("detect_faults: config twice, no threshold writes",
+                    status == 0 && bus.config_writes == 2 && bus.threshold_bytes == 0);
+    }, 10 * sim::S);
+
+    for (const Check& c : checks) printf("%-56s %s\n", c.what, c.ok ? "ok" : "FAIL");
+    printf("read_all on a shorted element: %.1f us\n", read_us);
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
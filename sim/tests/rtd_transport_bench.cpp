@@ -0,0 +1,126 @@
+/**
+ * @file rtd_transport_bench.cpp
+ * @brief Per-read cost of MAX31865_RTD::read_all() and the read_resistance()
+ * fast path over each transport: bit-banged GPIO, hardware SPI with DMA, and
+ * the host mock. Checks that every transport reads the same temperature, that
+ * the fast path saves most of the bus time, and that the hardware SPI
+ * transport survives another SPI object reclaiming the peripheral between
+ * reads. Then runs the fault detection cycle on a sound, an open and a
+ * missing chip, and checks each comes back with what it should and that
+ * sampling carries on after.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note Usage: rtd_transport_bench [-n reads]
+ */
+#include "mbed.h"
+#include <cmath>
+#include <cstdlib>
+#include "MAX31865_BitBangEnabled.h"
+#include "MAX31865_SPITransport.h"
+#include "models/max31865_mock_transport.h"
+#include "models/max31865_model.h"
+#include "rtd_bench.h"
+
+int main(int argc, char** argv) {
+    int n = 1000;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) n = atoi(argv[++i]);
+    }
+
+    /* Bit-banged, wired as on Blackbody A v0.2.0. */
+    Max31865Model bb_chip(D12, D11, D13, A6);
+    bb_chip.set_temperature(TEMPERATURE);
+    MAX31865_BitBangTransport bb_bus(D12, D11, D13, A6);
+    MAX31865_RTD bb_rtd(MAX31865_RTD::RTD_PT100, &bb_bus);
+
+    /* Hardware SPI1, SDI on MOSI (D11) and SDO on MISO (D12). */
+    Max31865Model hw_chip(D11, D12, D13, A4);
+    hw_chip.set_temperature(TEMPERATURE);
+    SPI spi(D11, D12, D13);
+    MAX31865_SPITransport hw_bus(&spi, A4);
+    MAX31865_RTD hw_rtd(MAX31865_RTD::RTD_PT100, &hw_bus);
+
+    /* Host mock. */
+    Max31865Model mock_chip(D11, D12, D13, A3);
+    mock_chip.set_temperature(TEMPERATURE);
+    Max31865MockTransport mock_bus(mock_chip);
+    MAX31865_RTD mock_rtd(MAX31865_RTD::RTD_PT100, &mock_bus);
+
+    /* Another SPI1 user, e.g. a second driver, in mode 0. */
+    SPI other(D11, D12, D13);
+    other.format(8, 0);
+
+    Result results[] = {
+        bench("bit-bang", bb_rtd, &MAX31865_RTD::read_all, n),
+        bench("bit-bang fast", bb_rtd, &MAX31865_RTD::read_resistance, n),
+        bench("spi+dma", hw_rtd, &MAX31865_RTD::read_all, n),
+        bench("spi+dma fast", hw_rtd, &MAX31865_RTD::read_resistance, n),
+        bench("spi+dma shared", hw_rtd, &MAX31865_RTD::read_all, n,
+              [&]() { other.write(0x00); }),
+        bench("mock", mock_rtd, &MAX31865_RTD::read_all, n),
+        bench("mock fast", mock_rtd, &MAX31865_RTD::read_resistance, n),
+    };
+
+    printf("%-16s %12s %12s %12s\n", "transport", "elapsed us", "cpu us", "max err C");
+    bool ok = true;
+    for (const Result& r : results) {
+        printf("%-16s %12.2f %12.2f %12.4f\n", r.name, r.elapsed_us, r.cpu_us, r.max_error);
+        ok = ok && r.max_error < MAX_ERROR;
+    }
+    ok = ok && hw_chip.mode_errors() == 0;
+
+    /* The reclaim glitch the SPI transport works around is real: a burst that
+       lets the peripheral reinitialize after CS goes low reads garbage. */
+    bool glitched = false;
+    sim::run([&]() {
+        DigitalOut cs(A4, 1);
+        other.write(0x00);
+        char tx[3] = { 0x01, 0x00, 0x00 };
+        char rx[3];
+        cs = 0;
+        spi.write(tx, 3, rx, 3);
+        cs = 1;
+        uint16_t code = (uint16_t)((((uint8_t)rx[1] << 8) | (uint8_t)rx[2]) >> 1);
+        glitched = code != hw_chip.code_at(TEMPERATURE);
+    }, 1 * sim::S);
+    printf("unguarded reclaim corrupts burst: %s\n", glitched ? "yes" : "no");
+    ok = ok && glitched;
+
+    /* The fast path moves 3 bytes instead of 9. */
+    double saving = 1.0 - results[1].elapsed_us / results[0].elapsed_us;
+    printf("bit-bang fast path saves %.0f %% of bus time\n", 100.0 * saving);
+    ok = ok && saving > 0.6;
+
+    /* DMA must leave the CPU free for most of the burst. */
+    ok = ok && results[2].cpu_us < results[0].cpu_us / 4;
+
+    /* Fault detection: the cycle, then a read on the restored
+       configuration. No chip answers on A0. */
+    MAX31865_BitBangTransport none_bus(D12, D11, D13, A0);
+    MAX31865_RTD none_rtd(MAX31865_RTD::RTD_PT100, &none_bus);
+    uint8_t sound = 0xFF, open = 0, missing = 0;
+    double cycle_us = 0.0, after_error = 1e9;
+    sim::run([&]() {
+        configure(bb_rtd);
+        sim::ns_t t0 = sim::now();
+        sound = bb_rtd.detect_faults();
+        cycle_us = (double)(sim::now() - t0) / sim::US;
+        bb_chip.set_wiring_fault(MAX31865_FAULT_REFIN_FORCE);
+        open = bb_rtd.detect_faults();
+        bb_chip.set_wiring_fault(0);
+        bb_rtd.detect_faults();
+        wait_us(100000);
+        bb_rtd.read_all();
+        after_error = fabs(bb_rtd.temperature() - TEMPERATURE);
+        configure(none_rtd);
+        missing = none_rtd.detect_faults();
+    }, 1 * sim::S);
+    printf("fault cycle: %.0f us, sound 0x%02x, open 0x%02x, missing 0x%02x, %u cycles run, "
+           "%.4f C off after\n", cycle_us, sound, open, missing, (unsigned)bb_chip.fault_cycles(), after_error);
+    ok = ok && sound == 0 && open == MAX31865_FAULT_REFIN_FORCE && bb_chip.fault_cycles() == 3;
+    ok = ok && after_error < MAX_ERROR && missing == MAX31865_FAULT_CYCLE_TIMEOUT;
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
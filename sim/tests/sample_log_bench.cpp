@@ -0,0 +1,152 @@
+/**
+ * @file sample_log_bench.cpp
+ * @brief Fills SampleLog past its depth and dumps it back over the bus: the
+ * whole ring, a time range, a dump that the log overruns and a cancelled
+ * one. Checks that each dump sends exactly the records asked for, oldest
+ * first and intact, that its CAN_LOG_DUMP_END adds up, that values beyond an
+ * int16 come back clipped and flagged, and that the dump never fills the
+ * bulk ring.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note Usage: sample_log_bench
+ */
+#include "mbed.h"
+#include <cstdlib>
+#include "CanTxQueue.h"
+#include "SampleLog.h"
+#include "TimeSync.h"
+
+/* Record n: channel n % 11, value 20 n - 4000, which outgrows an int16 past
+   n = 1838, taken at 1 ms + n ms. */
+#define CHANNELS    11
+
+static int32_t value_of(uint32_t n) { return 20 * (int32_t)n - 4000; }
+static uint8_t channel_of(uint32_t n) { return n % CHANNELS | (n % 2 ? SAMPLE_LOG_IRRAD : 0); }
+
+struct Dump {
+    uint32_t records;
+    uint32_t first;     /* n of the first record */
+    bool in_order;      /* Ascending n, each intact */
+    bool clipped_ok;
+    bool ended;
+    uint16_t sent;
+    uint16_t lost;
+    uint32_t oldest_ms;
+    double ms;          /* Request to CAN_LOG_DUMP_END */
+};
+
+static Dump decode(size_t first_frame, sim::ns_t start) {
+    Dump dump = { 0, 0, true, true, false, 0, 0, 0, 0.0 };
+    uint32_t last = 0;
+    for (size_t i = first_frame; i < sim::can_log().size(); ++i) {
+        const sim::Frame& frame = sim::can_log()[i];
+        if (frame.id == CAN_LOG_DUMP_END) {
+            dump.ended = true;
+            memcpy(&dump.sent, &frame.data[0], 2);
+            memcpy(&dump.lost, &frame.data[2], 2);
+            memcpy(&dump.oldest_ms, &frame.data[4], 4);
+            dump.ms = (double)(frame.t - start) / sim::MS;
+            continue;
+        }
+        if (frame.id != CAN_LOG_DUMP) continue;
+        SampleLog::record r;
+        memcpy(&r, frame.data, sizeof(r));
+        uint32_t n = r.time_ms - 1;
+        if (dump.records == 0) dump.first = n;
+        else dump.in_order = dump.in_order && n > last;
+        int32_t value = value_of(n);
+        bool clipped = value > INT16_MAX;
+        dump.in_order = dump.in_order && r.channel == channel_of(n) && !(r.flags & SAMPLE_LOG_LOCKED);
+        dump.in_order = dump.in_order && (clipped || r.value == value);
+        dump.clipped_ok = dump.clipped_ok && (clipped ? r.value == INT16_MAX && (r.flags & SAMPLE_LOG_CLIPPED)
+                                                      : !(r.flags & SAMPLE_LOG_CLIPPED));
+        last = n;
+        ++dump.records;
+    }
+    return dump;
+}
+
+int main(void) {
+    bool ok = true;
+    static IsrCAN can(D10, D2);
+    static CanTxQueue can_tx(&can);
+    /* Never hears a master, so the common time base is board uptime. */
+    static TimeSync time(&can_tx, false);
+    static SampleLog log(&can_tx, &time);
+
+    /* Fill past the depth. Record n is stamped 1 + n ms after start. */
+    const uint32_t total = SAMPLE_LOG_DEPTH + SAMPLE_LOG_DEPTH / 2 + 7;
+    uint32_t added = 0;
+    auto fill = [&](uint32_t count) {
+        for (uint32_t i = 0; i < count; ++i, ++added) {
+            log.add(channel_of(added), value_of(added), 1000 + 1000 * (uint64_t)added);
+        }
+    };
+    fill(total);
+
+    struct Case {
+        const char* name;
+        uint32_t from_ms;
+        uint32_t to_ms;
+        uint32_t overrun;   /* Records added once the dump is under way */
+        bool cancel;
+        uint32_t records;
+        uint32_t first;
+        uint16_t lost;
+    };
+    uint32_t oldest = total - SAMPLE_LOG_DEPTH;
+    const Case cases[] = {
+        { "whole ring", 0, 0xFFFFFFFF, 0, false, SAMPLE_LOG_DEPTH, oldest, 0 },
+        { "range", 1 + total - 500, 1 + total - 200, 0, false, 300, total - 500, 0 },
+        { "overrun", 0, 0xFFFFFFFF, SAMPLE_LOG_DEPTH / 2, false, 0, 0, 0 },
+        { "cancelled", 0, 0xFFFFFFFF, 0, true, 0, 0, 0 },
+    };
+    uint32_t clipped = 0;
+    for (uint32_t n = oldest; n < total; ++n) clipped += value_of(n) > INT16_MAX;
+    printf("%-12s %8s %8s %6s %8s %10s\n", "dump", "records", "sent", "lost", "in order", "time");
+    uint8_t bulk_high_water = 0;
+    for (const Case& c : cases) {
+        size_t first = sim::can_log().size();
+        sim::ns_t start = sim::now();
+        sim::run([&]() {
+            log.start_dump(c.from_ms, c.to_ms);
+            bool overrun = c.overrun == 0;
+            for (int pumps = 0; pumps < 400 && log.dumping(); ++pumps) {
+                log.pump();
+                uint8_t pending = can_tx.pending(CanTxQueue::PRIORITY_BULK);
+                if (pending > bulk_high_water) bulk_high_water = pending;
+                if (!overrun) {
+                    fill(c.overrun);
+                    overrun = true;
+                }
+                if (c.cancel && pumps == 2) log.cancel_dump();
+                ThisThread::sleep_for(100ms);
+            }
+        }, 60 * sim::S);
+        Dump dump = decode(first, start);
+        printf("%-12s %8u %8u %6u %8s %7.0f ms\n", c.name, (unsigned)dump.records, dump.sent, dump.lost,
+               dump.in_order ? "yes" : "no", dump.ms);
+        ok = ok && dump.ended && dump.in_order && dump.clipped_ok && dump.sent == dump.records;
+        if (c.cancel) {
+            ok = ok && dump.records > 0 && dump.records < SAMPLE_LOG_DEPTH;
+        } else if (c.overrun > 0) {
+            /* What the dump had not reached is gone; the rest came out. */
+            ok = ok && dump.lost > 0 && dump.records + dump.lost == SAMPLE_LOG_DEPTH;
+            ok = ok && dump.oldest_ms == 1 + added - SAMPLE_LOG_DEPTH;
+        } else {
+            ok = ok && dump.records == c.records && dump.first == c.first && dump.lost == c.lost;
+            ok = ok && dump.oldest_ms == 1 + added - SAMPLE_LOG_DEPTH;
+        }
+    }
+    printf("clipped records in the ring: %u\n", (unsigned)clipped);
+    ok = ok && clipped > 0;
+    /* Headroom for other bulk frames; at 100 kbit/s a full ring takes about
+       12 s. */
+    printf("bulk ring high water %u of %u\n", bulk_high_water, CAN_TX_DEPTH);
+    ok = ok && bulk_high_water <= CAN_TX_DEPTH - SAMPLE_LOG_HEADROOM;
+    ok = ok && can_tx.statistics(CanTxQueue::PRIORITY_BULK).dropped == 0;
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file sample_packer_bench.cpp
+ * @brief Packs rounds of eight, three and sixteen channels through
+ * SamplePacker and decodes the frames off the bus. Checks the frame count per
+ * round, that every value comes back on its channel, that frames of a round
+ * share a sequence number and that a new round moves it on, also when it
+ * only reports a channel above the last round's, as with report-on-change.
+ * Checks that channels past the last bank are refused.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note Usage: sample_packer_bench
+ */
+#include "mbed.h"
+#include <cstdlib>
+#include <map>
+#include "CanTxQueue.h"
+#include "SamplePacker.h"
+
+#define CAN_RTD_PACKED  0x62B
+
+/* One packed round as seen on the bus. */
+struct Round {
+    uint32_t frames;
+    std::map<int, int16_t> values;
+    uint8_t sequence;
+    bool same_sequence;
+};
+
+static Round decode(size_t first) {
+    Round round = { 0, {}, 0, true };
+    for (size_t i = first; i < sim::can_log().size(); ++i) {
+        const sim::Frame& frame = sim::can_log()[i];
+        if (frame.id != CAN_RTD_PACKED || frame.len != 8) continue;
+        uint8_t sequence = frame.data[7] & 0x1F;
+        if (round.frames == 0) round.sequence = sequence;
+        round.same_sequence = round.same_sequence && sequence == round.sequence;
+        int bank = frame.data[7] >> 5;
+        int n = 0;
+        for (int bit = 0; bit < 8; ++bit) {
+            if (!(frame.data[0] >> bit & 1)) continue;
+            round.values[8 * bank + bit] = (int16_t)(frame.data[1 + 2 * n] | frame.data[2 + 2 * n] << 8);
+            ++n;
+        }
+        ++round.frames;
+    }
+    return round;
+}
+
+/* Value of a channel, negative on odd ones to cover the sign. */
+static int16_t value_of(int channel) {
+    return (int16_t)((channel & 1 ? -1 : 1) * (2500 + 101 * channel));
+}
+
+int main(void) {
+    bool ok = true;
+    static IsrCAN can(D10, D2);
+    static CanTxQueue can_tx(&can);
+    static SamplePacker packer(&can_tx, CAN_RTD_PACKED);
+
+    struct Case {
+        const char* name;
+        int first;
+        int count;
+        int step;
+        uint32_t frames;
+    };
+    const Case cases[] = {
+        { "8 channels", 0, 8, 1, 3 },
+        { "3 of 8", 1, 3, 3, 1 },
+        { "16 channels", 0, 16, 1, 6 },
+        { "5 only", 5, 1, 1, 1 },
+        { "6 only", 6, 1, 1, 1 },
+        { "63 only", PACKED_MAX_CHANNEL, 1, 1, 1 },
+    };
+    printf("%-12s %8s %8s %10s %9s\n", "round", "samples", "frames", "sequence", "decoded");
+    uint8_t last_sequence = 0xFF;
+    for (const Case& c : cases) {
+        size_t first = sim::can_log().size();
+        sim::run([&]() {
+            for (int i = 0; i < c.count; ++i) {
+                int channel = c.first + i * c.step;
+                packer.add(channel, value_of(channel));
+            }
+            packer.next_round();
+            ThisThread::sleep_for(50ms);
+        }, sim::S);
+        Round round = decode(first);
+        bool decoded = (int)round.values.size() == c.count;
+        for (int i = 0; i < c.count; ++i) {
+            int channel = c.first + i * c.step;
+            decoded = decoded && round.values.count(channel) && round.values[channel] == value_of(channel);
+        }
+        printf("%-12s %8d %8u %10u %9s\n", c.name, c.count, (unsigned)round.frames,
+               (unsigned)round.sequence, decoded ? "yes" : "no");
+        ok = ok && round.frames == c.frames && decoded && round.same_sequence;
+        ok = ok && round.sequence != last_sequence;
+        last_sequence = round.sequence;
+    }
+
+    bool refused = false;
+    size_t before = sim::can_log().size();
+    sim::run([&]() {
+        refused = !packer.add(PACKED_MAX_CHANNEL + 1, 1);
+        packer.next_round();
+        ThisThread::sleep_for(50ms);
+    }, sim::S);
+    refused = refused && sim::can_log().size() == before;
+    printf("channel %d refused: %s\n", PACKED_MAX_CHANNEL + 1, refused ? "yes" : "no");
+    ok = ok && refused;
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
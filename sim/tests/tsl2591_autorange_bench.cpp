@@ -0,0 +1,128 @@
+/**
+ * @file tsl2591_autorange_bench.cpp
+ * @brief Steps a TSL2591 through full sun, overcast, dusk and dark light
+ * levels and back, with auto range on and with the fixed 1x / 100 ms setting.
+ * Checks that auto range settles within a few readings without clipping,
+ * keeps the normalized reading (counts per gain x ms) within the precision
+ * target, and keeps the shortest integration, so 10 Hz, whenever there is
+ * enough light.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note Usage: tsl2591_autorange_bench [-t seconds per level]
+ */
+#include "mbed.h"
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "TSL2591.hpp"
+#include "models/tsl2591_mock_bus.h"
+#include "models/tsl2591_model.h"
+
+/* Readings allowed to settle after a step change. */
+#define MAX_SETTLE      (4)
+
+/* Counts per (gain x ms) of channel 0; channel 1 is a sixth of it. */
+struct Level {
+    const char* name;
+    double rate;
+    double min_hz;
+};
+
+static const Level levels[] = {
+    { "sun",      123.4,     9.5 },
+    { "overcast", 4.321,     9.5 },
+    { "dusk",     0.04321,   9.5 },
+    { "dark",     0.0004321, 3.0 },
+    { "sun",      123.4,     9.5 },
+};
+
+struct Reading {
+    int level;
+    sim::ns_t t;
+    double rate;
+    bool saturated;
+    tsl2591Gain_t gain;
+    tsl2591IntegrationTime_t integ;
+};
+
+static std::vector<Reading> stream(bool auto_range, double seconds) {
+    Tsl2591Model chip(A4);
+    Tsl2591MockBus bus(chip);
+    std::vector<Reading> readings;
+    int level = 0;
+    chip.set_light([&](sim::ns_t, double* ch0, double* ch1) {
+        *ch0 = levels[level].rate;
+        *ch1 = levels[level].rate / 6;
+    });
+    sim::run([&]() {
+        TSL2591 sensor(&bus);
+        sensor.setAutoRange(auto_range);
+        sensor.startContinuousALS();
+        for (level = 0; level < (int)(sizeof(levels) / sizeof(levels[0])); ++level) {
+            sim::ns_t end = sim::now() + (sim::ns_t)(seconds * sim::S);
+            while (sim::now() < end) {
+                while (!sensor.ready) ThisThread::sleep_for(1ms);
+                tsl2591Gain_t gain = sensor.getGain();
+                tsl2591IntegrationTime_t integ = sensor.getTime();
+                if (!sensor.readALS()) continue;
+                readings.push_back({ level, sim::now(), sensor.fullRate, sensor.saturated, gain, integ });
+            }
+        }
+        sensor.stopALS();
+    }, 3600 * sim::S);
+    return readings;
+}
+
+static const char* gain_name(tsl2591Gain_t gain) {
+    switch (gain) {
+        case TSL2591_GAIN_LOW:  return "1x";
+        case TSL2591_GAIN_MED:  return "25x";
+        case TSL2591_GAIN_HIGH: return "428x";
+        default:                return "9876x";
+    }
+}
+
+int main(int argc, char** argv) {
+    double seconds = 10.0;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-t") && i + 1 < argc) seconds = atof(argv[++i]);
+    }
+
+    bool ok = true;
+    for (bool auto_range : { false, true }) {
+        std::vector<Reading> readings = stream(auto_range, seconds);
+        printf("%s\n", auto_range ? "auto range" : "fixed 1x / 100 ms");
+        printf("%-10s %8s %8s %8s %10s %12s\n", "level", "settle", "gain", "ms", "rate Hz", "max err %");
+        for (int level = 0; level < (int)(sizeof(levels) / sizeof(levels[0])); ++level) {
+            std::vector<Reading> in;
+            for (const Reading& r : readings) if (r.level == level) in.push_back(r);
+            /* Settled after the last reading that clipped or missed the
+               precision target. */
+            int settle = 0;
+            for (int i = 0; i < (int)in.size(); ++i) {
+                double error = fabs(in[i].rate - levels[level].rate) / levels[level].rate;
+                if (in[i].saturated || error > 0.001) settle = i + 1;
+            }
+            double max_error = 0.0;
+            for (int i = settle; i < (int)in.size(); ++i) {
+                double error = fabs(in[i].rate - levels[level].rate) / levels[level].rate;
+                if (error > max_error) max_error = error;
+            }
+            int settled = (int)in.size() - settle;
+            double hz = settled > 1
+                ? (settled - 1) / ((double)(in.back().t - in[settle].t) / sim::S) : 0.0;
+            const Reading& last = in.back();
+            printf("%-10s %8d %8s %8d %10.2f %12.4f\n", levels[level].name, settle,
+                   gain_name(last.gain), (last.integ + 1) * 100, hz,
+                   settled > 0 ? 100.0 * max_error : 100.0);
+            if (auto_range) {
+                ok = ok && settle <= MAX_SETTLE && settled > 0 && hz >= levels[level].min_hz;
+            }
+        }
+        printf("\n");
+    }
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,168 @@
+/**
+ * @file tsl2591_i2c_bench.cpp
+ * @brief Per-reading I2C cost of TSL2591::readALS(). Compares the old access
+ * pattern (separate STATUS, CHAN1 and CHAN0 write + read transactions at the
+ * default 100 kHz) against the burst read through TSL2591_I2CBus at 100 kHz,
+ * 400 kHz and 1 MHz, and through the host mock bus. Checks that every path
+ * reads the same counts and that the burst saves most of the transactions
+ * and bus time.
+ * @version 0.1.0
+ * @date 2026-10-17
+ *
+ * @note Usage: tsl2591_i2c_bench [-n readings]
+ */
+#include "mbed.h"
+#include <cstdlib>
+#include "TSL2591.hpp"
+#include "TSL2591_I2CBus.h"
+#include "models/tsl2591_mock_bus.h"
+#include "models/tsl2591_model.h"
+
+/* Counts per ms at 1x gain; 100 ms integrations give these counts. */
+#define CH0_RATE    (50.0)
+#define CH1_RATE    (8.0)
+#define CH0_COUNTS  (5000)
+#define CH1_COUNTS  (800)
+
+struct Result {
+    const char* name;
+    double transactions;
+    double bytes;
+    double elapsed_us;
+    double cpu_us;
+    bool counts_ok;
+};
+
+/* Stream, and time n harvests of a fresh result with readALS(). */
+static Result bench(const char* name, TSL2591_Bus* bus, int n,
+                    std::function<void(uint32_t*, uint32_t*)> counters) {
+    Result result = { name, 0.0, 0.0, 0.0, 0.0, true };
+    sim::run([&]() {
+        TSL2591 sensor(bus);
+        sensor.startContinuousALS();
+        sim::ns_t elapsed = 0;
+        sim::ns_t cpu = 0;
+        uint32_t transactions = 0;
+        uint32_t bytes = 0;
+        for (int i = 0; i < n; ++i) {
+            while (!sensor.ready) ThisThread::sleep_for(1ms);
+            uint32_t t0_transactions, t0_bytes, t1_transactions, t1_bytes;
+            counters(&t0_transactions, &t0_bytes);
+            sim::ns_t t0 = sim::now();
+            sim::ns_t c0 = sim::cpu_time();
+            bool read = sensor.readALS();
+            elapsed += sim::now() - t0;
+            cpu += sim::cpu_time() - c0;
+            counters(&t1_transactions, &t1_bytes);
+            transactions += t1_transactions - t0_transactions;
+            bytes += t1_bytes - t0_bytes;
+            result.counts_ok = result.counts_ok && read
+                && sensor.full == CH0_COUNTS && sensor.ir == CH1_COUNTS;
+        }
+        sensor.stopALS();
+        result.transactions = (double)transactions / n;
+        result.bytes = (double)bytes / n;
+        result.elapsed_us = (double)elapsed / n / sim::US;
+        result.cpu_us = (double)cpu / n / sim::US;
+    }, 600 * sim::S);
+    return result;
+}
+
+static void shim_counters(uint32_t* transactions, uint32_t* bytes) {
+    *transactions = sim::i2c_stats().transactions;
+    *bytes = sim::i2c_stats().bytes;
+}
+
+int main(int argc, char** argv) {
+    int n = 100;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) n = atoi(argv[++i]);
+    }
+
+    /* On the board's bus, D4/D5. */
+    Tsl2591Model chip(D4);
+    chip.set_light(CH0_RATE, CH1_RATE);
+    I2C i2c(D4, D5);
+
+    /* Host mock, on a bus of its own. */
+    Tsl2591Model mock_chip(A4);
+    mock_chip.set_light(CH0_RATE, CH1_RATE);
+    Tsl2591MockBus mock_bus(mock_chip);
+
+    /* The access pattern readALS() used to have: a write + read transaction
+       for STATUS, CHAN1 and CHAN0 each, then the interrupt clear. */
+    Result legacy = { "legacy 100k", 0.0, 0.0, 0.0, 0.0, true };
+    sim::run([&]() {
+        const int addr = TSL2591_ADDR << 1;
+        i2c.frequency(100000);
+        TSL2591_I2CBus setup(&i2c, TSL2591_ADDR, 100000);
+        TSL2591 sensor(&setup);
+        sensor.startContinuousALS();
+        sim::ns_t elapsed = 0;
+        sim::ns_t cpu = 0;
+        uint32_t transactions = sim::i2c_stats().transactions;
+        uint32_t bytes = sim::i2c_stats().bytes;
+        for (int i = 0; i < n; ++i) {
+            ThisThread::sleep_for(100ms);
+            sim::ns_t t0 = sim::now();
+            sim::ns_t c0 = sim::cpu_time();
+            char cmd, status[1], ch1[2], ch0[2];
+            cmd = TSL2591_CMD_BIT | TSL2591_REG_STATUS;
+            i2c.write(addr, &cmd, 1, 0);
+            i2c.read(addr, status, 1, 0);
+            cmd = TSL2591_CMD_BIT | TSL2591_REG_CHAN1_L;
+            i2c.write(addr, &cmd, 1, 0);
+            i2c.read(addr, ch1, 2, 0);
+            cmd = TSL2591_CMD_BIT | TSL2591_REG_CHAN0_L;
+            i2c.write(addr, &cmd, 1, 0);
+            i2c.read(addr, ch0, 2, 0);
+            cmd = TSL2591_CMD_CLR_INT;
+            i2c.write(addr, &cmd, 1, 0);
+            elapsed += sim::now() - t0;
+            cpu += sim::cpu_time() - c0;
+            uint16_t full = (uint8_t)ch0[1] << 8 | (uint8_t)ch0[0];
+            uint16_t ir = (uint8_t)ch1[1] << 8 | (uint8_t)ch1[0];
+            legacy.counts_ok = legacy.counts_ok && full == CH0_COUNTS && ir == CH1_COUNTS;
+        }
+        legacy.transactions = (double)(sim::i2c_stats().transactions - transactions) / n;
+        legacy.bytes = (double)(sim::i2c_stats().bytes - bytes) / n;
+        legacy.elapsed_us = (double)elapsed / n / sim::US;
+        legacy.cpu_us = (double)cpu / n / sim::US;
+        sensor.stopALS();
+    }, 600 * sim::S);
+
+    TSL2591_I2CBus bus_100k(&i2c, TSL2591_ADDR, 100000);
+    Result burst_100k = bench("burst 100k", &bus_100k, n, shim_counters);
+    TSL2591_I2CBus bus_400k(&i2c, TSL2591_ADDR, 400000);
+    Result burst_400k = bench("burst 400k", &bus_400k, n, shim_counters);
+    TSL2591_I2CBus bus_1m(&i2c, TSL2591_ADDR, 1000000);
+    Result burst_1m = bench("burst 1M *", &bus_1m, n, shim_counters);
+    Result mock = bench("mock 400k", &mock_bus, n, [&](uint32_t* transactions, uint32_t* bytes) {
+        *transactions = mock_bus.transactions();
+        *bytes = mock_bus.bytes();
+    });
+
+    const Result results[] = { legacy, burst_100k, burst_400k, burst_1m, mock };
+    printf("%-12s %14s %10s %12s %10s %8s\n", "bus", "transactions", "bytes", "elapsed us", "cpu us", "counts");
+    bool ok = true;
+    for (const Result& r : results) {
+        printf("%-12s %14.2f %10.2f %12.2f %10.2f %8s\n", r.name, r.transactions, r.bytes,
+               r.elapsed_us, r.cpu_us, r.counts_ok ? "ok" : "BAD");
+        ok = ok && r.counts_ok;
+    }
+    printf("* beyond the TSL2591's 400 kHz rating, for comparison only\n");
+
+    /* One burst read plus the interrupt clear, and the mock agrees. */
+    ok = ok && burst_400k.transactions == 2.0 && legacy.transactions == 7.0;
+    ok = ok && mock.transactions == burst_400k.transactions && mock.bytes == burst_400k.bytes;
+
+    double saving = 1.0 - burst_400k.elapsed_us / legacy.elapsed_us;
+    printf("burst at 400 kHz saves %.0f %% of bus time per reading\n", 100.0 * saving);
+    ok = ok && saving > 0.75;
+
+    /* The transfer runs in the background; the CPU only sets it up. */
+    ok = ok && burst_400k.cpu_us < burst_400k.elapsed_us / 2;
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}